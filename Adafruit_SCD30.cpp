@@ -38,23 +38,77 @@
 
 #include "Adafruit_SCD30.h"
 
-static uint8_t crc8(const uint8_t *data, int len);
+// bits of `_config_valid`, one per cached configuration register
+#define SCD30_CONFIG_INTERVAL 0x01  ///< `measurement_interval` is cached
+#define SCD30_CONFIG_PRESSURE 0x02  ///< `ambient_pressure` is cached
+#define SCD30_CONFIG_ALTITUDE 0x04  ///< `altitude_offset` is cached
+#define SCD30_CONFIG_TEMP 0x08      ///< `temperature_offset` is cached
+#define SCD30_CONFIG_FRC 0x10       ///< `forced_calibration_reference` cached
+#define SCD30_CONFIG_ASC 0x20       ///< `self_calibration` is cached
+#define SCD30_CONFIG_ALL 0x3F       ///< Every configuration register cached
+#define SCD30_CONFIG_COUNT 6        ///< Number of configuration registers
+
+// commands to read the configuration registers with, in `_config_valid` order
+static const uint16_t config_commands[SCD30_CONFIG_COUNT] = {
+    SCD30_CMD_SET_MEASUREMENT_INTERVAL,
+    SCD30_CMD_CONTINUOUS_MEASUREMENT,
+    SCD30_CMD_SET_ALTITUDE_COMPENSATION,
+    SCD30_CMD_SET_TEMPERATURE_OFFSET,
+    SCD30_CMD_SET_FORCED_RECALIBRATION_REF,
+    SCD30_CMD_AUTOMATIC_SELF_CALIBRATION,
+};
+
+/**
+ * @brief Turn the six words of a measurement back into the bytes the sensor
+ * sent, without their CRCs
+ *
+ * @param words The words read from the sensor, with good CRCs
+ * @param payload Where to store the `SCD30_RAW_PAYLOAD_SIZE` byte payload
+ */
+static void pack_payload(const uint16_t *words, uint8_t *payload) {
+  for (uint8_t i = 0; i < 6; i++) {
+    payload[2 * i] = words[i] >> 8;
+    payload[2 * i + 1] = words[i] & 0xFF;
+  }
+}
+
+static Adafruit_SCD30 *ready_instances[SCD30_MAX_READY_INTERRUPTS];
+
+// one trampoline per slot, as attachInterrupt takes no context pointer
+static void SCD30_ISR_ATTR ready_isr0(void) {
+  if (ready_instances[0])
+    ready_instances[0]->dataReadyISR();
+}
+static void SCD30_ISR_ATTR ready_isr1(void) {
+  if (ready_instances[1])
+    ready_instances[1]->dataReadyISR();
+}
+static void (*const ready_isrs[SCD30_MAX_READY_INTERRUPTS])(void) = {
+    ready_isr0, ready_isr1};
+static_assert(SCD30_MAX_READY_INTERRUPTS == 2,
+              "add a trampoline for each RDY interrupt slot");
 
 /**
  * @brief Construct a new Adafruit_SCD30::Adafruit_SCD30 object
  *
  */
-Adafruit_SCD30::Adafruit_SCD30(void) {}
+Adafruit_SCD30::Adafruit_SCD30(void)
+    : _temp_sensor_storage(this), _humidity_sensor_storage(this),
+      _co2_sensor_storage(this) {
+  temp_sensor = &_temp_sensor_storage;
+  humidity_sensor = &_humidity_sensor_storage;
+  co2_sensor = &_co2_sensor_storage;
+}
 
 /**
  * @brief Destroy the Adafruit_SCD30::Adafruit_SCD30 object
  *
  */
 Adafruit_SCD30::~Adafruit_SCD30(void) {
-  if (temp_sensor)
-    delete temp_sensor;
-  if (humidity_sensor)
-    delete humidity_sensor;
+  detachReadyPin();
+  if (i2c_dev) {
+    i2c_dev->~Adafruit_I2CDevice();
+  }
 }
 
 /*!
@@ -65,23 +119,63 @@ Adafruit_SCD30::~Adafruit_SCD30(void) {
  *            The Wire object to be used for I2C connections.
  *    @param  sensor_id
  *            The unique ID to differentiate the sensors from others
+ *    @param  ready_pin
+ *            The pin connected to the SCD30's RDY output, or -1 if it is not
+ *            connected. When given, `dataReady` checks the pin instead of
+ *            asking the sensor over I2C.
+ *    @param  warm_start
+ *            If true and the sensor responds, pick up where it is instead of
+ *            resetting it, returning as soon as its interval and pressure
+ *            are read back. Measurement is restarted later, from the first
+ *            data ready check that finds no sample within an interval plus
+ *            5%. Useful to keep a running sensor's calibration state and
+ *            measurement in progress when the microcontroller restarts.
  *    @return True if initialization was successful, otherwise false.
  */
 bool Adafruit_SCD30::begin(uint8_t i2c_address, TwoWire *wire,
-                           int32_t sensor_id) {
+                           int32_t sensor_id, int8_t ready_pin,
+                           bool warm_start) {
   if (i2c_dev) {
-    delete i2c_dev; // remove old interface
+    i2c_dev->~Adafruit_I2CDevice(); // remove old interface
   }
 
-  i2c_dev = new Adafruit_I2CDevice(i2c_address, wire);
+  // built in place so calling begin() again doesn't touch the heap
+  i2c_dev = new (_i2c_dev_storage) Adafruit_I2CDevice(i2c_address, wire);
+  _i2c_transport.setDevice(i2c_dev);
+
+  return begin(&_i2c_transport, sensor_id, ready_pin, warm_start);
+}
 
-  if (!i2c_dev->begin()) {
+/*!
+ *    @brief  Sets up the sensor on any bus, such as `Adafruit_SCD30_Modbus`
+ *    @param  transport
+ *            The bus interface to talk to the sensor through. It must
+ *            outlive the driver.
+ *    @param  sensor_id
+ *            The unique ID to differentiate the sensors from others
+ *    @param  ready_pin
+ *            The pin connected to the SCD30's RDY output, or -1 if it is not
+ *            connected
+ *    @param  warm_start
+ *            If true and the sensor responds, pick up where it is instead of
+ *            resetting it
+ *    @return True if initialization was successful, otherwise false.
+ */
+bool Adafruit_SCD30::begin(Adafruit_SCD30_Transport *transport,
+                           int32_t sensor_id, int8_t ready_pin,
+                           bool warm_start) {
+  attachReadyPin(ready_pin);
+  _warm_start = warm_start;
+  _core.transport() = Adafruit_SCD30_TransportRef(transport);
+  _core.cancelTransfer();
+  transport->setStats(_core.stats());
+
+  if (!transport->begin()) {
     return false;
   }
 
   return _init(sensor_id);
 }
-// bool Adafruit_SCD30::begin_UART(void){}
 
 /*!  @brief Initializer for post i2c init
  *   @param sensor_id Optional unique ID for the sensor set
@@ -91,19 +185,60 @@ bool Adafruit_SCD30::_init(int32_t sensor_id) {
 
   _sensorid_humidity = sensor_id;
   _sensorid_temp = sensor_id + 1;
+  _sensorid_co2 = sensor_id + 2;
+
+  if (_warm_start && _warmStart()) {
+    return true;
+  }
 
   reset();
 
-  // first I2C xfer after reset can fail, double tapping seems to get by it
+  // first I2C xfer after reset can fail, the retry policy gets by it
   if (!startContinuousMeasurement()) {
-    if (!startContinuousMeasurement())
-      return false;
+    return false;
   }
   if (!setMeasurementInterval(2)) {
     return false;
   }
-  humidity_sensor = new Adafruit_SCD30_Humidity(this);
-  temp_sensor = new Adafruit_SCD30_Temp(this);
+  return true;
+}
+
+/*!  @brief Pick up a sensor that is already configured, only sending the
+ *   commands needed to get it into a usable state. Whether it is still
+ *   measuring is left to `checkIdle`, so this never waits for a sample.
+ *   @returns True if the sensor responded with a usable configuration, false
+ *   if a full initialization is needed
+ */
+bool Adafruit_SCD30::_warmStart(void) {
+  _sample_valid = false;
+  restartTiming();
+  _config_valid = 0;
+
+  // make sure something is answering before trusting its state
+  if (getFirmwareRevision() == 0) {
+    return false;
+  }
+
+  // the interval is kept by the sensor, only fix it if it's out of range
+  uint16_t interval = getMeasurementInterval();
+  if (!(_config_valid & SCD30_CONFIG_INTERVAL)) {
+    return false;
+  }
+  if (((interval < 2) || (interval > 1800)) && !setMeasurementInterval(2)) {
+    return false;
+  }
+
+  // read now so a restart from `checkIdle` is a single write
+  getAmbientPressureOffset();
+  if (!(_config_valid & SCD30_CONFIG_PRESSURE)) {
+    return false;
+  }
+
+  // Continuous measurement survives a microcontroller reset, but data ready
+  // is also false between two samples of a running sensor, so it is only
+  // known to be idle once a whole interval goes by without a sample
+  _idle_check = true;
+  _idle_check_ms = millis();
   return true;
 }
 
@@ -113,17 +248,149 @@ bool Adafruit_SCD30::_init(int32_t sensor_id) {
  *
  */
 void Adafruit_SCD30::reset(void) {
-  sendCommand(SCD30_CMD_SOFT_RESET);
+  _sample_valid = false;
+  restartTiming();
+  _config_valid = 0;
+  _core.sendCommand(SCD30_CMD_SOFT_RESET);
   delay(30);
 }
 
+/**
+ * @brief Read the sensor's firmware revision
+ *
+ * @return uint16_t The firmware version, major in the MSB and minor in the LSB.
+ * 0 if it could not be read
+ */
+uint16_t Adafruit_SCD30::getFirmwareRevision(void) {
+  uint16_t revision;
+  if (!_core.readRegister(SCD30_CMD_READ_REVISION, &revision)) {
+    return 0;
+  }
+  return revision;
+}
+
 /**
  * @brief Ask the sensor if new data is ready to read
  *
+ * If a RDY pin was given to `begin` or a pin reader was set with
+ * `setReadyPinReader`, the pin is checked instead of the bus.
+ *
  * @return true: data is available false: no new data available
  */
 bool Adafruit_SCD30::dataReady(void) {
-  return (readRegister(SCD30_CMD_GET_DATA_READY) == 1);
+  bool ready;
+  if (usingReadyPin()) {
+    if (_ready_flag) {
+      if (!_ready_seen) {
+        // the edge bounds when the frame was measured on both sides, unless
+        // RDY stayed high for longer than an interval: then newer frames
+        // may have replaced it without another edge
+        uint32_t now = millis();
+        _ready_seen = true;
+        _ready_ms = _ready_edge_ms;
+        if (now - _ready_edge_ms >=
+            (uint32_t)_config.measurement_interval * 1000) {
+          _ready_ms = now;
+        }
+        _not_ready_seen = true;
+        _not_ready_ms = _ready_edge_ms;
+      }
+      _idle_check = false;
+      return true;
+    }
+    if (_ready_pin_reader) {
+      ready = _ready_pin_reader(_ready_pin_context);
+    } else {
+      ready = (digitalRead(_ready_pin) == HIGH);
+    }
+    noteDataReady(ready);
+    return ready;
+  }
+
+  uint16_t word;
+  if (!_core.readRegister(SCD30_CMD_GET_DATA_READY, &word)) {
+    return false;
+  }
+  ready = (word == 1);
+  noteDataReady(ready);
+  return ready;
+}
+
+/**
+ * @brief Use a custom function to read the RDY pin
+ *
+ * Useful when the pin is behind a port expander, or to simulate it. Pair with
+ * calls to `dataReadyISR` if the pin's rising edge can be detected.
+ *
+ * @param reader Function returning the level of the RDY pin, or NULL to stop
+ * using it
+ * @param context Pointer passed to `reader`
+ */
+void Adafruit_SCD30::setReadyPinReader(scd30_pin_read_t reader,
+                                       void *context) {
+  _ready_pin_reader = reader;
+  _ready_pin_context = context;
+}
+
+/**
+ * @brief Flag that new data is ready. Called from the RDY pin interrupt, or
+ * from a user interrupt handler when using `setReadyPinReader`
+ */
+void SCD30_ISR_ATTR Adafruit_SCD30::dataReadyISR(void) {
+  if (!_ready_flag) {
+    _ready_edge_ms = millis();
+  }
+  _ready_flag = true;
+}
+
+/**
+ * @brief Check whether data ready is signalled by the RDY pin
+ *
+ * @return true: a RDY pin or pin reader is set
+ */
+bool Adafruit_SCD30::usingReadyPin(void) {
+  return (_ready_pin >= 0) || (_ready_pin_reader != NULL);
+}
+
+/**
+ * @brief Set up the RDY pin, attaching it to an interrupt if one is free
+ *
+ * @param pin The pin connected to RDY, or -1 to not use one
+ */
+void Adafruit_SCD30::attachReadyPin(int8_t pin) {
+  detachReadyPin();
+  if (pin < 0) {
+    return;
+  }
+  _ready_pin = pin;
+  pinMode(pin, INPUT);
+
+  int interrupt = digitalPinToInterrupt(pin);
+  if (interrupt < 0) {
+    // no interrupt on this pin, dataReady will read its level
+    return;
+  }
+  for (uint8_t i = 0; i < SCD30_MAX_READY_INTERRUPTS; i++) {
+    if (!ready_instances[i]) {
+      ready_instances[i] = this;
+      _ready_slot = i;
+      attachInterrupt(interrupt, ready_isrs[i], RISING);
+      return;
+    }
+  }
+}
+
+/**
+ * @brief Release the RDY pin and its interrupt
+ */
+void Adafruit_SCD30::detachReadyPin(void) {
+  if (_ready_slot >= 0) {
+    detachInterrupt(digitalPinToInterrupt(_ready_pin));
+    ready_instances[_ready_slot] = NULL;
+    _ready_slot = -1;
+  }
+  _ready_pin = -1;
+  _ready_flag = false;
 }
 
 /**
@@ -138,7 +405,8 @@ bool Adafruit_SCD30::setMeasurementInterval(uint16_t interval) {
   if ((interval < 2) || (interval > 1800)) {
     return false;
   }
-  return sendCommand(SCD30_CMD_SET_MEASUREMENT_INTERVAL, interval);
+  return setConfigValue(SCD30_CMD_SET_MEASUREMENT_INTERVAL, interval,
+                        &_config.measurement_interval, SCD30_CONFIG_INTERVAL);
 }
 
 /**
@@ -147,7 +415,8 @@ bool Adafruit_SCD30::setMeasurementInterval(uint16_t interval) {
  * @return uint16_t The current measurement interval in seconds.
  */
 uint16_t Adafruit_SCD30::getMeasurementInterval(void) {
-  return readRegister(SCD30_CMD_SET_MEASUREMENT_INTERVAL);
+  return getConfigValue(SCD30_CMD_SET_MEASUREMENT_INTERVAL,
+                        &_config.measurement_interval, SCD30_CONFIG_INTERVAL);
 }
 
 /**
@@ -156,7 +425,8 @@ uint16_t Adafruit_SCD30::getMeasurementInterval(void) {
  * @return true: enabled false: disabled
  */
 bool Adafruit_SCD30::selfCalibrationEnabled(void) {
-  return (readRegister(SCD30_CMD_AUTOMATIC_SELF_CALIBRATION) == 1);
+  return (getConfigValue(SCD30_CMD_AUTOMATIC_SELF_CALIBRATION,
+                         &_config.self_calibration, SCD30_CONFIG_ASC) == 1);
 }
 
 /**
@@ -166,7 +436,8 @@ bool Adafruit_SCD30::selfCalibrationEnabled(void) {
  * @return true: success false: failure
  */
 bool Adafruit_SCD30::selfCalibrationEnabled(bool enabled) {
-  return sendCommand(SCD30_CMD_AUTOMATIC_SELF_CALIBRATION, enabled);
+  return setConfigValue(SCD30_CMD_AUTOMATIC_SELF_CALIBRATION, enabled,
+                        &_config.self_calibration, SCD30_CONFIG_ASC);
 }
 
 /**
@@ -176,7 +447,20 @@ bool Adafruit_SCD30::selfCalibrationEnabled(bool enabled) {
  * @return true: succes false: failure
  */
 bool Adafruit_SCD30::startContinuousMeasurement(uint16_t pressure) {
-  return sendCommand(SCD30_CMD_CONTINUOUS_MEASUREMENT, pressure);
+  restartTiming();
+  return setConfigValue(SCD30_CMD_CONTINUOUS_MEASUREMENT, pressure,
+                        &_config.ambient_pressure, SCD30_CONFIG_PRESSURE);
+}
+
+/**
+ * @brief Tell the SCD30 to stop measuring, to save power between samples.
+ * Restart it with `startContinuousMeasurement`.
+ *
+ * @return true: success false: failure
+ */
+bool Adafruit_SCD30::stopContinuousMeasurement(void) {
+  restartTiming();
+  return _core.sendCommand(SCD30_CMD_STOP_MEASUREMENTS);
 }
 
 /**
@@ -185,7 +469,8 @@ bool Adafruit_SCD30::startContinuousMeasurement(uint16_t pressure) {
  * @return uint16_t  current ambient pressure offset in millibar (mBar)
  */
 uint16_t Adafruit_SCD30::getAmbientPressureOffset(void) {
-  return readRegister(SCD30_CMD_CONTINUOUS_MEASUREMENT);
+  return getConfigValue(SCD30_CMD_CONTINUOUS_MEASUREMENT,
+                        &_config.ambient_pressure, SCD30_CONFIG_PRESSURE);
 }
 
 /**
@@ -197,7 +482,8 @@ uint16_t Adafruit_SCD30::getAmbientPressureOffset(void) {
  * @return true: success false: failure
  */
 bool Adafruit_SCD30::setAltitudeOffset(uint16_t altitude) {
-  return sendCommand(SCD30_CMD_SET_ALTITUDE_COMPENSATION, altitude);
+  return setConfigValue(SCD30_CMD_SET_ALTITUDE_COMPENSATION, altitude,
+                        &_config.altitude_offset, SCD30_CONFIG_ALTITUDE);
 }
 /**
  * @brief Get the current altitude offset
@@ -205,7 +491,8 @@ bool Adafruit_SCD30::setAltitudeOffset(uint16_t altitude) {
  * @return uint16_t The current altitude offset value in meters above sea level.
  */
 uint16_t Adafruit_SCD30::getAltitudeOffset(void) {
-  return readRegister(SCD30_CMD_SET_ALTITUDE_COMPENSATION);
+  return getConfigValue(SCD30_CMD_SET_ALTITUDE_COMPENSATION,
+                        &_config.altitude_offset, SCD30_CONFIG_ALTITUDE);
 }
 
 /**
@@ -223,7 +510,8 @@ uint16_t Adafruit_SCD30::getAltitudeOffset(void) {
  * @return true: success false: failure
  */
 bool Adafruit_SCD30::setTemperatureOffset(uint16_t temp_offset) {
-  return sendCommand(SCD30_CMD_SET_TEMPERATURE_OFFSET, temp_offset);
+  return setConfigValue(SCD30_CMD_SET_TEMPERATURE_OFFSET, temp_offset,
+                        &_config.temperature_offset, SCD30_CONFIG_TEMP);
 }
 /**
  * @brief Get the current temperature offset in hundreths of a degree C
@@ -231,7 +519,8 @@ bool Adafruit_SCD30::setTemperatureOffset(uint16_t temp_offset) {
  * @return uint16_t the current temperature offset
  */
 uint16_t Adafruit_SCD30::getTemperatureOffset(void) {
-  return readRegister(SCD30_CMD_SET_TEMPERATURE_OFFSET);
+  return getConfigValue(SCD30_CMD_SET_TEMPERATURE_OFFSET,
+                        &_config.temperature_offset, SCD30_CONFIG_TEMP);
 }
 
 /**
@@ -251,7 +540,9 @@ bool Adafruit_SCD30::forceRecalibrationWithReference(uint16_t reference) {
   if ((reference < 400) || (reference > 2000)) {
     return false;
   }
-  return sendCommand(SCD30_CMD_SET_FORCED_RECALIBRATION_REF, reference);
+  return setConfigValue(SCD30_CMD_SET_FORCED_RECALIBRATION_REF, reference,
+                        &_config.forced_calibration_reference,
+                        SCD30_CONFIG_FRC);
 }
 
 /**
@@ -260,96 +551,646 @@ bool Adafruit_SCD30::forceRecalibrationWithReference(uint16_t reference) {
  * @return uint16_t The current reference value in ppm
  */
 uint16_t Adafruit_SCD30::getForcedCalibrationReference(void) {
-  return readRegister(SCD30_CMD_SET_FORCED_RECALIBRATION_REF);
+  return getConfigValue(SCD30_CMD_SET_FORCED_RECALIBRATION_REF,
+                        &_config.forced_calibration_reference,
+                        SCD30_CONFIG_FRC);
+}
+
+/**
+ * @brief Record every sample read from now on into a history
+ *
+ * @param history The history to add samples to, or NULL to stop recording
+ */
+void Adafruit_SCD30::setHistory(Adafruit_SCD30_HistoryBase *history) {
+  _history = history;
+}
+
+/**
+ * @brief Filter every sample read from now on. `CO2`, `temperature` and
+ * `relative_humidity` keep the raw values; get the filtered ones from the
+ * filter.
+ *
+ * @param filter The filter to run samples through, or NULL to stop filtering
+ */
+void Adafruit_SCD30::setFilter(Adafruit_SCD30_Filter *filter) {
+  _filter = filter;
+}
+
+/**
+ * @brief Have a function called with new samples that moved past a deadband,
+ * instead of polling `dataReady` and comparing readings by hand. Observers
+ * are called from `read` and `pollRead`, after the sample is published.
+ *
+ * @param observer Storage for the observer, owned by the caller until it is
+ * removed
+ * @param callback The function to call
+ * @param context Passed to `callback`
+ * @param deadband When to call it, or NULL to call it for every change of
+ * any channel
+ * @return true: success false: `observer` is already registered or
+ * `callback` is NULL
+ */
+bool Adafruit_SCD30::addObserver(scd30_observer_t *observer,
+                                 scd30_observer_callback_t callback,
+                                 void *context,
+                                 const scd30_deadband_t *deadband) {
+  if (!observer || !callback) {
+    return false;
+  }
+  for (scd30_observer_t *o = _observers; o; o = o->next) {
+    if (o == observer) {
+      return false;
+    }
+  }
+
+  observer->callback = callback;
+  observer->context = context;
+  if (deadband) {
+    observer->deadband = *deadband;
+  } else {
+    memset(&observer->deadband, 0, sizeof(observer->deadband));
+  }
+  observer->reported_valid = false;
+  observer->next = _observers;
+  _observers = observer;
+  return true;
+}
+
+/**
+ * @brief Stop calling an observer
+ *
+ * @param observer The observer given to `addObserver`
+ * @return true: success false: it was not registered
+ */
+bool Adafruit_SCD30::removeObserver(scd30_observer_t *observer) {
+  for (scd30_observer_t **link = &_observers; *link; link = &(*link)->next) {
+    if (*link == observer) {
+      *link = observer->next;
+      observer->next = NULL;
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief Change how failed transactions are retried. Applies to commands,
+ * register reads and `read`, but not to `beginRead`/`pollRead`, whose caller
+ * decides what to do after an error.
+ *
+ * The default is two attempts with a 1 ms backoff, retrying both bus and CRC
+ * errors. Keep at least two attempts for `begin`, as the first transfer after
+ * a reset can fail.
+ *
+ * @param policy The policy to use
+ */
+void Adafruit_SCD30::setRetryPolicy(const scd30_retry_policy_t *policy) {
+  _core.setRetryPolicy(policy);
+}
+
+/**
+ * @brief Get the policy used to retry failed transactions
+ *
+ * @param policy Where to store the policy
+ */
+void Adafruit_SCD30::getRetryPolicy(scd30_retry_policy_t *policy) {
+  _core.getRetryPolicy(policy);
+}
+
+/**
+ * @brief Count bus activity and errors: transactions, bytes, NACKs, CRC
+ * failures, retries and latency per command. Nothing is counted if the
+ * library is built with SCD30_NO_STATS defined.
+ *
+ * @param stats The counters to update, or NULL to stop counting. They are
+ * not cleared; call `resetStats` to start from zero. Zero initialized
+ * counters, such as a global, can be used as they are.
+ */
+void Adafruit_SCD30::setStats(scd30_stats_t *stats) {
+#ifndef SCD30_NO_STATS
+  _core.setStats(stats);
+  if (_core.transport().get()) {
+    _core.transport().get()->setStats(stats);
+  }
+#else
+  (void)stats;
+#endif
+}
+
+/**
+ * @brief Get a copy of the counters
+ *
+ * @param snapshot Where to store the copy
+ * @return true: success false: no counters are attached
+ */
+bool Adafruit_SCD30::getStats(scd30_stats_t *snapshot) {
+  if (!_core.stats()) {
+    return false;
+  }
+  *snapshot = *_core.stats();
+  return true;
+}
+
+/**
+ * @brief Zero the attached counters
+ */
+void Adafruit_SCD30::resetStats(void) {
+  if (_core.stats()) {
+    scd30_stats_clear(_core.stats());
+  }
+}
+
+/**
+ * @brief Get a copy of the sensor configuration
+ *
+ * Settings are read from the sensor the first time they are needed and then
+ * served from the driver's copy, which is kept up to date by the setters. Use
+ * `refreshConfig` to re-read them from the sensor.
+ *
+ * @param config The configuration struct to fill
+ * @return true: success false: a setting could not be read from the sensor
+ */
+bool Adafruit_SCD30::getConfig(scd30_config_t *config) {
+  uint16_t *fields[SCD30_CONFIG_COUNT] = {
+      &_config.measurement_interval,
+      &_config.ambient_pressure,
+      &_config.altitude_offset,
+      &_config.temperature_offset,
+      &_config.forced_calibration_reference,
+      &_config.self_calibration,
+  };
+  uint16_t commands[SCD30_CONFIG_COUNT];
+  uint16_t values[SCD30_CONFIG_COUNT];
+  uint8_t missing[SCD30_CONFIG_COUNT];
+  uint8_t count = 0;
+
+  for (uint8_t i = 0; i < SCD30_CONFIG_COUNT; i++) {
+    if (!(_config_valid & (1 << i))) {
+      missing[count] = i;
+      commands[count++] = config_commands[i];
+    }
+  }
+
+  // read everything that isn't cached at once, so transports that can
+  // read several registers in one request only do a single round trip
+  if (count && _core.readRegisters(commands, values, count)) {
+    for (uint8_t i = 0; i < count; i++) {
+      *fields[missing[i]] = values[i];
+      _config_valid |= 1 << missing[i];
+    }
+  }
+
+  *config = _config;
+  return (_config_valid == SCD30_CONFIG_ALL);
+}
+
+/**
+ * @brief Discard the driver's copy of the sensor configuration and read every
+ * setting back from the sensor
+ *
+ * @return true: success false: a setting could not be read from the sensor
+ */
+bool Adafruit_SCD30::refreshConfig(void) {
+  _config_valid = 0;
+
+  scd30_config_t config;
+  return getConfig(&config);
 }
 /**
  * @brief  Updates the measurement data for all sensors simultaneously
  *
+ * Blocks for the write/read gap specified by the datasheet. Use `beginRead` and
+ * `pollRead` to avoid stalling the caller.
+ *
  * @return true: success false: failure
  */
 bool Adafruit_SCD30::read(void) {
-  uint8_t buffer[18];
-
-  buffer[0] = (SCD30_CMD_READ_MEASUREMENT >> 8) & 0xFF;
-  buffer[1] = SCD30_CMD_READ_MEASUREMENT & 0xFF;
+  uint16_t words[6];
 
-  if (!i2c_dev->write(buffer, 2)) {
+  if (!_core.readWords(SCD30_CMD_READ_MEASUREMENT, words, 6)) {
     return false;
   }
+  acceptMeasurement(words);
+  return true;
+}
 
-  delay(4); // delay between write and read specified by the datasheet
+/**
+ * @brief Request a measurement without waiting for the data
+ *
+ * Sends the read measurement command and returns immediately. Call `pollRead`
+ * until it no longer returns `SCD30_READ_PENDING` to collect the data.
+ *
+ * @return true: command sent false: failure
+ */
+bool Adafruit_SCD30::beginRead(void) {
+  return _core.beginTransfer(SCD30_CMD_READ_MEASUREMENT, 6);
+}
 
-  if (!i2c_dev->read(buffer, 18)) {
-    return false;
+/**
+ * @brief Complete a measurement read started with `beginRead`
+ *
+ * A measurement read again after a data ready check found no new data is
+ * counted in `getTiming` as a duplicate and not added to the history, the
+ * filters or the snapshot, nor reported to observers. Without such a check,
+ * every successful read is taken as a new measurement.
+ *
+ * @return scd30_read_status_t `SCD30_READ_PENDING` until the datasheet gap has
+ * elapsed, then `SCD30_READ_READY` once `CO2`, `temperature` and
+ * `relative_humidity` are updated or `SCD30_READ_ERROR` if the transfer or CRC
+ * check failed. `SCD30_READ_IDLE` if no read was started.
+ */
+scd30_read_status_t Adafruit_SCD30::pollRead(void) {
+  uint16_t words[6];
+
+  scd30_read_status_t status =
+      _core.pollTransfer(SCD30_CMD_READ_MEASUREMENT, words, 6);
+  if (status == SCD30_READ_READY) {
+    acceptMeasurement(words);
   }
+  return status;
+}
 
-  // loop through the bytes we read, 3 at a time for i=MSB, i+1=LSB, i+2=CRC
-  for (uint8_t i = 0; i < 18; i += 3) {
-    if (crc8(buffer + i, 2) != buffer[i + 2]) {
-      // we got a bad CRC, fail out
-      return false;
+/**
+ * @brief Get a consistent copy of the latest sample, safe to call from other
+ * tasks or interrupts while another task reads the sensor
+ *
+ * The public `CO2`, `temperature` and `relative_humidity` can be seen half
+ * updated from another task. Samples are also published under a sequence
+ * lock; this never blocks the reading task, and gives up after
+ * `SCD30_SNAPSHOT_TRIES` if a new sample keeps being published meanwhile.
+ *
+ * @param snapshot Where to store the copy
+ * @return true: success false: no sample has been read yet, or one was
+ * being published
+ */
+bool Adafruit_SCD30::getSnapshot(scd30_snapshot_t *snapshot) {
+  for (uint8_t i = 0; i < SCD30_SNAPSHOT_TRIES; i++) {
+    uint32_t before = _snapshot_seq;
+    SCD30_MEMORY_BARRIER();
+    *snapshot = _snapshot;
+    SCD30_MEMORY_BARRIER();
+    uint32_t after = _snapshot_seq;
+
+    if ((before == after) && !(before & 1)) {
+      return (before != 0);
     }
   }
-  // CRCs are good, unpack floats
-  uint32_t co2 = 0, temp = 0, hum = 0;
-
-  co2 |= buffer[0];
-  co2 <<= 8;
-  co2 |= buffer[1];
-  co2 <<= 8;
-  co2 |= buffer[3];
-  co2 <<= 8;
-  co2 |= buffer[4];
-
-  temp |= buffer[6];
-  temp <<= 8;
-  temp |= buffer[7];
-  temp <<= 8;
-  temp |= buffer[9];
-  temp <<= 8;
-  temp |= buffer[10];
-
-  hum |= buffer[12];
-  hum <<= 8;
-  hum |= buffer[13];
-  hum <<= 8;
-  hum |= buffer[15];
-  hum <<= 8;
-  hum |= buffer[16];
-
-  memcpy(&CO2, &co2, sizeof(CO2));
-  memcpy(&temperature, &temp, sizeof(temperature));
-  memcpy(&relative_humidity, &hum, sizeof(relative_humidity));
+  return false;
+}
+
+/**
+ * @brief Get when the last sample was measured, how many measurements were
+ * missed or read twice, and how the sensor's clock compares to the MCU's
+ *
+ * Measurement times come from the data ready checks: the window between the
+ * last check that found no new data and the first that found some, and the
+ * sensor's cadence within it. Checking often, or using the RDY pin with an
+ * interrupt, gives the most accurate times. No extra bus traffic is needed.
+ *
+ * @param timing Where to store the timing
+ */
+void Adafruit_SCD30::getTiming(scd30_timing_t *timing) {
+  _frame_clock.getTiming(timing);
+}
+
+/**
+ * @brief Read a measurement without converting it to floats
+ *
+ * Blocks for the write/read gap like `read`, but leaves `CO2`, `temperature`
+ * and `relative_humidity` and the history untouched. Use
+ * `scd30_compact_from_payload` to convert the payload without floating point
+ * math, or forward it as is.
+ *
+ * @param payload Where to store the `SCD30_RAW_PAYLOAD_SIZE` byte payload:
+ * CO2, temperature and humidity as big-endian floats, with CRCs checked and
+ * removed
+ * @return true: success false: failure
+ */
+bool Adafruit_SCD30::readRaw(uint8_t *payload) {
+  uint16_t words[6];
 
+  if (!_core.readWords(SCD30_CMD_READ_MEASUREMENT, words, 6)) {
+    return false;
+  }
+  _ready_flag = false;
+  pack_payload(words, payload);
   return true;
 }
 
-bool Adafruit_SCD30::sendCommand(uint16_t command) {
-  uint8_t buffer[2];
-  buffer[0] = (command >> 8) & 0xFF;
-  buffer[1] = command & 0xFF;
+/**
+ * @brief Complete a measurement read started with `beginRead`, storing the
+ * raw payload instead of updating the readings
+ *
+ * @param payload Where to store the `SCD30_RAW_PAYLOAD_SIZE` byte payload
+ * @return scd30_read_status_t The state of the read, as for `pollRead`
+ */
+scd30_read_status_t Adafruit_SCD30::pollReadRaw(uint8_t *payload) {
+  uint16_t words[6];
+
+  scd30_read_status_t status =
+      _core.pollTransfer(SCD30_CMD_READ_MEASUREMENT, words, 6);
+  if (status != SCD30_READ_READY) {
+    return status;
+  }
+
+  _ready_flag = false;
+  pack_payload(words, payload);
+  return SCD30_READ_READY;
+}
+
+/**
+ * @brief Ask the sensor if new data is ready without waiting for the answer
+ *
+ * Call `pollDataReady` until it no longer returns `SCD30_READ_PENDING` to get
+ * the answer. With a RDY pin nothing is sent.
+ *
+ * @return true: command sent false: failure
+ */
+bool Adafruit_SCD30::beginDataReady(void) {
+  if (usingReadyPin()) {
+    return true;
+  }
+  return _core.beginTransfer(SCD30_CMD_GET_DATA_READY, 1);
+}
+
+/**
+ * @brief Complete a data ready check started with `beginDataReady`
+ *
+ * @param ready Set to true if new data is available once the check completes
+ * @return scd30_read_status_t `SCD30_READ_PENDING` until the datasheet gap has
+ * elapsed, then `SCD30_READ_READY` once `ready` is set or `SCD30_READ_ERROR`
+ * if the transfer or CRC check failed. `SCD30_READ_IDLE` if no check was
+ * started.
+ */
+scd30_read_status_t Adafruit_SCD30::pollDataReady(bool *ready) {
+  if (usingReadyPin()) {
+    *ready = dataReady();
+    return SCD30_READ_READY;
+  }
+
+  uint16_t word;
+  scd30_read_status_t status =
+      _core.pollTransfer(SCD30_CMD_GET_DATA_READY, &word, 1);
+  if (status == SCD30_READ_READY) {
+    *ready = (word == 1);
+    noteDataReady(*ready);
+  }
+  return status;
+}
+
+/**
+ * @brief Publish the sample just read for `getSnapshot`
+ */
+void Adafruit_SCD30::publishSample(void) {
+  uint32_t seq = _snapshot_seq;
+
+  _snapshot_seq = seq + 1;
+  SCD30_MEMORY_BARRIER();
+  _snapshot.CO2 = CO2;
+  _snapshot.temperature = temperature;
+  _snapshot.relative_humidity = relative_humidity;
+  _snapshot.timestamp = _frame_clock.acquired();
+  _snapshot.sequence = seq / 2 + 1;
+  _snapshot.frame = _frame_clock.frame();
+  SCD30_MEMORY_BARRIER();
+  _snapshot_seq = seq + 2;
+}
+
+/**
+ * @brief Call each observer whose deadband the sample just read moved past,
+ * or which has been silent too long
+ */
+void Adafruit_SCD30::notifyObservers(void) {
+  const float values[SCD30_CHANNEL_COUNT] = {CO2, temperature,
+                                             relative_humidity};
+
+  scd30_observer_t *next;
+  for (scd30_observer_t *observer = _observers; observer; observer = next) {
+    // the callback may remove its observer
+    next = observer->next;
+
+    const float deadbands[SCD30_CHANNEL_COUNT] = {
+        observer->deadband.co2, observer->deadband.temperature,
+        observer->deadband.relative_humidity};
+
+    uint8_t reasons = 0;
+    for (uint8_t i = 0; i < SCD30_CHANNEL_COUNT; i++) {
+      if (!observer->reported_valid) {
+        reasons |= 1 << i;
+        continue;
+      }
+      float change = values[i] - observer->reported[i];
+      if (change < 0) {
+        change = -change;
+      }
+      // negative deadbands ignore the channel, NaN never compares greater
+      if ((deadbands[i] >= 0) && (change > deadbands[i])) {
+        reasons |= 1 << i;
+      }
+    }
+    if (observer->reported_valid && observer->deadband.max_silence_ms &&
+        ((uint32_t)(_sample_millis - observer->reported_ms) >=
+         observer->deadband.max_silence_ms)) {
+      reasons |= SCD30_OBSERVE_SILENCE;
+    }
+    if (!reasons) {
+      continue;
+    }
+
+    // the whole sample is reported, so every channel restarts from it
+    memcpy(observer->reported, values, sizeof(values));
+    observer->reported_ms = _sample_millis;
+    observer->reported_valid = true;
+    observer->callback(&_snapshot, reasons, observer->context);
+  }
+}
+
+/**
+ * @brief Note the result of a data ready check, narrowing the window the next
+ * frame is measured in
+ *
+ * @param ready The result of the check
+ */
+void Adafruit_SCD30::noteDataReady(bool ready) {
+  if (!ready) {
+    _not_ready_seen = true;
+    _not_ready_ms = millis();
+    _ready_seen = false;
+  } else if (!_ready_seen) {
+    _ready_seen = true;
+    _ready_ms = millis();
+  }
+  if (_idle_check) {
+    checkIdle(ready);
+  }
+}
+
+/**
+ * @brief After a warm start, restart measurement with the pressure it had if
+ * no sample has come within an interval plus `SCD30_WARM_START_MARGIN_MS` per
+ * second of it. Starting a sensor that is still running would throw away the
+ * measurement in progress.
+ *
+ * @param ready The result of the data ready check just made
+ */
+void Adafruit_SCD30::checkIdle(bool ready) {
+  if (ready) {
+    _idle_check = false;
+    return;
+  }
+  uint32_t interval = _config.measurement_interval;
+  if ((uint32_t)(millis() - _idle_check_ms) <
+      interval * 1000 + interval * SCD30_WARM_START_MARGIN_MS) {
+    return;
+  }
+  _idle_check = false;
+  startContinuousMeasurement(_config.ambient_pressure);
+}
+
+/**
+ * @brief Forget the sensor's cadence, for when it restarts measuring
+ */
+void Adafruit_SCD30::restartTiming(void) {
+  _frame_clock.reset();
+  _not_ready_seen = false;
+  _ready_seen = false;
+  // starting, stopping or resetting the sensor settles whether it runs
+  _idle_check = false;
+}
+
+/**
+ * @brief Make sure `CO2`, `temperature` and `relative_humidity` hold the
+ * latest sample, only touching the bus when the sensor may have new data
+ *
+ * The last frame is reused until a measurement interval has passed since it
+ * was read, after which `dataReady` is checked before reading a new one. With
+ * a RDY pin, checking `dataReady` is free so it is checked every time.
+ *
+ * @return true: a sample is available false: reading the first sample failed
+ */
+bool Adafruit_SCD30::updateSample(void) {
+  if (_sample_valid) {
+    // the next frame is due an interval after this one was measured
+    uint32_t age = millis() - _frame_clock.acquired();
+    if (!usingReadyPin() &&
+        (age < (uint32_t)_config.measurement_interval * 1000)) {
+      return true;
+    }
+    if (!dataReady()) {
+      return true;
+    }
+  }
+  return read();
+}
+
+/**
+ * @brief Take a measurement just read: update the readings, the frame clock,
+ * and for a new measurement the history, filters, snapshot and observers
+ *
+ * @param words The six words read from the sensor, with good CRCs
+ */
+void Adafruit_SCD30::acceptMeasurement(const uint16_t *words) {
+  _ready_flag = false;
+  unpackMeasurement(words);
+  _sample_valid = true;
+  _sample_millis = millis();
+
+  // the last data ready check found nothing new since the previous read
+  bool stale = _not_ready_seen && !_ready_seen;
+  bool fresh = _frame_clock.update(_config.measurement_interval, _ready_seen,
+                                   _not_ready_seen, _not_ready_ms,
+                                   _ready_seen ? _ready_ms : _sample_millis);
+  _not_ready_seen = false;
+  _ready_seen = false;
+  if (!fresh && stale) {
+    // the same measurement again: it is already in the history, the filters
+    // and the snapshot, and observers have seen it. The timing alone can't
+    // tell a blind read apart from the next measurement, so those are kept.
+    return;
+  }
 
-  return i2c_dev->write(buffer, sizeof(buffer));
+  if (_history) {
+    _history->add(CO2, temperature, relative_humidity,
+                  _frame_clock.acquired());
+  }
+  if (_filter) {
+    filterMeasurement(words);
+  }
+  publishSample();
+  if (_observers) {
+    notifyObservers();
+  }
 }
-bool Adafruit_SCD30::sendCommand(uint16_t command, uint16_t argument) {
 
-  uint8_t buffer[5];
-  buffer[0] = (command >> 8) & 0xFF;
-  buffer[1] = command & 0xFF;
-  buffer[2] = argument >> 8;
-  buffer[3] = argument & 0xFF;
-  buffer[4] = crc8(buffer + 2, 2);
-  return i2c_dev->write(buffer, sizeof(buffer));
+/**
+ * @brief Unpack a measurement into `CO2`, `temperature` and
+ * `relative_humidity`
+ *
+ * @param words The six words read from the sensor, with good CRCs
+ */
+void Adafruit_SCD30::unpackMeasurement(const uint16_t *words) {
+  CO2 = scd30_unpack_float(words);
+  temperature = scd30_unpack_float(words + 2);
+  relative_humidity = scd30_unpack_float(words + 4);
+}
+
+/**
+ * @brief Run a measurement through the filter, converting it to fixed point
+ * straight from the sensor's words so no floating point math is needed
+ *
+ * @param words The six words read from the sensor, with good CRCs
+ */
+void Adafruit_SCD30::filterMeasurement(const uint16_t *words) {
+  uint8_t payload[SCD30_RAW_PAYLOAD_SIZE];
+  pack_payload(words, payload);
+
+  // out of range readings are clamped, which is what the filter should see
+  scd30_compact_sample_t sample;
+  scd30_compact_from_payload(payload, &sample);
+  _filter->update(&sample);
+}
+
+/**
+ * @brief Get a configuration value, reading it from the sensor only if the
+ * driver's copy is not known to be current
+ *
+ * @param command The command to read the register with
+ * @param cached The `_config` field holding the value
+ * @param flag The `_config_valid` bit for the field
+ * @return uint16_t The register value, or the last known value if it could not
+ * be read
+ */
+uint16_t Adafruit_SCD30::getConfigValue(uint16_t command, uint16_t *cached,
+                                        uint8_t flag) {
+  if (!(_config_valid & flag)) {
+    uint16_t value;
+    if (_core.readRegister(command, &value)) {
+      *cached = value;
+      _config_valid |= flag;
+    }
+  }
+  return *cached;
 }
-uint16_t Adafruit_SCD30::readRegister(uint16_t reg_address) {
-  uint8_t buffer[2];
-  buffer[0] = (reg_address >> 8) & 0xFF;
-  buffer[1] = reg_address & 0xFF;
-  // the SCD30 really wants a stop before the read!
-  i2c_dev->write(buffer, 2);
-  delay(4); // delay between write and read specified by the datasheet
-  i2c_dev->read(buffer, 2);
-  return (uint16_t)(buffer[0] << 8 | (buffer[1] & 0xFF));
+
+/**
+ * @brief Write a configuration value and update the driver's copy of it
+ *
+ * @param command The command to write the register with
+ * @param value The value to write
+ * @param cached The `_config` field holding the value
+ * @param flag The `_config_valid` bit for the field
+ * @return true: success false: failure
+ */
+bool Adafruit_SCD30::setConfigValue(uint16_t command, uint16_t value,
+                                    uint16_t *cached, uint8_t flag) {
+  if (!_core.sendCommand(command, value)) {
+    // the sensor may or may not have taken the value
+    _config_valid &= ~flag;
+    return false;
+  }
+  *cached = value;
+  _config_valid |= flag;
+  return true;
 }
 
 /*!
@@ -369,9 +1210,16 @@ Adafruit_Sensor *Adafruit_SCD30::getTemperatureSensor(void) {
   return temp_sensor;
 }
 
+/*!
+    @brief  Gets an Adafruit Unified Sensor object for the CO2 sensor component
+    @return Adafruit_Sensor pointer to CO2 sensor
+ */
+Adafruit_Sensor *Adafruit_SCD30::getCO2Sensor(void) { return co2_sensor; }
+
 /**************************************************************************/
 /*!
-    @brief  Gets the humidity sensor and temperature values as sensor events
+    @brief  Gets the humidity sensor and temperature values as sensor events,
+   stamped with when the sensor measured them
     @param  humidity Sensor event object that will be populated with humidity
    data
     @param  temp Sensor event object that will be populated with temp data
@@ -380,10 +1228,10 @@ Adafruit_Sensor *Adafruit_SCD30::getTemperatureSensor(void) {
 /**************************************************************************/
 bool Adafruit_SCD30::getEvent(sensors_event_t *humidity,
                               sensors_event_t *temp) {
-  uint32_t t = millis();
   if (!read()) {
     return false;
   }
+  uint32_t t = _frame_clock.acquired();
 
   // use helpers to fill in the events
   fillHumidityEvent(humidity, t);
@@ -391,6 +1239,30 @@ bool Adafruit_SCD30::getEvent(sensors_event_t *humidity,
   return true;
 }
 
+/**************************************************************************/
+/*!
+    @brief  Gets the CO2, temperature and humidity values from a single read
+   as sensor events sharing one timestamp, when the sensor measured them
+    @param  co2 Sensor event object that will be populated with CO2 data
+    @param  temp Sensor event object that will be populated with temp data
+    @param  humidity Sensor event object that will be populated with humidity
+   data
+    @returns True on success, false if the read failed
+*/
+/**************************************************************************/
+bool Adafruit_SCD30::getEvents(sensors_event_t *co2, sensors_event_t *temp,
+                               sensors_event_t *humidity) {
+  if (!read()) {
+    return false;
+  }
+  uint32_t t = _frame_clock.acquired();
+
+  fillCO2Event(co2, t);
+  fillTempEvent(temp, t);
+  fillHumidityEvent(humidity, t);
+  return true;
+}
+
 void Adafruit_SCD30::fillHumidityEvent(sensors_event_t *humidity,
                                        uint32_t timestamp) {
   memset(humidity, 0, sizeof(sensors_event_t));
@@ -410,6 +1282,15 @@ void Adafruit_SCD30::fillTempEvent(sensors_event_t *temp, uint32_t timestamp) {
   temp->temperature = temperature;
 }
 
+void Adafruit_SCD30::fillCO2Event(sensors_event_t *co2, uint32_t timestamp) {
+  memset(co2, 0, sizeof(sensors_event_t));
+  co2->version = sizeof(sensors_event_t);
+  co2->sensor_id = _sensorid_co2;
+  co2->type = SCD30_SENSOR_TYPE_CO2;
+  co2->timestamp = timestamp;
+  co2->data[0] = CO2;
+}
+
 /**************************************************************************/
 /*!
     @brief  Gets the sensor_t data for the SCD30's humidity
@@ -434,14 +1315,17 @@ void Adafruit_SCD30_Humidity::getSensor(sensor_t *sensor) {
 
 /**************************************************************************/
 /*!
-    @brief  Gets the humidity as a standard sensor event
+    @brief  Gets the humidity as a standard sensor event, reusing the last
+   sample until the sensor has new data
     @param  event Sensor event object that will be populated
-    @returns True
+    @returns True on success, false if no sample could be read
 */
 /**************************************************************************/
 bool Adafruit_SCD30_Humidity::getEvent(sensors_event_t *event) {
-  _theSCD30->read();
-  _theSCD30->fillHumidityEvent(event, millis());
+  if (!_theSCD30->updateSample()) {
+    return false;
+  }
+  _theSCD30->fillHumidityEvent(event, _theSCD30->_frame_clock.acquired());
 
   return true;
 }
@@ -470,14 +1354,17 @@ void Adafruit_SCD30_Temp::getSensor(sensor_t *sensor) {
 
 /**************************************************************************/
 /*!
-    @brief  Gets the temperature as a standard sensor event
+    @brief  Gets the temperature as a standard sensor event, reusing the last
+   sample until the sensor has new data
     @param  event Sensor event object that will be populated
-    @returns True
+    @returns True on success, false if no sample could be read
 */
 /**************************************************************************/
 bool Adafruit_SCD30_Temp::getEvent(sensors_event_t *event) {
-  _theSCD30->read();
-  _theSCD30->fillTempEvent(event, millis());
+  if (!_theSCD30->updateSample()) {
+    return false;
+  }
+  _theSCD30->fillTempEvent(event, _theSCD30->_frame_clock.acquired());
 
   return true;
 }
@@ -490,27 +1377,58 @@ bool Adafruit_SCD30_Temp::getEvent(sensors_event_t *event) {
  *
  * @return The computed CRC8 value.
  */
-static uint8_t crc8(const uint8_t *data, int len) {
-  /*
-   *
-   * CRC-8 formula from page 14 of SHT spec pdf
-   *
-   * Test data 0xBE, 0xEF should yield 0x92
-   *
-   * Initialization data 0xFF
-   * Polynomial 0x31 (x8 + x5 +x4 +1)
-   * Final XOR 0x00
-   */
-
-  const uint8_t POLYNOMIAL(0x31);
-  uint8_t crc(0xFF);
-
-  for (int j = len; j; --j) {
-    crc ^= *data++;
-
-    for (int i = 8; i; --i) {
-      crc = (crc & 0x80) ? (crc << 1) ^ POLYNOMIAL : (crc << 1);
-    }
+uint8_t Adafruit_SCD30::crc8(const uint8_t *data, uint8_t len) {
+  return scd30_crc8(data, len);
+}
+
+/**
+ * @brief Check the CRC of every word in a frame read from the sensor
+ *
+ * @param frame The frame, made of 16 bit big-endian words each followed by
+ * their CRC8 (MSB, LSB, CRC)
+ * @param len The length of the frame in bytes, a multiple of three
+ * @return true: all CRCs match false: at least one word is corrupted
+ */
+bool Adafruit_SCD30::validateFrame(const uint8_t *frame, uint8_t len) {
+  return scd30_validate_frame(frame, len);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Gets the sensor_t data for the SCD30's CO2
+*/
+/**************************************************************************/
+void Adafruit_SCD30_CO2::getSensor(sensor_t *sensor) {
+  /* Clear the sensor_t object */
+  memset(sensor, 0, sizeof(sensor_t));
+
+  /* Insert the sensor name in the fixed length char array */
+  strncpy(sensor->name, "SCD30_CO2", sizeof(sensor->name) - 1);
+  sensor->name[sizeof(sensor->name) - 1] = 0;
+  sensor->version = 1;
+  sensor->sensor_id = _sensorID;
+  sensor->type = SCD30_SENSOR_TYPE_CO2;
+  sensor->min_delay = 0;
+  // measurement range from the datasheet, in ppm
+  sensor->min_value = 0;
+  sensor->max_value = 40000;
+  sensor->resolution = 1;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Gets the CO2 concentration in ppm as a standard sensor event,
+   reusing the last sample until the sensor has new data. The value is stored
+   in `data[0]`
+    @param  event Sensor event object that will be populated
+    @returns True on success, false if no sample could be read
+*/
+/**************************************************************************/
+bool Adafruit_SCD30_CO2::getEvent(sensors_event_t *event) {
+  if (!_theSCD30->updateSample()) {
+    return false;
   }
-  return crc;
+  _theSCD30->fillCO2Event(event, _theSCD30->_frame_clock.acquired());
+
+  return true;
 }
@@ -16,33 +16,32 @@
 #ifndef _ADAFRUIT_SCD30_H
 #define _ADAFRUIT_SCD30_H
 
+#include "Adafruit_SCD30_Compact.h"
+#include "Adafruit_SCD30_Filter.h"
+#include "Adafruit_SCD30_Frame.h"
+#include "Adafruit_SCD30_History.h"
+#include "Adafruit_SCD30_Timing.h"
+#include "Adafruit_SCD30_Transport.h"
 #include "Arduino.h"
 #include <Adafruit_BusIO_Register.h>
 #include <Adafruit_I2CDevice.h>
 #include <Adafruit_Sensor.h>
 #include <Wire.h>
+#include <new>
 #define SCD30_I2CADDR_DEFAULT 0x61 ///< SCD30 default i2c address
 #define SCD30_CHIP_ID 0x60         ///< SCD30 default device id from WHOAMI
 
-#define SCD30_WHOAMI 0xD100 ///< Chip ID register
-
-#define SCD30_CMD_READ_MEASUREMENT 0x0300 ///< Main data register
-
-#define SCD30_CMD_CONTINUOUS_MEASUREMENT                                       \
-  0x0010 ///< Command to start continuous measurement
-#define SCD30_CMD_STOP_MEASUREMENTS 0x0104 ///< Command to stop measurements
-#define SCD30_CMD_SET_MEASUREMENT_INTERVAL                                     \
-  0x4600                                ///< Command to set measurement interval
-#define SCD30_CMD_GET_DATA_READY 0x0202 ///< Data ready reg
-#define SCD30_CMD_AUTOMATIC_SELF_CALIBRATION                                   \
-  0x5306 ///< enables/disables auto calibration
-#define SCD30_CMD_SET_FORCED_RECALIBRATION_REF                                 \
-  0x5204 ///< Forces calibration with given value
-#define SCD30_CMD_SET_TEMPERATURE_OFFSET 0x5403 ///< Specifies the temp offset
-#define SCD30_CMD_SET_ALTITUDE_COMPENSATION                                    \
-  0x5102                               ///< Specifies altitude offset
-#define SCD30_CMD_SOFT_RESET 0xD304    ///< Soft reset!
-#define SCD30_CMD_READ_REVISION 0xD100 ///< Firmware revision number
+#define SCD30_MAX_READY_INTERRUPTS                                             \
+  2 ///< Number of SCD30s that can have their RDY pin attached to an interrupt
+
+#if defined(ARDUINO_ISR_ATTR)
+#define SCD30_ISR_ATTR ARDUINO_ISR_ATTR ///< Places ISR code in RAM if needed
+#else
+#define SCD30_ISR_ATTR ///< Places ISR code in RAM if needed
+#endif
+
+#define SCD30_SENSOR_TYPE_CO2                                                  \
+  21 ///< Unified Sensor type for CO2 events, value is stored in `data[0]`
 ///////////////////////////////////////////////////////////////
 /**
  * @brief
@@ -57,6 +56,92 @@ typedef enum {
   SCD30_RATE_25_HZ,
 } scd30_rate_t;
 
+#define SCD30_WARM_START_MARGIN_MS                                             \
+  50 ///< Extra wait per second of interval for a slow sensor clock (5%)
+
+#define SCD30_SNAPSHOT_TRIES                                                   \
+  4 ///< Reads of a snapshot before `getSnapshot` gives up on a busy writer
+
+#if defined(__AVR__)
+/** Single core, only stop the compiler reordering memory accesses */
+#define SCD30_MEMORY_BARRIER() __asm__ __volatile__("" ::: "memory")
+#else
+/** Order memory accesses across cores */
+#define SCD30_MEMORY_BARRIER() __sync_synchronize()
+#endif
+
+/**
+ * @brief
+ *
+ * A consistent copy of the latest sample, from `getSnapshot`.
+ */
+typedef struct {
+  float CO2;               ///< CO2 concentration in ppm
+  float temperature;       ///< Temperature in degrees C
+  float relative_humidity; ///< Relative humidity in %
+  uint32_t timestamp;      ///< `millis()` when the sensor measured it
+  uint32_t sequence;       ///< Number of the sample, the first is 1
+  uint32_t frame;          ///< Number of the sensor's measurement: gaps are
+                           ///< missed measurements
+} scd30_snapshot_t;
+
+#define SCD30_OBSERVE_CO2                                                      \
+  (1 << SCD30_CHANNEL_CO2) ///< CO2 moved past its deadband
+#define SCD30_OBSERVE_TEMPERATURE                                              \
+  (1 << SCD30_CHANNEL_TEMPERATURE) ///< Temperature moved past its deadband
+#define SCD30_OBSERVE_HUMIDITY                                                 \
+  (1 << SCD30_CHANNEL_HUMIDITY) ///< Humidity moved past its deadband
+#define SCD30_OBSERVE_SILENCE                                                  \
+  (1 << SCD30_CHANNEL_COUNT) ///< Nothing was reported for `max_silence_ms`
+
+/**
+ * @brief
+ *
+ * How far each channel must move from the last reported sample before an
+ * observer is called. A negative deadband ignores the channel.
+ */
+typedef struct {
+  float co2;               ///< CO2 deadband in ppm
+  float temperature;       ///< Temperature deadband in degrees C
+  float relative_humidity; ///< Humidity deadband in %
+  uint32_t max_silence_ms; ///< Report anyway after this long, 0 never does
+} scd30_deadband_t;
+
+/**
+ * @brief Called by `Adafruit_SCD30::read` and `pollRead` with a new sample
+ * that an observer should report
+ *
+ * @param sample The new sample
+ * @param reasons Why it is reported, `SCD30_OBSERVE_*` flags. The first sample
+ * has every channel flag set.
+ * @param context The context pointer given to `addObserver`
+ */
+typedef void (*scd30_observer_callback_t)(const scd30_snapshot_t *sample,
+                                          uint8_t reasons, void *context);
+
+/**
+ * @brief
+ *
+ * An observer, owned by the caller and registered with `addObserver`.
+ */
+typedef struct scd30_observer {
+  scd30_observer_callback_t callback;  ///< Called with samples to report
+  void *context;                       ///< Passed to `callback`
+  scd30_deadband_t deadband;           ///< When to report
+  float reported[SCD30_CHANNEL_COUNT]; ///< Sample last reported
+  uint32_t reported_ms;                ///< `millis()` of the last report
+  bool reported_valid;                 ///< True once a sample was reported
+  struct scd30_observer *next;         ///< Next registered observer
+} scd30_observer_t;
+
+/**
+ * @brief Reads the level of the SCD30's RDY pin
+ *
+ * @param context The context pointer given to `setReadyPinReader`
+ * @return true: the pin is high, new data is ready
+ */
+typedef bool (*scd30_pin_read_t)(void *context);
+
 class Adafruit_SCD30;
 
 /** Adafruit Unified Sensor interface for temperature component of SCD30 */
@@ -88,6 +173,20 @@ private:
   Adafruit_SCD30 *_theSCD30 = NULL;
 };
 
+/** Adafruit Unified Sensor interface for the CO2 sensor component of SCD30 */
+class Adafruit_SCD30_CO2 : public Adafruit_Sensor {
+public:
+  /** @brief Create an Adafruit_Sensor compatible object for the CO2 sensor
+      @param parent A pointer to the SCD30 class */
+  Adafruit_SCD30_CO2(Adafruit_SCD30 *parent) { _theSCD30 = parent; }
+  bool getEvent(sensors_event_t *);
+  void getSensor(sensor_t *);
+
+private:
+  int _sensorID = 0xC02 + 2;
+  Adafruit_SCD30 *_theSCD30 = NULL;
+};
+
 /*!
  *    @brief  Class that stores state and functions for interacting with
  *            the SCD30 CO2, Temperature, and Humidity sensor
@@ -98,13 +197,29 @@ public:
   ~Adafruit_SCD30();
 
   bool begin(uint8_t i2c_addr = SCD30_I2CADDR_DEFAULT, TwoWire *wire = &Wire,
-             int32_t sensor_id = 0);
+             int32_t sensor_id = 0, int8_t ready_pin = -1,
+             bool warm_start = false);
+  bool begin(Adafruit_SCD30_Transport *transport, int32_t sensor_id = 0,
+             int8_t ready_pin = -1, bool warm_start = false);
 
   void reset(void);
+  uint16_t getFirmwareRevision(void);
   bool dataReady(void);
+  void setReadyPinReader(scd30_pin_read_t reader, void *context = NULL);
+  void SCD30_ISR_ATTR dataReadyISR(void);
   bool getEvent(sensors_event_t *humidity, sensors_event_t *temp);
+  bool getEvents(sensors_event_t *co2, sensors_event_t *temp,
+                 sensors_event_t *humidity);
 
   bool read(void);
+  bool beginRead(void);
+  scd30_read_status_t pollRead(void);
+  bool getSnapshot(scd30_snapshot_t *snapshot);
+  void getTiming(scd30_timing_t *timing);
+  bool readRaw(uint8_t *payload);
+  scd30_read_status_t pollReadRaw(uint8_t *payload);
+  bool beginDataReady(void);
+  scd30_read_status_t pollDataReady(bool *ready);
 
   uint16_t getMeasurementInterval(void);
   bool setMeasurementInterval(uint16_t interval);
@@ -113,6 +228,7 @@ public:
   bool selfCalibrationEnabled(bool);
 
   bool startContinuousMeasurement(uint16_t pressure = 0);
+  bool stopContinuousMeasurement(void);
   uint16_t getAmbientPressureOffset(void);
 
   bool setAltitudeOffset(uint16_t altitude);
@@ -124,8 +240,30 @@ public:
   bool forceRecalibrationWithReference(uint16_t reference);
   uint16_t getForcedCalibrationReference(void);
 
+  void setHistory(Adafruit_SCD30_HistoryBase *history);
+  void setFilter(Adafruit_SCD30_Filter *filter);
+
+  bool addObserver(scd30_observer_t *observer,
+                   scd30_observer_callback_t callback, void *context,
+                   const scd30_deadband_t *deadband = NULL);
+  bool removeObserver(scd30_observer_t *observer);
+
+  void setRetryPolicy(const scd30_retry_policy_t *policy);
+  void getRetryPolicy(scd30_retry_policy_t *policy);
+
+  void setStats(scd30_stats_t *stats);
+  bool getStats(scd30_stats_t *snapshot);
+  void resetStats(void);
+
+  bool getConfig(scd30_config_t *config);
+  bool refreshConfig(void);
+
+  static uint8_t crc8(const uint8_t *data, uint8_t len);
+  static bool validateFrame(const uint8_t *frame, uint8_t len);
+
   Adafruit_Sensor *getTemperatureSensor(void);
   Adafruit_Sensor *getHumiditySensor(void);
+  Adafruit_Sensor *getCO2Sensor(void);
   float CO2,             ///< The most recent CO2 reading
       temperature,       ///< The most recent temperature reading
       relative_humidity; ///< The most recent relative_humidity reading
@@ -133,15 +271,61 @@ public:
 
 protected:
   virtual bool _init(int32_t sensor_id);
+  bool _warmStart(void);
+
+  bool _warm_start = false;    ///< Keep the running sensor state in `_init`
+  bool _idle_check = false;    ///< Warm started, no sample seen since
+  uint32_t _idle_check_ms = 0; ///< `millis()` when the warm start finished
 
   uint16_t _sensorid_humidity, ///< ID number for humidity
-      _sensorid_temp;          ///< ID number for temperature
+      _sensorid_temp,          ///< ID number for temperature
+      _sensorid_co2;           ///< ID number for CO2
 
   Adafruit_I2CDevice *i2c_dev = NULL; ///< Pointer to I2C bus interface
+  Adafruit_SCD30_Core _core;          ///< Transfers on the sensor's bus
 
   Adafruit_SCD30_Temp *temp_sensor = NULL; ///< Temp sensor data object
   Adafruit_SCD30_Humidity *humidity_sensor =
-      NULL; ///< Humidity sensor data object
+      NULL;                              ///< Humidity sensor data object
+  Adafruit_SCD30_CO2 *co2_sensor = NULL; ///< CO2 sensor data object
+
+  bool _sample_valid = false;  ///< True once a frame has been read
+  uint32_t _sample_millis = 0; ///< `millis()` when the last frame was read
+
+  Adafruit_SCD30_FrameClock _frame_clock; ///< When each frame was measured
+  bool _not_ready_seen = false;           ///< Checked, no new data since read
+  uint32_t _not_ready_ms = 0;             ///< `millis()` of the last such check
+  bool _ready_seen = false;               ///< Checked, new data since read
+  uint32_t _ready_ms = 0;                 ///< `millis()` of the first one
+  volatile uint32_t _ready_edge_ms = 0;   ///< `millis()` of the RDY edge
+
+  Adafruit_SCD30_HistoryBase *_history = NULL; ///< Records each sample read
+  Adafruit_SCD30_Filter *_filter = NULL;       ///< Filters each sample read
+  scd30_observer_t *_observers = NULL;         ///< Observers to notify
+
+  /** Sample published for other tasks, guarded by `_snapshot_seq` */
+  scd30_snapshot_t _snapshot = {0, 0, 0, 0, 0, 0};
+  volatile uint32_t _snapshot_seq = 0; ///< Odd while `_snapshot` is written
+
+  int8_t _ready_pin = -1;  ///< RDY pin, -1 if not connected
+  int8_t _ready_slot = -1; ///< RDY interrupt slot, -1 if none
+
+  scd30_pin_read_t _ready_pin_reader = NULL; ///< Custom RDY pin reader
+  void *_ready_pin_context = NULL;           ///< Context for the pin reader
+  volatile bool _ready_flag = false;         ///< Set by `dataReadyISR`
+
+  /** In-object storage for `i2c_dev`, so (re)starting needs no heap */
+  alignas(Adafruit_I2CDevice) uint8_t
+      _i2c_dev_storage[sizeof(Adafruit_I2CDevice)];
+  Adafruit_SCD30_I2C _i2c_transport; ///< Transport used by the I2C `begin`
+
+  Adafruit_SCD30_Temp _temp_sensor_storage;         ///< Backs `temp_sensor`
+  Adafruit_SCD30_Humidity _humidity_sensor_storage; ///< Backs `humidity_sensor`
+  Adafruit_SCD30_CO2 _co2_sensor_storage;           ///< Backs `co2_sensor`
+
+  scd30_config_t _config = {2, 0, 0, 0, 0, 0}; ///< Shadow of the sensor config
+  uint8_t _config_valid = 0;                   ///< Bitmask of `_config` fields
+                                               ///< known to match the sensor
 
 private:
   friend class Adafruit_SCD30_Temp;     ///< Gives access to private members to
@@ -149,14 +333,28 @@ private:
   friend class Adafruit_SCD30_Humidity; ///< Gives access to private
                                         ///< members to Humidity data
                                         ///< object
+  friend class Adafruit_SCD30_CO2;      ///< Gives access to private members to
+                                        ///< CO2 data object
 
+  bool updateSample(void);
+  void publishSample(void);
+  void notifyObservers(void);
+  void noteDataReady(bool ready);
+  void checkIdle(bool ready);
+  void restartTiming(void);
+  bool usingReadyPin(void);
+  void attachReadyPin(int8_t pin);
+  void detachReadyPin(void);
   void fillHumidityEvent(sensors_event_t *humidity, uint32_t timestamp);
   void fillTempEvent(sensors_event_t *temp, uint32_t timestamp);
-  bool sendCommand(uint16_t command, uint16_t argument);
-  bool sendCommand(uint16_t command);
+  void fillCO2Event(sensors_event_t *co2, uint32_t timestamp);
+  void acceptMeasurement(const uint16_t *words);
+  void unpackMeasurement(const uint16_t *words);
+  void filterMeasurement(const uint16_t *words);
   uint16_t getAmbiendPressure(void);
-  uint8_t computeCRC8(uint8_t data[], uint8_t len);
-  uint16_t readRegister(uint16_t reg_address);
+  uint16_t getConfigValue(uint16_t command, uint16_t *cached, uint8_t flag);
+  bool setConfigValue(uint16_t command, uint16_t value, uint16_t *cached,
+                      uint8_t flag);
 };
 
 #endif
@@ -0,0 +1,228 @@
+/*!
+ *  @file Adafruit_SCD30_Adaptive.cpp
+ *
+ * 	Adaptive measurement interval control for the Adafruit SCD30 CO2,
+ * 	Temperature, and Humidity sensor library
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ * 	BSD (see license.txt)
+ */
+
+#include "Adafruit_SCD30_Adaptive.h"
+
+/**
+ * @brief Construct a new Adafruit_SCD30_AdaptiveInterval object
+ *
+ * @param sensor The sensor's driver, already started with `begin`
+ */
+Adafruit_SCD30_AdaptiveInterval::Adafruit_SCD30_AdaptiveInterval(
+    Adafruit_SCD30 *sensor)
+    : _sensor(sensor) {}
+
+/**
+ * @brief Start controlling the interval, keeping the sensor's current
+ * interval if it is within the bounds
+ *
+ * @param min_interval The interval while CO2 changes quickly, from 2 seconds
+ * @param max_interval The interval while CO2 is steady, up to 1800 seconds
+ * @return true: success false: the bounds are out of range or the interval
+ * could not be set
+ */
+bool Adafruit_SCD30_AdaptiveInterval::begin(uint16_t min_interval,
+                                            uint16_t max_interval) {
+  if ((min_interval < 2) || (max_interval > 1800) ||
+      (min_interval > max_interval)) {
+    return false;
+  }
+  _policy.min_interval = min_interval;
+  _policy.max_interval = max_interval;
+
+  _valid = false;
+  _window_count = 0;
+  _window_sum = 0;
+  _window_offsets = 0;
+  _rate = 0;
+  _calm_count = 0;
+  _writes = 0;
+  _budget_tokens = _policy.writes_per_day;
+  _budget_ms = millis();
+  _changed_ms = _budget_ms;
+
+  uint16_t interval = _sensor->getMeasurementInterval();
+  if (interval < min_interval) {
+    return setInterval(min_interval);
+  }
+  if (interval > max_interval) {
+    return setInterval(max_interval);
+  }
+  return true;
+}
+
+/**
+ * @brief Change when the interval is changed. The bounds are checked like
+ * `begin`'s; out of range bounds are ignored.
+ *
+ * @param policy The policy to use
+ */
+void Adafruit_SCD30_AdaptiveInterval::setPolicy(
+    const scd30_adaptive_policy_t *policy) {
+  uint16_t min_interval = _policy.min_interval;
+  uint16_t max_interval = _policy.max_interval;
+
+  _policy = *policy;
+  if ((_policy.min_interval < 2) || (_policy.max_interval > 1800) ||
+      (_policy.min_interval > _policy.max_interval)) {
+    _policy.min_interval = min_interval;
+    _policy.max_interval = max_interval;
+  }
+}
+
+/**
+ * @brief Get the policy used to change the interval
+ *
+ * @param policy Where to store the policy
+ */
+void Adafruit_SCD30_AdaptiveInterval::getPolicy(
+    scd30_adaptive_policy_t *policy) {
+  *policy = _policy;
+}
+
+/**
+ * @brief Take the sample just read into account. Call after every successful
+ * `read`.
+ *
+ * Samples are averaged over windows of at least `SCD30_ADAPTIVE_WINDOW_S` and
+ * `SCD30_ADAPTIVE_WINDOW_SAMPLES` samples, and the rate of change is measured
+ * between the means of consecutive windows, so the sensor's noise between
+ * close samples doesn't look like a trend.
+ *
+ * @return true: the interval was changed false: it was kept
+ */
+bool Adafruit_SCD30_AdaptiveInterval::update(void) {
+  uint32_t now = millis();
+  bool changed = false;
+
+  if ((_window_count >= SCD30_ADAPTIVE_WINDOW_SAMPLES) &&
+      ((uint32_t)(now - _window_ms) >= SCD30_ADAPTIVE_WINDOW_S * 1000UL)) {
+    changed = evaluate(now);
+  }
+
+  if (!_window_count) {
+    _window_ms = now;
+  }
+  _window_sum += _sensor->CO2;
+  _window_offsets += now - _window_ms;
+  _window_count++;
+  return changed;
+}
+
+/**
+ * @brief Close the current window, measure the rate of change since the last
+ * one and change the interval if it calls for it
+ *
+ * @param now `millis()` of the sample that closed the window
+ * @return true: the interval was changed false: it was kept
+ */
+bool Adafruit_SCD30_AdaptiveInterval::evaluate(uint32_t now) {
+  float co2 = _window_sum / _window_count;
+  uint32_t center = _window_ms + _window_offsets / _window_count;
+  _window_sum = 0;
+  _window_offsets = 0;
+  _window_count = 0;
+
+  uint32_t elapsed = center - _previous_ms;
+  bool valid = _valid && elapsed;
+  if (valid) {
+    _rate = (co2 - _previous_co2) * 60000.0f / elapsed;
+  }
+  _previous_co2 = co2;
+  _previous_ms = center;
+  _valid = true;
+  if (!valid) {
+    return false;
+  }
+
+  float change = (_rate < 0) ? -_rate : _rate;
+  if (change >= _policy.rise_rate) {
+    // catch the whole change: go straight to the shortest interval
+    _calm_count = 0;
+    return setInterval(_policy.min_interval);
+  }
+
+  if (change > _policy.calm_rate) {
+    // between the rates: keep the interval
+    _calm_count = 0;
+    return false;
+  }
+
+  if (_calm_count < _policy.calm_samples) {
+    _calm_count++;
+  }
+  if ((_calm_count < _policy.calm_samples) ||
+      ((uint32_t)(now - _changed_ms) < _policy.hold_s * 1000UL)) {
+    return false;
+  }
+
+  uint32_t longer = (uint32_t)_sensor->getMeasurementInterval() * 2;
+  if (longer > _policy.max_interval) {
+    longer = _policy.max_interval;
+  }
+  _calm_count = 0;
+  return setInterval(longer);
+}
+
+/**
+ * @brief Add the writes earned since the budget was last topped up. One write
+ * is earned every 24 hours / `writes_per_day`, and at most `writes_per_day`
+ * are kept.
+ *
+ * @param now `millis()`
+ */
+void Adafruit_SCD30_AdaptiveInterval::refillBudget(uint32_t now) {
+  uint16_t capacity = _policy.writes_per_day;
+  if (!capacity) {
+    _budget_tokens = 0;
+    return;
+  }
+
+  uint32_t refill_ms = SCD30_ADAPTIVE_DAY_MS / capacity;
+  uint32_t earned = (uint32_t)(now - _budget_ms) / refill_ms;
+  if (_budget_tokens + earned >= capacity) {
+    // full: time spent full earns nothing
+    _budget_tokens = capacity;
+    _budget_ms = now;
+  } else {
+    _budget_tokens += earned;
+    _budget_ms += earned * refill_ms;
+  }
+}
+
+/**
+ * @brief Write a new interval, unless the sensor already has it or the write
+ * budget is spent
+ *
+ * @param interval The interval in seconds
+ * @return true: the interval was written false: it was not
+ */
+bool Adafruit_SCD30_AdaptiveInterval::setInterval(uint16_t interval) {
+  if (_sensor->getMeasurementInterval() == interval) {
+    return false;
+  }
+
+  uint32_t now = millis();
+  refillBudget(now);
+  if (!_budget_tokens) {
+    return false;
+  }
+
+  if (!_sensor->setMeasurementInterval(interval)) {
+    return false;
+  }
+  _budget_tokens--;
+  _writes++;
+  _changed_ms = now;
+  return true;
+}
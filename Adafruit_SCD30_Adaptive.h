@@ -0,0 +1,101 @@
+/*!
+ *  @file Adafruit_SCD30_Adaptive.h
+ *
+ * 	Adaptive measurement interval control for the Adafruit SCD30 CO2,
+ * 	Temperature, and Humidity sensor library
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	 license (see license.txt)
+ */
+
+#ifndef _ADAFRUIT_SCD30_ADAPTIVE_H
+#define _ADAFRUIT_SCD30_ADAPTIVE_H
+
+#include "Adafruit_SCD30.h"
+
+#define SCD30_ADAPTIVE_WINDOW_S                                                \
+  60 ///< Samples in a window this long are averaged to measure the rate
+#define SCD30_ADAPTIVE_WINDOW_SAMPLES                                          \
+  3 ///< Fewest samples averaged per window, for long intervals
+#define SCD30_ADAPTIVE_DAY_MS                                                  \
+  86400000UL ///< Time in which `writes_per_day` writes are earned back
+
+/**
+ * @brief
+ *
+ * When `Adafruit_SCD30_AdaptiveInterval` changes the measurement interval,
+ * set with `setPolicy`.
+ */
+typedef struct {
+  uint16_t min_interval;   ///< Interval while CO2 changes quickly, seconds
+  uint16_t max_interval;   ///< Interval while CO2 is steady, seconds
+  uint16_t rise_rate;      ///< Change in ppm/minute that shortens the interval
+  uint16_t calm_rate;      ///< Change in ppm/minute that counts as steady
+  uint8_t calm_samples;    ///< Steady rates in a row before lengthening
+  uint16_t hold_s;         ///< Shortest time between lengthening steps
+  uint16_t writes_per_day; ///< Interval writes earned back per 24 hours
+} scd30_adaptive_policy_t;
+
+/*!
+ *    @brief  Shortens the measurement interval while CO2 changes quickly and
+ *            lengthens it while CO2 is steady. Rising or falling faster than
+ *            `rise_rate` jumps straight to `min_interval`; every
+ *            `calm_samples` steady rates double the interval, at most once
+ *            per `hold_s`. The gap between the two rates is the hysteresis.
+ *
+ *            The SCD30 keeps its interval in non-volatile memory, so every
+ *            change is a flash write. Writes come out of a budget that holds
+ *            at most `writes_per_day` and earns one back every 24 hours /
+ *            `writes_per_day`: over days writes average at most
+ *            `writes_per_day` a day, bursts use at most a full budget, and
+ *            any 24 hours see at most twice `writes_per_day`. Values the
+ *            sensor already has are never written.
+ */
+class Adafruit_SCD30_AdaptiveInterval {
+public:
+  Adafruit_SCD30_AdaptiveInterval(Adafruit_SCD30 *sensor);
+
+  bool begin(uint16_t min_interval, uint16_t max_interval);
+  void setPolicy(const scd30_adaptive_policy_t *policy);
+  void getPolicy(scd30_adaptive_policy_t *policy);
+
+  bool update(void);
+
+  /** @brief Get the last measured rate of change of CO2
+      @return The rate in ppm/minute, negative while falling */
+  float getRate(void) const { return _rate; }
+  /** @brief Get the number of interval writes made since `begin`
+      @return The number of writes */
+  uint32_t getWrites(void) const { return _writes; }
+
+private:
+  bool evaluate(uint32_t now);
+  bool setInterval(uint16_t interval);
+  void refillBudget(uint32_t now);
+
+  Adafruit_SCD30 *_sensor; ///< The sensor's driver
+
+  /** When to change the interval: 15 ppm/minute is a room filling up, 5
+      ppm/minute is within the sensor's noise over a minute */
+  scd30_adaptive_policy_t _policy = {2, 300, 15, 5, 5, 600, 48};
+
+  bool _valid = false;             ///< True once a window has been closed
+  float _previous_co2 = 0;         ///< Mean CO2 of the last window
+  uint32_t _previous_ms = 0;       ///< `millis()` at the last window's center
+  uint32_t _window_ms = 0;         ///< `millis()` the current window started
+  float _window_sum = 0;           ///< Sum of the window's CO2 samples
+  uint32_t _window_offsets = 0;    ///< Sum of the samples' times in the window
+  uint16_t _window_count = 0;      ///< Number of samples in the window
+  float _rate = 0;                 ///< Last rate of change, ppm/minute
+  uint8_t _calm_count = 0;         ///< Steady rates in a row
+  uint32_t _changed_ms = 0;        ///< `millis()` of the last interval write
+  uint32_t _budget_ms = 0;         ///< `millis()` the budget is earned up to
+  uint16_t _budget_tokens = 0;     ///< Writes left in the budget
+  uint32_t _writes = 0;            ///< Writes made since `begin`
+};
+
+#endif
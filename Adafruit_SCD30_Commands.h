@@ -0,0 +1,69 @@
+/*!
+ *  @file Adafruit_SCD30_Commands.h
+ *
+ * 	Command codes and transfer results for the Adafruit SCD30 CO2,
+ * 	Temperature, and Humidity sensor library. Needs nothing from the Arduino
+ * 	core.
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	 license (see license.txt)
+ */
+
+#ifndef _ADAFRUIT_SCD30_COMMANDS_H
+#define _ADAFRUIT_SCD30_COMMANDS_H
+
+#include <stdint.h>
+
+#define SCD30_WHOAMI 0xD100 ///< Chip ID register
+
+#define SCD30_CMD_READ_MEASUREMENT 0x0300 ///< Main data register
+
+#define SCD30_CMD_CONTINUOUS_MEASUREMENT                                       \
+  0x0010 ///< Command to start continuous measurement
+#define SCD30_CMD_STOP_MEASUREMENTS 0x0104 ///< Command to stop measurements
+#define SCD30_CMD_SET_MEASUREMENT_INTERVAL                                     \
+  0x4600                                ///< Command to set measurement interval
+#define SCD30_CMD_GET_DATA_READY 0x0202 ///< Data ready reg
+#define SCD30_CMD_AUTOMATIC_SELF_CALIBRATION                                   \
+  0x5306 ///< enables/disables auto calibration
+#define SCD30_CMD_SET_FORCED_RECALIBRATION_REF                                 \
+  0x5204 ///< Forces calibration with given value
+#define SCD30_CMD_SET_TEMPERATURE_OFFSET 0x5403 ///< Specifies the temp offset
+#define SCD30_CMD_SET_ALTITUDE_COMPENSATION                                    \
+  0x5102                               ///< Specifies altitude offset
+#define SCD30_CMD_SOFT_RESET 0xD304    ///< Soft reset!
+#define SCD30_CMD_READ_REVISION 0xD100 ///< Firmware revision number
+
+#define SCD30_READ_DELAY_US                                                    \
+  4000 ///< Gap between command write and data read, from the datasheet
+#define SCD30_MAX_RESPONSE_WORDS 6 ///< Longest response, a measurement
+
+/**
+ * @brief
+ *
+ * Result of polling an asynchronous read with `pollRead` or `pollDataReady`.
+ */
+typedef enum {
+  SCD30_READ_IDLE,    ///< No read has been started
+  SCD30_READ_PENDING, ///< Waiting for the datasheet write/read gap to elapse
+  SCD30_READ_READY,   ///< New data has been read and unpacked
+  SCD30_READ_ERROR,   ///< The bus transfer or CRC check failed
+} scd30_read_status_t;
+
+/**
+ * @brief
+ *
+ * Why the last transfer of a transport failed.
+ */
+typedef enum {
+  SCD30_ERROR_NONE,     ///< The last transfer succeeded
+  SCD30_ERROR_BUS,      ///< Not acknowledged, or not answered in time
+  SCD30_ERROR_CRC,      ///< The response was corrupted
+  SCD30_ERROR_REJECTED, ///< The command is not supported or was refused
+} scd30_error_t;
+
+#endif
@@ -0,0 +1,192 @@
+/*!
+ *  @file Adafruit_SCD30_Compact.cpp
+ *
+ * 	Compact fixed point sample format for the Adafruit SCD30 CO2,
+ * 	Temperature, and Humidity sensor library
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ * 	BSD (see license.txt)
+ */
+
+#include "Adafruit_SCD30_Compact.h"
+
+/**
+ * @brief Convert an IEEE 754 single to fixed point using only integer math
+ *
+ * @param bits The float's bit pattern
+ * @param scale Fixed point units per unit of the float, at most 100
+ * @param min The smallest allowed result
+ * @param max The largest allowed result
+ * @param result Set to the value times `scale`, rounded and clamped
+ * @return true: the value was in range false: it was clamped or not a number
+ */
+static bool fixed_from_bits(uint32_t bits, uint8_t scale, int32_t min,
+                            int32_t max, int32_t *result) {
+  bool negative = bits >> 31;
+  int16_t exponent = (bits >> 23) & 0xFF;
+
+  if (exponent == 0xFF) { // infinity or NaN
+    *result = 0;
+    return false;
+  }
+
+  uint32_t magnitude = 0;
+  bool in_range = true;
+  if (exponent != 0) { // denormals round to zero
+    // mantissa times scale stays under 2^31
+    uint32_t product = ((bits & 0x7FFFFF) | 0x800000) * (uint32_t)scale;
+    int16_t shift = exponent - 150;
+
+    if (shift >= 0) {
+      if ((shift > 7) || (product > (0x7FFFFFFFUL >> shift))) {
+        magnitude = 0x7FFFFFFF;
+        in_range = false;
+      } else {
+        magnitude = product << shift;
+      }
+    } else if (shift > -32) {
+      magnitude = (product + (1UL << (-shift - 1))) >> -shift;
+    }
+  }
+
+  int32_t value = negative ? -(int32_t)magnitude : (int32_t)magnitude;
+  if (value < min) {
+    value = min;
+    in_range = false;
+  } else if (value > max) {
+    value = max;
+    in_range = false;
+  }
+  *result = value;
+  return in_range;
+}
+
+/**
+ * @brief Round a value to the nearest integer, clamped to a range
+ *
+ * @param value The value to convert
+ * @param min The smallest allowed result
+ * @param max The largest allowed result
+ * @param result Set to the rounded and clamped value
+ * @return true: the value was in range false: it was clamped or not a number
+ */
+static bool fixed_from_float(float value, int32_t min, int32_t max,
+                             int32_t *result) {
+  if (!(value == value)) { // NaN
+    *result = 0;
+    return false;
+  }
+  if (value < min) {
+    *result = min;
+    return false;
+  }
+  if (value > max) {
+    *result = max;
+    return false;
+  }
+  *result = (int32_t)(value + (value < 0 ? -0.5f : 0.5f));
+  return true;
+}
+
+/**
+ * @brief Convert a raw measurement payload to a compact sample without any
+ * floating point math, for MCUs without an FPU
+ *
+ * @param payload `SCD30_RAW_PAYLOAD_SIZE` bytes from `Adafruit_SCD30::readRaw`
+ * @param sample Set to the measurement in fixed point
+ * @return true: every reading was in range false: a reading was clamped
+ */
+bool scd30_compact_from_payload(const uint8_t *payload,
+                                scd30_compact_sample_t *sample) {
+  uint32_t bits[3];
+  for (uint8_t i = 0; i < 3; i++) {
+    const uint8_t *p = payload + 4 * i;
+    bits[i] = (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 |
+              (uint32_t)p[2] << 8 | p[3];
+  }
+
+  int32_t co2, temperature, humidity;
+  bool ok = fixed_from_bits(bits[0], 10, 0, SCD30_COMPACT_CO2_MAX, &co2);
+  ok &= fixed_from_bits(bits[1], 100, INT16_MIN, INT16_MAX, &temperature);
+  ok &= fixed_from_bits(bits[2], 100, 0, SCD30_COMPACT_HUMIDITY_MAX, &humidity);
+
+  sample->co2 = co2;
+  sample->temperature = temperature;
+  sample->humidity = humidity;
+  return ok;
+}
+
+/**
+ * @brief Convert readings to a compact sample
+ *
+ * @param co2 CO2 concentration in ppm
+ * @param temperature Temperature in degrees C
+ * @param relative_humidity Relative humidity in %
+ * @param sample Set to the readings in fixed point
+ * @return true: every reading was in range false: a reading was clamped
+ */
+bool scd30_compact_from_floats(float co2, float temperature,
+                               float relative_humidity,
+                               scd30_compact_sample_t *sample) {
+  int32_t c, t, h;
+  bool ok = fixed_from_float(co2 * 10, 0, SCD30_COMPACT_CO2_MAX, &c);
+  ok &= fixed_from_float(temperature * 100, INT16_MIN, INT16_MAX, &t);
+  ok &= fixed_from_float(relative_humidity * 100, 0,
+                         SCD30_COMPACT_HUMIDITY_MAX, &h);
+
+  sample->co2 = c;
+  sample->temperature = t;
+  sample->humidity = h;
+  return ok;
+}
+
+/**
+ * @brief Convert a compact sample back to readings
+ *
+ * @param sample The sample to convert
+ * @param co2 Set to the CO2 concentration in ppm
+ * @param temperature Set to the temperature in degrees C
+ * @param relative_humidity Set to the relative humidity in %
+ */
+void scd30_compact_to_floats(const scd30_compact_sample_t *sample, float *co2,
+                             float *temperature, float *relative_humidity) {
+  *co2 = sample->co2 / 10.0f;
+  *temperature = sample->temperature / 100.0f;
+  *relative_humidity = sample->humidity / 100.0f;
+}
+
+/**
+ * @brief Pack a compact sample into `SCD30_COMPACT_SIZE` bytes: CO2 as 24
+ * bits, then temperature and humidity as 16 bits each, all big-endian
+ *
+ * @param sample The sample to pack
+ * @param buffer Where to write the `SCD30_COMPACT_SIZE` bytes
+ */
+void scd30_compact_pack(const scd30_compact_sample_t *sample, uint8_t *buffer) {
+  uint16_t temperature = sample->temperature;
+
+  buffer[0] = sample->co2 >> 16;
+  buffer[1] = sample->co2 >> 8;
+  buffer[2] = sample->co2;
+  buffer[3] = temperature >> 8;
+  buffer[4] = temperature;
+  buffer[5] = sample->humidity >> 8;
+  buffer[6] = sample->humidity;
+}
+
+/**
+ * @brief Unpack a sample packed by `scd30_compact_pack`
+ *
+ * @param buffer The `SCD30_COMPACT_SIZE` packed bytes
+ * @param sample Set to the unpacked sample
+ */
+void scd30_compact_unpack(const uint8_t *buffer,
+                          scd30_compact_sample_t *sample) {
+  sample->co2 =
+      (uint32_t)buffer[0] << 16 | (uint32_t)buffer[1] << 8 | buffer[2];
+  sample->temperature = (int16_t)((uint16_t)buffer[3] << 8 | buffer[4]);
+  sample->humidity = (uint16_t)buffer[5] << 8 | buffer[6];
+}
@@ -0,0 +1,52 @@
+/*!
+ *  @file Adafruit_SCD30_Compact.h
+ *
+ * 	Compact fixed point sample format for the Adafruit SCD30 CO2,
+ * 	Temperature, and Humidity sensor library. Needs nothing from the Arduino
+ * 	core, so samples can also be decoded on a gateway.
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	 license (see license.txt)
+ */
+
+#ifndef _ADAFRUIT_SCD30_COMPACT_H
+#define _ADAFRUIT_SCD30_COMPACT_H
+
+#include <stdint.h>
+
+#define SCD30_RAW_PAYLOAD_SIZE                                                 \
+  12 ///< Measurement without CRCs: CO2, temp and RH as big-endian floats
+#define SCD30_COMPACT_SIZE                                                     \
+  7 ///< Packed compact sample: 24 bit CO2, 16 bit temp, 16 bit RH, big-endian
+
+#define SCD30_COMPACT_CO2_MAX 0xFFFFFF   ///< Largest CO2, in 0.1 ppm
+#define SCD30_COMPACT_HUMIDITY_MAX 10000 ///< Largest humidity, in 0.01 %
+
+/**
+ * @brief
+ *
+ * A measurement in fixed point, lossless at the sensor's resolution.
+ */
+typedef struct {
+  uint32_t co2;        ///< CO2 concentration in 0.1 ppm
+  int16_t temperature; ///< Temperature in 0.01 degrees C
+  uint16_t humidity;   ///< Relative humidity in 0.01 %
+} scd30_compact_sample_t;
+
+bool scd30_compact_from_payload(const uint8_t *payload,
+                                scd30_compact_sample_t *sample);
+bool scd30_compact_from_floats(float co2, float temperature,
+                               float relative_humidity,
+                               scd30_compact_sample_t *sample);
+void scd30_compact_to_floats(const scd30_compact_sample_t *sample, float *co2,
+                             float *temperature, float *relative_humidity);
+
+void scd30_compact_pack(const scd30_compact_sample_t *sample, uint8_t *buffer);
+void scd30_compact_unpack(const uint8_t *buffer,
+                          scd30_compact_sample_t *sample);
+
+#endif
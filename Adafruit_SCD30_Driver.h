@@ -0,0 +1,413 @@
+/*!
+ *  @file Adafruit_SCD30_Driver.h
+ *
+ * 	Statically dispatched driver core for the Adafruit SCD30 CO2, Temperature,
+ * 	and Humidity sensor library. Needs nothing from the Arduino core, so it
+ * 	can also be built for a host with a simulated bus.
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	 license (see license.txt)
+ */
+
+#ifndef _ADAFRUIT_SCD30_DRIVER_H
+#define _ADAFRUIT_SCD30_DRIVER_H
+
+#include "Adafruit_SCD30_Commands.h"
+#include "Adafruit_SCD30_Stats.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * @brief
+ *
+ * Copy of the sensor's configuration registers, as kept by the driver.
+ */
+typedef struct {
+  uint16_t measurement_interval;         ///< Seconds between measurements
+  uint16_t ambient_pressure;             ///< Pressure compensation in mBar
+  uint16_t altitude_offset;              ///< Altitude offset in meters
+  uint16_t temperature_offset;           ///< Temp offset in 0.01 degrees C
+  uint16_t forced_calibration_reference; ///< Forced recalibration ref in ppm
+  uint16_t self_calibration;             ///< 1: self calibration enabled
+} scd30_config_t;
+
+/**
+ * @brief Unpack a float sent by the sensor as two big-endian words
+ *
+ * @param words The two words, with good CRCs
+ * @return float The value they hold
+ */
+static inline float scd30_unpack_float(const uint16_t *words) {
+  uint32_t bits = (uint32_t)words[0] << 16 | words[1];
+  float value;
+  memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+#define SCD30_RETRY_BUS                                                        \
+  (1 << SCD30_ERROR_BUS) ///< Retry transfers not acknowledged or answered
+#define SCD30_RETRY_CRC (1 << SCD30_ERROR_CRC) ///< Retry corrupted responses
+
+/**
+ * @brief
+ *
+ * How transactions that fail are retried, set with `setRetryPolicy`.
+ */
+typedef struct {
+  uint8_t attempts;        ///< Tries per transaction, 1 never retries
+  uint16_t backoff_ms;     ///< Wait before the first retry
+  uint16_t max_backoff_ms; ///< Longest wait, the wait doubles each retry
+  uint8_t retry_on;        ///< Errors to retry, `SCD30_RETRY_*` flags
+} scd30_retry_policy_t;
+
+/*!
+ *    @brief  Minimal SCD30 driver with the bus and time source chosen at
+ *            compile time, so every call on the read path can be inlined.
+ *
+ *            `Transport` needs the `begin`, `write`, `request`, `poll` and
+ *            `lastError` members of `Adafruit_SCD30_Transport`, but does not
+ *            have to derive from it; a concrete transport held by value is
+ *            called without virtual dispatch either way. `Clock` needs static
+ *            `uint32_t millis(void)`, `uint32_t micros(void)` and
+ *            `void delay(uint32_t ms)` members.
+ *
+ *            Besides the basic API it holds the transaction layer, retries,
+ *            bus counters and the asynchronous transfer in flight, which
+ *            `Adafruit_SCD30` uses through `Adafruit_SCD30_TransportRef`.
+ *            `Adafruit_SCD30` remains the full featured driver, with Unified
+ *            Sensor support, the RDY pin, history and cached settings.
+ */
+template <class Transport, class Clock> class Adafruit_SCD30_Driver {
+public:
+  /** @brief Create a driver with a default constructed transport */
+  Adafruit_SCD30_Driver() {}
+  /** @brief Create a driver with a copy of a configured transport
+      @param transport The transport to copy */
+  explicit Adafruit_SCD30_Driver(const Transport &transport)
+      : _transport(transport) {}
+
+  /** @brief Access the transport, for example to set its device
+      @return The driver's transport */
+  Transport &transport(void) { return _transport; }
+
+  /** @brief Set up the bus, reset the sensor and start measuring every 2
+      seconds. The first transfer after the reset can fail, which the
+      default retry policy gets past.
+      @return true: success false: failure */
+  bool begin(void) {
+    if (!_transport.begin()) {
+      return false;
+    }
+    reset();
+    if (!startContinuousMeasurement()) {
+      return false;
+    }
+    return setMeasurementInterval(2);
+  }
+
+  /** @brief Performs a software reset initializing registers to their power
+      on state */
+  void reset(void) {
+    cancelTransfer();
+    sendCommand(SCD30_CMD_SOFT_RESET);
+    Clock::delay(30);
+  }
+
+  /** @brief Ask the sensor if new data is ready to read
+      @return true: data is available false: no new data available */
+  bool dataReady(void) {
+    uint16_t ready;
+    return (readRegister(SCD30_CMD_GET_DATA_READY, &ready) && (ready == 1));
+  }
+
+  /** @brief Tell the SCD30 to start taking measurements continuously
+      @param pressure an optional pressure offset to correct for in millibar
+      (mBar)
+      @return true: success false: failure */
+  bool startContinuousMeasurement(uint16_t pressure = 0) {
+    return sendCommand(SCD30_CMD_CONTINUOUS_MEASUREMENT, pressure);
+  }
+
+  /** @brief Set the amount of time between measurements
+      @param interval The time between measurements in seconds, 2-1800
+      @return true: success false: failure */
+  bool setMeasurementInterval(uint16_t interval) {
+    if ((interval < 2) || (interval > 1800)) {
+      return false;
+    }
+    return sendCommand(SCD30_CMD_SET_MEASUREMENT_INTERVAL, interval);
+  }
+
+  /** @brief Read the current amount of time between measurements
+      @return The interval in seconds, 0 if it could not be read */
+  uint16_t getMeasurementInterval(void) {
+    uint16_t interval;
+    if (!readRegister(SCD30_CMD_SET_MEASUREMENT_INTERVAL, &interval)) {
+      return 0;
+    }
+    return interval;
+  }
+
+  /** @brief Updates `CO2`, `temperature` and `relative_humidity`, blocking
+      for the datasheet write/read gap
+      @return true: success false: failure */
+  bool read(void) {
+    uint16_t words[6];
+    if (!readWords(SCD30_CMD_READ_MEASUREMENT, words, 6)) {
+      return false;
+    }
+    unpack(words);
+    return true;
+  }
+
+  /** @brief Request a measurement without waiting for the data
+      @return true: command sent false: failure */
+  bool beginRead(void) { return beginTransfer(SCD30_CMD_READ_MEASUREMENT, 6); }
+
+  /** @brief Complete a measurement read started with `beginRead`
+      @return The state of the read, `SCD30_READ_READY` once the readings
+      are updated */
+  scd30_read_status_t pollRead(void) {
+    uint16_t words[6];
+    scd30_read_status_t status =
+        pollTransfer(SCD30_CMD_READ_MEASUREMENT, words, 6);
+    if (status == SCD30_READ_READY) {
+      unpack(words);
+    }
+    return status;
+  }
+
+  /** @brief Change how failed transactions are retried. Applies to commands,
+      register reads and `read`, not to `beginTransfer`/`pollTransfer`.
+      @param policy The policy to use, 0 attempts is taken as 1 */
+  void setRetryPolicy(const scd30_retry_policy_t *policy) {
+    _retry = *policy;
+    if (_retry.attempts == 0) {
+      _retry.attempts = 1;
+    }
+  }
+
+  /** @brief Get the policy used to retry failed transactions
+      @param policy Where to store the policy */
+  void getRetryPolicy(scd30_retry_policy_t *policy) { *policy = _retry; }
+
+  /** @brief Count retries and latency per command. The transport counts
+      its own transfers, give it the same counters with its `setStats`.
+      @param stats The counters to update, or NULL to stop counting */
+  void setStats(scd30_stats_t *stats) {
+#ifndef SCD30_NO_STATS
+    _stats = stats;
+#else
+    (void)stats;
+#endif
+  }
+
+  /** @brief Get the counters given to `setStats`
+      @return The counters, NULL if there are none */
+  scd30_stats_t *stats(void) { return _stats; }
+
+  /** @brief Send a command that takes no argument, retrying failures
+      @param command The command to send
+      @return true: success false: failure */
+  bool sendCommand(uint16_t command) {
+    for (uint8_t attempt = 1;; attempt++) {
+      uint32_t started = Clock::micros();
+      bool ok = _transport.write(command);
+      recordLatency(command, started, ok);
+      if (ok || !retryAfter(attempt)) {
+        return ok;
+      }
+    }
+  }
+
+  /** @brief Send a command with an argument, retrying failures
+      @param command The command to send
+      @param argument The argument to send with it
+      @return true: success false: failure */
+  bool sendCommand(uint16_t command, uint16_t argument) {
+    for (uint8_t attempt = 1;; attempt++) {
+      uint32_t started = Clock::micros();
+      bool ok = _transport.write(command, argument);
+      recordLatency(command, started, ok);
+      if (ok || !retryAfter(attempt)) {
+        return ok;
+      }
+    }
+  }
+
+  /** @brief Read a 16 bit register, blocking for the write/read gap
+      @param command The command to read the register with
+      @param value Where to store the register value
+      @return true: success false: failure */
+  bool readRegister(uint16_t command, uint16_t *value) {
+    return readWords(command, value, 1);
+  }
+
+  /** @brief Read a response, blocking for the write/read gap and retrying
+      failures
+      @param command The command to read with
+      @param words Where to store the response, checked for errors
+      @param count The number of words in the response
+      @return true: success false: failure */
+  bool readWords(uint16_t command, uint16_t *words, uint8_t count) {
+    for (uint8_t attempt = 1;; attempt++) {
+      if (beginTransfer(command, count)) {
+        Clock::delay(SCD30_READ_DELAY_US / 1000);
+
+        scd30_read_status_t status;
+        do {
+          status = pollTransfer(command, words, count);
+        } while (status == SCD30_READ_PENDING);
+
+        if (status == SCD30_READ_READY) {
+          return true;
+        }
+      }
+      if (!retryAfter(attempt)) {
+        return false;
+      }
+    }
+  }
+
+  /** @brief Read several single word registers, in a single request on
+      transports that can, retrying failures. The request's time is shared
+      evenly between the registers' latencies.
+      @param commands The commands to read the registers with
+      @param values Where to store the register values
+      @param count The number of registers to read
+      @return true: every register was read false: failure */
+  bool readRegisters(const uint16_t *commands, uint16_t *values,
+                     uint8_t count) {
+    _pending = false;
+    for (uint8_t attempt = 1;; attempt++) {
+      uint32_t started = Clock::micros();
+      bool ok = _transport.readRegisters(commands, values, count);
+      if (ok && count) {
+        uint32_t share = (Clock::micros() - started) / count;
+        for (uint8_t i = 0; i < count; i++) {
+          recordLatency(commands[i], Clock::micros() - share, true);
+        }
+      }
+      if (ok || !retryAfter(attempt)) {
+        return ok;
+      }
+    }
+  }
+
+  /** @brief Send a read command, noting which so the response can be
+      collected by `pollTransfer`
+      @param command The command to send
+      @param words The number of words in the response
+      @return true: command sent false: failure */
+  bool beginTransfer(uint16_t command, uint8_t words) {
+    _pending = false;
+
+    uint32_t started = Clock::micros();
+    if (!_transport.request(command, words)) {
+      return false;
+    }
+
+    _command = command;
+    _started = started;
+    _pending = true;
+    return true;
+  }
+
+  /** @brief Collect the response to a command sent with `beginTransfer`, if
+      it is available
+      @param command The command the response is expected for
+      @param words Where to store the response, checked for errors
+      @param count The number of words in the response
+      @return The state of the transfer, `SCD30_READ_IDLE` if none was
+      started for `command` */
+  scd30_read_status_t pollTransfer(uint16_t command, uint16_t *words,
+                                   uint8_t count) {
+    if (!_pending || (_command != command)) {
+      return SCD30_READ_IDLE;
+    }
+
+    scd30_read_status_t status = _transport.poll(words, count);
+    if (status != SCD30_READ_PENDING) {
+      _pending = false;
+    }
+    recordLatency(command, _started, status == SCD30_READ_READY);
+    return status;
+  }
+
+  /** @brief Forget the transfer in flight, if any */
+  void cancelTransfer(void) { _pending = false; }
+
+  /** @brief Decide whether to try a failed transaction again, waiting out
+      the backoff if so
+      @param attempt The number of tries made so far
+      @return true: try again false: give up */
+  bool retryAfter(uint8_t attempt) {
+    if ((attempt >= _retry.attempts) ||
+        !(_retry.retry_on & (1 << _transport.lastError()))) {
+      return false;
+    }
+
+    uint32_t wait = _retry.backoff_ms;
+    for (uint8_t i = 1; (i < attempt) && (wait < _retry.max_backoff_ms); i++) {
+      wait *= 2;
+    }
+    if (wait > _retry.max_backoff_ms) {
+      wait = _retry.max_backoff_ms;
+    }
+    if (wait) {
+      Clock::delay(wait);
+    }
+
+    SCD30_STATS_ADD(_stats, retries, 1);
+    return true;
+  }
+
+  float CO2 = 0,             ///< The most recent CO2 reading in ppm
+      temperature = 0,       ///< The most recent temperature reading
+      relative_humidity = 0; ///< The most recent humidity reading
+  uint32_t timestamp = 0;    ///< `Clock::millis()` when it was read
+
+private:
+  /** @brief Store a measurement in `CO2`, `temperature` and
+      `relative_humidity`
+      @param words The six words read from the sensor, with good CRCs */
+  void unpack(const uint16_t *words) {
+    CO2 = scd30_unpack_float(words);
+    temperature = scd30_unpack_float(words + 2);
+    relative_humidity = scd30_unpack_float(words + 4);
+    timestamp = Clock::millis();
+  }
+
+  /** @brief Add a transaction's latency to the counters, if attached
+      @param command The command of the transaction
+      @param started `Clock::micros()` when the transaction started
+      @param ok True if the transaction succeeded, failures are not timed */
+  void recordLatency(uint16_t command, uint32_t started, bool ok) {
+#ifndef SCD30_NO_STATS
+    if (_stats && ok) {
+      scd30_stats_add_latency(_stats, command, Clock::micros() - started);
+    }
+#else
+    (void)command;
+    (void)started;
+    (void)ok;
+#endif
+  }
+
+  Transport _transport;         ///< The bus the sensor is on
+  scd30_stats_t *_stats = NULL; ///< Counters to update, if any
+  bool _pending = false;        ///< True while a transfer is in flight
+  uint16_t _command = 0;        ///< Command the pending transfer is for
+  uint32_t _started = 0;        ///< `Clock::micros()` when it was sent
+
+  /** Retries for failed transactions, two tries get past the first transfer
+      after a reset failing */
+  scd30_retry_policy_t _retry = {2, 1, 50, SCD30_RETRY_BUS | SCD30_RETRY_CRC};
+};
+
+#endif
@@ -0,0 +1,196 @@
+/*!
+ *  @file Adafruit_SCD30_DutyCycle.cpp
+ *
+ * 	Duty cycled, low power acquisition for the Adafruit SCD30 CO2,
+ * 	Temperature, and Humidity sensor library
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ * 	BSD (see license.txt)
+ */
+
+#include "Adafruit_SCD30_DutyCycle.h"
+
+/**
+ * @brief Construct a new Adafruit_SCD30_DutyCycle object
+ *
+ * @param sensor The sensor's driver, already started with `begin`
+ */
+Adafruit_SCD30_DutyCycle::Adafruit_SCD30_DutyCycle(Adafruit_SCD30 *sensor)
+    : _sensor(sensor), _state(DUTY_IDLE), _active_ua(SCD30_DUTY_ACTIVE_UA),
+      _idle_ua(SCD30_DUTY_IDLE_UA) {
+  memset(&_budget, 0, sizeof(_budget));
+}
+
+/**
+ * @brief Stop measuring and schedule the first sample one period from now.
+ * The stored ambient pressure offset is used for every restart.
+ *
+ * @param period_ms The time between samples. The sensor is stopped after every
+ * sample, so a period shorter than the warm-up plus a measurement interval
+ * can't be kept: each sample then comes a warm-up and a frame after the last.
+ * @param warmup_ms The time from starting measurement to the first reading
+ * that is used. Sensirion recommends discarding readings for a while after
+ * a restart, longer for the most accurate CO2 values.
+ * @return true: success false: the sensor didn't respond
+ */
+bool Adafruit_SCD30_DutyCycle::begin(uint32_t period_ms, uint32_t warmup_ms) {
+  _period_ms = period_ms;
+  _warmup_ms = warmup_ms;
+  memset(&_budget, 0, sizeof(_budget));
+
+  _pressure = _sensor->getAmbientPressureOffset();
+  if (!_sensor->stopContinuousMeasurement()) {
+    return false;
+  }
+
+  _state = DUTY_IDLE;
+  _state_since = millis();
+  _next_sample = _state_since + _period_ms;
+  _next_check = _state_since;
+  return true;
+}
+
+/**
+ * @brief Advance the duty cycle without blocking. Call as often as possible
+ * from `loop`; between samples it only reads the clock.
+ *
+ * @return true: a new sample is in the sensor's `CO2`, `temperature` and
+ * `relative_humidity` false: no new sample
+ */
+bool Adafruit_SCD30_DutyCycle::poll(void) {
+  uint32_t now = millis();
+  if ((int32_t)(now - _next_check) < 0) {
+    return false;
+  }
+  _next_check = now + SCD30_DUTY_RECHECK_MS;
+
+  uint32_t started_us = micros();
+  bool sample = step(now);
+  _budget.bus_us += micros() - started_us;
+  return sample;
+}
+
+/**
+ * @brief Take the next step of the duty cycle
+ *
+ * @param now `millis()` at the start of the poll
+ * @return true: a new sample was read false: no new sample
+ */
+bool Adafruit_SCD30_DutyCycle::step(uint32_t now) {
+  switch (_state) {
+  case DUTY_IDLE:
+    if ((int32_t)(now - (_next_sample - _warmup_ms)) < 0) {
+      // nothing to do until it's time to start; sleep until then
+      _next_check = _next_sample - _warmup_ms;
+      return false;
+    }
+    if (_sensor->startContinuousMeasurement(_pressure)) {
+      enter(DUTY_WARMING);
+      _next_check = now + _warmup_ms;
+    }
+    return false;
+
+  case DUTY_WARMING:
+    if ((uint32_t)(now - _state_since) < _warmup_ms) {
+      return false;
+    }
+    // a frame measured during the warm-up may be waiting; drop it without
+    // it reaching the readings, history or observers
+    if (_sensor->dataReady()) {
+      uint8_t payload[SCD30_RAW_PAYLOAD_SIZE];
+      _sensor->readRaw(payload);
+    }
+    enter(DUTY_WAITING);
+    return false;
+
+  case DUTY_WAITING:
+    if (_sensor->dataReady() && _sensor->read()) {
+      _budget.samples++;
+      enter(DUTY_STOPPING);
+      _next_check = now;
+      return true;
+    }
+    if ((uint32_t)(now - _state_since) >= _period_ms) {
+      // the sensor never produced a frame; give up on this sample
+      enter(DUTY_STOPPING);
+      _next_check = now;
+    }
+    return false;
+
+  case DUTY_STOPPING:
+    if (!_sensor->stopContinuousMeasurement()) {
+      return false;
+    }
+    enter(DUTY_IDLE);
+    _next_sample += _period_ms;
+    if ((int32_t)(now - (_next_sample - _warmup_ms)) > 0) {
+      // overran the period: start again now rather than catching up
+      _next_sample = now + _warmup_ms;
+    }
+    _next_check = now;
+    return false;
+  }
+  return false;
+}
+
+/**
+ * @brief Set the sensor currents used to estimate `average_ua`. The
+ * defaults are rough: the active current is the datasheet average at a 2 s
+ * interval, and the stopped current depends on the board's regulator and
+ * pull-ups, so measure them for an accurate budget.
+ *
+ * @param active_ua The current while measuring, in µA
+ * @param idle_ua The current with measurement stopped, in µA
+ */
+void Adafruit_SCD30_DutyCycle::setCurrents(uint32_t active_ua,
+                                           uint32_t idle_ua) {
+  _active_ua = active_ua;
+  _idle_ua = idle_ua;
+}
+
+/**
+ * @brief Get the time spent measuring and stopped since `begin`, and the
+ * average current that implies
+ *
+ * @param budget Where to store the budget
+ */
+void Adafruit_SCD30_DutyCycle::getBudget(scd30_duty_budget_t *budget) {
+  *budget = _budget;
+
+  // include the time spent in the current state so far
+  uint32_t elapsed = millis() - _state_since;
+  if (_state == DUTY_IDLE) {
+    budget->idle_ms += elapsed;
+  } else {
+    budget->active_ms += elapsed;
+  }
+
+  uint32_t total = budget->active_ms + budget->idle_ms;
+  if (total == 0) {
+    budget->average_ua = 0;
+    return;
+  }
+  budget->average_ua = ((uint64_t)budget->active_ms * _active_ua +
+                        (uint64_t)budget->idle_ms * _idle_ua) /
+                       total;
+}
+
+/**
+ * @brief Move to a new state, charging the time in the old one to the budget
+ *
+ * @param state The new state
+ */
+void Adafruit_SCD30_DutyCycle::enter(duty_state_t state) {
+  uint32_t now = millis();
+  uint32_t elapsed = now - _state_since;
+  if (_state == DUTY_IDLE) {
+    _budget.idle_ms += elapsed;
+  } else {
+    _budget.active_ms += elapsed;
+  }
+  _state = state;
+  _state_since = now;
+}
@@ -0,0 +1,83 @@
+/*!
+ *  @file Adafruit_SCD30_DutyCycle.h
+ *
+ * 	Duty cycled, low power acquisition for the Adafruit SCD30 CO2,
+ * 	Temperature, and Humidity sensor library
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	 license (see license.txt)
+ */
+
+#ifndef _ADAFRUIT_SCD30_DUTYCYCLE_H
+#define _ADAFRUIT_SCD30_DUTYCYCLE_H
+
+#include "Adafruit_SCD30.h"
+
+#define SCD30_DUTY_WARMUP_MS                                                   \
+  10000 ///< Default time from starting measurement to a usable reading
+#define SCD30_DUTY_RECHECK_MS 100 ///< Time between data ready checks
+#define SCD30_DUTY_ACTIVE_UA                                                   \
+  19000 ///< Default current while measuring, datasheet average at 2 s
+#define SCD30_DUTY_IDLE_UA                                                     \
+  5000 ///< Default current with measurement stopped, measure your board
+
+/**
+ * @brief
+ *
+ * Where the time went since `Adafruit_SCD30_DutyCycle::begin`, and what it
+ * cost.
+ */
+typedef struct {
+  uint32_t samples;    ///< Samples collected
+  uint32_t active_ms;  ///< Time spent measuring
+  uint32_t idle_ms;    ///< Time spent with measurement stopped
+  uint32_t bus_us;     ///< Time spent in bus transactions
+  uint32_t average_ua; ///< Estimated average current of the sensor
+} scd30_duty_budget_t;
+
+/*!
+ *    @brief  Takes a sample every period, keeping the sensor stopped in
+ *            between. Measurement is restarted with the stored pressure
+ *            compensation a warm-up time before each sample is due, and the
+ *            first frame measured after the warm-up is collected.
+ */
+class Adafruit_SCD30_DutyCycle {
+public:
+  Adafruit_SCD30_DutyCycle(Adafruit_SCD30 *sensor);
+
+  bool begin(uint32_t period_ms, uint32_t warmup_ms = SCD30_DUTY_WARMUP_MS);
+  bool poll(void);
+
+  void setCurrents(uint32_t active_ua, uint32_t idle_ua);
+  void getBudget(scd30_duty_budget_t *budget);
+
+private:
+  /** Where the sensor is in the duty cycle */
+  typedef enum {
+    DUTY_IDLE,     ///< Stopped, waiting to start before the next sample
+    DUTY_WARMING,  ///< Measuring, readings not yet usable
+    DUTY_WAITING,  ///< Warmed up, waiting for the next frame
+    DUTY_STOPPING, ///< Sample collected, stopping measurement
+  } duty_state_t;
+
+  void enter(duty_state_t state);
+  bool step(uint32_t now);
+
+  Adafruit_SCD30 *_sensor;     ///< The sensor's driver
+  duty_state_t _state;         ///< Where the sensor is in the cycle
+  uint32_t _period_ms = 0;     ///< Time between samples
+  uint32_t _warmup_ms = 0;     ///< Time from start to a usable reading
+  uint32_t _next_sample = 0;   ///< `millis()` when the next sample is due
+  uint32_t _state_since = 0;   ///< `millis()` when the state was entered
+  uint32_t _next_check = 0;    ///< `millis()` of the next bus access
+  uint16_t _pressure = 0;      ///< Pressure compensation to restart with
+  uint32_t _active_ua;         ///< Current while measuring
+  uint32_t _idle_ua;           ///< Current while stopped
+  scd30_duty_budget_t _budget; ///< Time and bus use so far
+};
+
+#endif
@@ -0,0 +1,327 @@
+/*!
+ *  @file Adafruit_SCD30_Filter.cpp
+ *
+ * 	Fixed point filter pipeline for the Adafruit SCD30 CO2, Temperature, and
+ * 	Humidity sensor library
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ * 	BSD (see license.txt)
+ */
+
+#include "Adafruit_SCD30_Filter.h"
+#include <string.h>
+
+#define FILTER_ONE                                                             \
+  (1L << SCD30_FILTER_FRACTION_BITS) ///< 1.0 in the filters' state units
+
+/**
+ * @brief Divide by a power of two, rounding to nearest, without relying on
+ * how negative values are shifted
+ *
+ * @param value The value to divide
+ * @param bits The power of two to divide by
+ * @return The rounded quotient
+ */
+static int32_t round_shift(int64_t value, uint8_t bits) {
+  int64_t half = (int64_t)1 << (bits - 1);
+  if (value < 0) {
+    return -(int32_t)((-value + half) >> bits);
+  }
+  return (value + half) >> bits;
+}
+
+/**
+ * @brief Clamp a value to a range
+ *
+ * @param value The value to clamp
+ * @param min The smallest allowed result
+ * @param max The largest allowed result
+ * @return The clamped value
+ */
+static int32_t clamp(int32_t value, int32_t min, int32_t max) {
+  if (value < min) {
+    return min;
+  }
+  if (value > max) {
+    return max;
+  }
+  return value;
+}
+
+/**
+ * @brief Construct a new exponential moving average
+ *
+ * @param shift Smoothing factor as a power of two: 0 passes values through,
+ * 3 averages over about 8 samples, up to 15
+ */
+Adafruit_SCD30_EMA::Adafruit_SCD30_EMA(uint8_t shift)
+    : _shift(shift > 15 ? 15 : shift) {}
+
+/**
+ * @brief Add a value to the average
+ *
+ * @param value The value
+ * @return int32_t The average
+ */
+int32_t Adafruit_SCD30_EMA::update(int32_t value) {
+  int32_t scaled = value * FILTER_ONE;
+  if (!_valid) {
+    // start at the first value instead of ramping up from zero
+    _state = scaled;
+    _valid = true;
+  } else {
+    int32_t step = scaled - _state;
+    _state += (step < 0) ? -(-step >> _shift) : (step >> _shift);
+  }
+  return round_shift(_state, SCD30_FILTER_FRACTION_BITS);
+}
+
+/**
+ * @brief Forget the average
+ */
+void Adafruit_SCD30_EMA::reset(void) { _valid = false; }
+
+/**
+ * @brief Construct a new median filter over caller supplied storage
+ *
+ * @param window Storage for `size` values
+ * @param sorted Storage for another `size` values
+ * @param size The number of values the median is taken over
+ */
+Adafruit_SCD30_MedianBase::Adafruit_SCD30_MedianBase(int32_t *window,
+                                                     int32_t *sorted,
+                                                     uint8_t size)
+    : _window(window), _sorted(sorted), _size(size) {}
+
+/**
+ * @brief Add a value to the window, replacing the oldest once it is full
+ *
+ * Keeps the window sorted by insertion, which beats a heap for the small
+ * windows that make sense for this sensor.
+ *
+ * @param value The value
+ * @return int32_t The median of the window, the mean of the middle two
+ * while it holds an even number of values
+ */
+int32_t Adafruit_SCD30_MedianBase::update(int32_t value) {
+  uint8_t count = _count;
+  uint8_t position;
+
+  if (count == _size) {
+    // take the oldest value out of the sorted copy
+    int32_t oldest = _window[_head];
+    position = 0;
+    while (_sorted[position] != oldest) {
+      position++;
+    }
+    count--;
+    memmove(&_sorted[position], &_sorted[position + 1],
+            (count - position) * sizeof(int32_t));
+
+    _window[_head] = value;
+    _head = (_head + 1) % _size;
+  } else {
+    _window[(_head + count) % _size] = value;
+    _count++;
+  }
+
+  position = count;
+  while ((position > 0) && (_sorted[position - 1] > value)) {
+    _sorted[position] = _sorted[position - 1];
+    position--;
+  }
+  _sorted[position] = value;
+
+  uint8_t middle = _count / 2;
+  if (_count & 1) {
+    return _sorted[middle];
+  }
+  return round_shift((int64_t)_sorted[middle - 1] + _sorted[middle], 1);
+}
+
+/**
+ * @brief Empty the window
+ */
+void Adafruit_SCD30_MedianBase::reset(void) {
+  _head = 0;
+  _count = 0;
+}
+
+/**
+ * @brief Construct a new scalar Kalman filter
+ *
+ * @param process_variance How much the true value changes between samples
+ * @param measurement_variance How noisy the readings are
+ */
+Adafruit_SCD30_Kalman::Adafruit_SCD30_Kalman(uint32_t process_variance,
+                                             uint32_t measurement_variance)
+    : _process_variance(process_variance),
+      _measurement_variance(measurement_variance) {}
+
+/**
+ * @brief Correct the estimate with a reading
+ *
+ * @param value The reading
+ * @return int32_t The new estimate
+ */
+int32_t Adafruit_SCD30_Kalman::update(int32_t value) {
+  int32_t scaled = value * FILTER_ONE;
+  if (!_valid) {
+    _estimate = scaled;
+    _error = _measurement_variance;
+    _valid = true;
+    return value;
+  }
+
+  // predict: the value may have wandered since the last sample
+  uint64_t error = (uint64_t)_error + _process_variance;
+  uint64_t total = error + _measurement_variance;
+  if (total == 0) {
+    return round_shift(_estimate, SCD30_FILTER_FRACTION_BITS);
+  }
+
+  // correct: gain in Q16, how far to move toward the reading
+  uint32_t gain = (error << 16) / total;
+  _estimate += round_shift((int64_t)gain * (scaled - _estimate), 16);
+  error = (error * (65536 - gain)) >> 16;
+  _error = (error > 0xFFFFFFFF) ? 0xFFFFFFFF : error;
+
+  return round_shift(_estimate, SCD30_FILTER_FRACTION_BITS);
+}
+
+/**
+ * @brief Forget the estimate
+ */
+void Adafruit_SCD30_Kalman::reset(void) { _valid = false; }
+
+/**
+ * @brief Construct a new Adafruit_SCD30_Filter object that passes every
+ * channel through
+ */
+Adafruit_SCD30_Filter::Adafruit_SCD30_Filter(void) {
+  memset(_stages, 0, sizeof(_stages));
+  memset(&_raw, 0, sizeof(_raw));
+  memset(&_filtered, 0, sizeof(_filtered));
+}
+
+/**
+ * @brief Append a stage to a channel's chain. Stages run in the order added,
+ * for example a median to reject spikes and then an average.
+ *
+ * @param channel The channel to filter
+ * @param stage The stage, which must not be in another filter's chain
+ * @return true: success false: `channel` is out of range or `stage` is
+ * already in one of this filter's chains
+ */
+bool Adafruit_SCD30_Filter::addStage(scd30_channel_t channel,
+                                     Adafruit_SCD30_FilterStage *stage) {
+  if ((channel >= SCD30_CHANNEL_COUNT) || !stage) {
+    return false;
+  }
+
+  // adding a stage twice would link the chain back on itself, and taking
+  // it from another channel would cut that chain short
+  for (uint8_t i = 0; i < SCD30_CHANNEL_COUNT; i++) {
+    for (Adafruit_SCD30_FilterStage *added = _stages[i]; added;
+         added = added->_next) {
+      if (added == stage) {
+        return false;
+      }
+    }
+  }
+
+  Adafruit_SCD30_FilterStage **link = &_stages[channel];
+  while (*link) {
+    link = &(*link)->_next;
+  }
+  stage->_next = NULL;
+  *link = stage;
+  return true;
+}
+
+/**
+ * @brief Reset every stage, for example after the sensor was stopped
+ */
+void Adafruit_SCD30_Filter::reset(void) {
+  for (uint8_t i = 0; i < SCD30_CHANNEL_COUNT; i++) {
+    for (Adafruit_SCD30_FilterStage *stage = _stages[i]; stage;
+         stage = stage->_next) {
+      stage->reset();
+    }
+  }
+  _valid = false;
+}
+
+/**
+ * @brief Filter a new sample. Called by the driver for every frame read.
+ *
+ * @param raw The sample as read
+ */
+void Adafruit_SCD30_Filter::update(const scd30_compact_sample_t *raw) {
+  _raw = *raw;
+
+  int32_t co2 = run(SCD30_CHANNEL_CO2, raw->co2);
+  int32_t temperature = run(SCD30_CHANNEL_TEMPERATURE, raw->temperature);
+  int32_t humidity = run(SCD30_CHANNEL_HUMIDITY, raw->humidity);
+
+  _filtered.co2 = clamp(co2, 0, SCD30_COMPACT_CO2_MAX);
+  _filtered.temperature = clamp(temperature, INT16_MIN, INT16_MAX);
+  _filtered.humidity = clamp(humidity, 0, SCD30_COMPACT_HUMIDITY_MAX);
+  _valid = true;
+}
+
+/**
+ * @brief Get the latest sample as read
+ *
+ * @param raw Where to store the sample
+ * @return true: success false: no sample has been filtered yet
+ */
+bool Adafruit_SCD30_Filter::getRaw(scd30_compact_sample_t *raw) {
+  *raw = _raw;
+  return _valid;
+}
+
+/**
+ * @brief Get the latest filtered sample
+ *
+ * @param filtered Where to store the sample
+ * @return true: success false: no sample has been filtered yet
+ */
+bool Adafruit_SCD30_Filter::getFiltered(scd30_compact_sample_t *filtered) {
+  *filtered = _filtered;
+  return _valid;
+}
+
+/**
+ * @brief Get the latest filtered sample in the units of the driver's `CO2`,
+ * `temperature` and `relative_humidity`
+ *
+ * @param co2 Where to store the CO2 concentration in ppm
+ * @param temperature Where to store the temperature in degrees C
+ * @param relative_humidity Where to store the relative humidity in %
+ * @return true: success false: no sample has been filtered yet
+ */
+bool Adafruit_SCD30_Filter::getFiltered(float *co2, float *temperature,
+                                        float *relative_humidity) {
+  scd30_compact_to_floats(&_filtered, co2, temperature, relative_humidity);
+  return _valid;
+}
+
+/**
+ * @brief Run a value through a channel's chain
+ *
+ * @param channel The channel
+ * @param value The value as read
+ * @return int32_t The value after every stage
+ */
+int32_t Adafruit_SCD30_Filter::run(uint8_t channel, int32_t value) {
+  for (Adafruit_SCD30_FilterStage *stage = _stages[channel]; stage;
+       stage = stage->_next) {
+    value = clamp(value, -SCD30_FILTER_INPUT_MAX, SCD30_FILTER_INPUT_MAX);
+    value = stage->update(value);
+  }
+  return value;
+}
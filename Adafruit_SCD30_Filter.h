@@ -0,0 +1,154 @@
+/*!
+ *  @file Adafruit_SCD30_Filter.h
+ *
+ * 	Fixed point filter pipeline for the Adafruit SCD30 CO2, Temperature, and
+ * 	Humidity sensor library
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	 license (see license.txt)
+ */
+
+#ifndef _ADAFRUIT_SCD30_FILTER_H
+#define _ADAFRUIT_SCD30_FILTER_H
+
+#include "Adafruit_SCD30_Compact.h"
+#include "Adafruit_SCD30_History.h"
+#include <stddef.h>
+
+#define SCD30_FILTER_INPUT_MAX                                                 \
+  0x3FFFFF ///< Largest magnitude filtered, in the channel's fixed point units
+#define SCD30_FILTER_FRACTION_BITS 8 ///< Extra precision kept by the filters
+
+/*!
+ *    @brief  One stage of a channel's filter. Values are in the channel's
+ *            fixed point units: 0.1 ppm, 0.01 degrees C or 0.01 %. A stage
+ *            keeps state, so it can only be in one channel's chain.
+ */
+class Adafruit_SCD30_FilterStage {
+public:
+  virtual ~Adafruit_SCD30_FilterStage() {}
+
+  /** @brief Filter the next value
+      @param value The value, clamped to `SCD30_FILTER_INPUT_MAX`
+      @return The filtered value */
+  virtual int32_t update(int32_t value) = 0;
+  /** @brief Forget every value seen, the next value starts afresh */
+  virtual void reset(void) = 0;
+
+private:
+  friend class Adafruit_SCD30_Filter; ///< Links the stages into chains
+
+  Adafruit_SCD30_FilterStage *_next = NULL; ///< Next stage of the chain
+};
+
+/*!
+ *    @brief  Exponential moving average with a smoothing factor of
+ *            1 / 2^`shift`, which needs no multiplication
+ */
+class Adafruit_SCD30_EMA : public Adafruit_SCD30_FilterStage {
+public:
+  Adafruit_SCD30_EMA(uint8_t shift);
+
+  int32_t update(int32_t value);
+  void reset(void);
+
+private:
+  uint8_t _shift;      ///< Smoothing factor is 1 / 2^`_shift`
+  bool _valid = false; ///< True once a value has been seen
+  int32_t _state = 0;  ///< Average, with `SCD30_FILTER_FRACTION_BITS`
+};
+
+/*!
+ *    @brief  Median of the last values, which rejects spikes. Storage is
+ *            supplied by the caller; use `Adafruit_SCD30_Median` to have it
+ *            allocated statically.
+ */
+class Adafruit_SCD30_MedianBase : public Adafruit_SCD30_FilterStage {
+public:
+  Adafruit_SCD30_MedianBase(int32_t *window, int32_t *sorted, uint8_t size);
+
+  int32_t update(int32_t value);
+  void reset(void);
+
+private:
+  int32_t *_window;   ///< Ring of the last `_size` values, oldest first
+  int32_t *_sorted;   ///< The same values in ascending order
+  uint8_t _size;      ///< Window size
+  uint8_t _head = 0;  ///< Position in `_window` of the oldest value
+  uint8_t _count = 0; ///< Number of values in the window
+};
+
+/*!
+ *    @brief  Median filter over the last `SIZE` values in statically
+ *            allocated storage
+ */
+template <uint8_t SIZE>
+class Adafruit_SCD30_Median : public Adafruit_SCD30_MedianBase {
+  static_assert(SIZE > 0, "median window size out of range");
+
+public:
+  /** @brief Create an empty median filter */
+  Adafruit_SCD30_Median()
+      : Adafruit_SCD30_MedianBase(_window_storage, _sorted_storage, SIZE) {}
+
+private:
+  int32_t _window_storage[SIZE]; ///< Ring storage
+  int32_t _sorted_storage[SIZE]; ///< Sorted copy storage
+};
+
+/*!
+ *    @brief  Scalar Kalman filter for a slowly wandering value, weighing
+ *            each reading against the estimate by their variances. It
+ *            follows the first readings closely, then settles to a steady
+ *            gain. Variances are in the channel's fixed point units squared,
+ *            for example 300UL * 300 for CO2 noise of 30 ppm.
+ */
+class Adafruit_SCD30_Kalman : public Adafruit_SCD30_FilterStage {
+public:
+  Adafruit_SCD30_Kalman(uint32_t process_variance,
+                        uint32_t measurement_variance);
+
+  int32_t update(int32_t value);
+  void reset(void);
+
+private:
+  uint32_t _process_variance;     ///< How far the value wanders per sample
+  uint32_t _measurement_variance; ///< Noise of the sensor
+  bool _valid = false;            ///< True once a value has been seen
+  int32_t _estimate = 0;          ///< Estimate, `SCD30_FILTER_FRACTION_BITS`
+  uint32_t _error = 0;            ///< Variance of the estimate
+};
+
+/*!
+ *    @brief  Filters each new sample through a chain of stages per channel,
+ *            keeping both the raw and the filtered sample. Attach it with
+ *            `Adafruit_SCD30::setFilter`. Channels with no stages pass
+ *            through unchanged. Uses integer math only.
+ */
+class Adafruit_SCD30_Filter {
+public:
+  Adafruit_SCD30_Filter(void);
+
+  bool addStage(scd30_channel_t channel, Adafruit_SCD30_FilterStage *stage);
+  void reset(void);
+  void update(const scd30_compact_sample_t *raw);
+
+  bool getRaw(scd30_compact_sample_t *raw);
+  bool getFiltered(scd30_compact_sample_t *filtered);
+  bool getFiltered(float *co2, float *temperature, float *relative_humidity);
+
+private:
+  int32_t run(uint8_t channel, int32_t value);
+
+  /** First stage of each channel's chain, NULL to pass it through */
+  Adafruit_SCD30_FilterStage *_stages[SCD30_CHANNEL_COUNT];
+  bool _valid = false;              ///< True once a sample has been filtered
+  scd30_compact_sample_t _raw;      ///< Latest sample as read
+  scd30_compact_sample_t _filtered; ///< Latest sample after the stages
+};
+
+#endif
@@ -0,0 +1,405 @@
+/*!
+ *  @file Adafruit_SCD30_Frame.cpp
+ *
+ * 	CRC checking and decoding of frames read from the Adafruit SCD30 CO2,
+ * 	Temperature, and Humidity sensor
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ * 	BSD (see license.txt)
+ */
+
+#include "Adafruit_SCD30_Frame.h"
+#include <string.h>
+
+#if defined(ARDUINO)
+#include "Arduino.h"
+#else
+#define PROGMEM
+#define pgm_read_byte(addr) (*(const uint8_t *)(addr))
+#endif
+
+#if defined(SCD30_FRAME_SSSE3)
+#include <tmmintrin.h>
+#elif defined(SCD30_FRAME_NEON)
+#include <arm_neon.h>
+#endif
+
+/*
+ * CRC-8 formula from page 14 of SHT spec pdf
+ *
+ * Test data 0xBE, 0xEF should yield 0x92
+ *
+ * Initialization data 0xFF
+ * Polynomial 0x31 (x8 + x5 +x4 +1)
+ * Final XOR 0x00
+ *
+ * The lookup table is generated at compile time from the polynomial. Define
+ * SCD30_CRC8_NIBBLE_TABLE to use a 16 entry table (two lookups per byte)
+ * instead of the 256 entry one on flash constrained parts.
+ */
+#define SCD30_CRC8_POLYNOMIAL 0x31 ///< CRC8 generator polynomial
+#define SCD30_CRC8_INIT 0xFF       ///< CRC8 initialization value
+
+/**
+ * @brief Run `bits` steps of the bitwise CRC8 on `crc`
+ *
+ * @param crc The current CRC value
+ * @param bits The number of bits to shift through the polynomial
+ * @return The updated CRC value
+ */
+static constexpr uint8_t crc8_shift(uint8_t crc, uint8_t bits) {
+  return bits == 0
+             ? crc
+             : crc8_shift((crc & 0x80) ? (uint8_t)((crc << 1) ^
+                                                   SCD30_CRC8_POLYNOMIAL)
+                                       : (uint8_t)(crc << 1),
+                          bits - 1);
+}
+
+#ifdef SCD30_CRC8_NIBBLE_TABLE
+#define CRC8_ENTRY(n) crc8_shift((n) << 4, 4)
+static const uint8_t crc8_table[16] PROGMEM = {
+    CRC8_ENTRY(0x0), CRC8_ENTRY(0x1), CRC8_ENTRY(0x2), CRC8_ENTRY(0x3),
+    CRC8_ENTRY(0x4), CRC8_ENTRY(0x5), CRC8_ENTRY(0x6), CRC8_ENTRY(0x7),
+    CRC8_ENTRY(0x8), CRC8_ENTRY(0x9), CRC8_ENTRY(0xA), CRC8_ENTRY(0xB),
+    CRC8_ENTRY(0xC), CRC8_ENTRY(0xD), CRC8_ENTRY(0xE), CRC8_ENTRY(0xF)};
+#undef CRC8_ENTRY
+#else
+#define CRC8_ENTRY(n) crc8_shift(n, 8)
+#define CRC8_ROW(n)                                                            \
+  CRC8_ENTRY(n + 0x0), CRC8_ENTRY(n + 0x1), CRC8_ENTRY(n + 0x2),              \
+      CRC8_ENTRY(n + 0x3), CRC8_ENTRY(n + 0x4), CRC8_ENTRY(n + 0x5),          \
+      CRC8_ENTRY(n + 0x6), CRC8_ENTRY(n + 0x7), CRC8_ENTRY(n + 0x8),          \
+      CRC8_ENTRY(n + 0x9), CRC8_ENTRY(n + 0xA), CRC8_ENTRY(n + 0xB),          \
+      CRC8_ENTRY(n + 0xC), CRC8_ENTRY(n + 0xD), CRC8_ENTRY(n + 0xE),          \
+      CRC8_ENTRY(n + 0xF)
+static const uint8_t crc8_table[256] PROGMEM = {
+    CRC8_ROW(0x00), CRC8_ROW(0x10), CRC8_ROW(0x20), CRC8_ROW(0x30),
+    CRC8_ROW(0x40), CRC8_ROW(0x50), CRC8_ROW(0x60), CRC8_ROW(0x70),
+    CRC8_ROW(0x80), CRC8_ROW(0x90), CRC8_ROW(0xA0), CRC8_ROW(0xB0),
+    CRC8_ROW(0xC0), CRC8_ROW(0xD0), CRC8_ROW(0xE0), CRC8_ROW(0xF0)};
+#undef CRC8_ROW
+#undef CRC8_ENTRY
+#endif
+
+static_assert(crc8_shift(crc8_shift(SCD30_CRC8_INIT ^ 0xBE, 8) ^ 0xEF, 8) ==
+                  0x92,
+              "CRC8 test data 0xBE, 0xEF should yield 0x92");
+
+/**
+ * @brief Add one byte to a running CRC8 using the lookup table
+ *
+ * @param crc The current CRC value
+ * @param data The byte to add
+ * @return The updated CRC value
+ */
+static inline uint8_t crc8_update(uint8_t crc, uint8_t data) {
+#ifdef SCD30_CRC8_NIBBLE_TABLE
+  crc ^= data;
+  crc = (uint8_t)(crc << 4) ^ pgm_read_byte(&crc8_table[crc >> 4]);
+  crc = (uint8_t)(crc << 4) ^ pgm_read_byte(&crc8_table[crc >> 4]);
+  return crc;
+#else
+  return pgm_read_byte(&crc8_table[crc ^ data]);
+#endif
+}
+
+/**
+ * Performs a CRC8 calculation on the supplied values.
+ *
+ * @param data  Pointer to the data to use when calculating the CRC8.
+ * @param len   The number of bytes in 'data'.
+ *
+ * @return The computed CRC8 value.
+ */
+uint8_t scd30_crc8(const uint8_t *data, uint8_t len) {
+  uint8_t crc = SCD30_CRC8_INIT;
+
+  while (len--) {
+    crc = crc8_update(crc, *data++);
+  }
+  return crc;
+}
+
+/**
+ * @brief Check the CRC of every word in a frame read from the sensor
+ *
+ * @param frame The frame, made of 16 bit big-endian words each followed by
+ * their CRC8 (MSB, LSB, CRC)
+ * @param len The length of the frame in bytes, a multiple of three
+ * @return true: all CRCs match false: at least one word is corrupted
+ */
+bool scd30_validate_frame(const uint8_t *frame, uint8_t len) {
+  uint8_t mismatch = 0;
+
+  for (uint8_t i = 0; i + 2 < len; i += 3) {
+    uint8_t crc = crc8_update(SCD30_CRC8_INIT, frame[i]);
+    crc = crc8_update(crc, frame[i + 1]);
+    mismatch |= crc ^ frame[i + 2];
+  }
+  return (mismatch == 0);
+}
+
+/**
+ * @brief Check a frame read from the sensor and unpack its words
+ *
+ * @param frame The frame, each big-endian word followed by its CRC8
+ * @param words Where to store the words
+ * @param count The number of words in the frame
+ * @return true: all CRCs match false: at least one word is corrupted, `words`
+ * is left untouched
+ */
+bool scd30_unpack_frame(const uint8_t *frame, uint16_t *words, uint8_t count) {
+  if (!scd30_validate_frame(frame, count * 3)) {
+    return false;
+  }
+  for (uint8_t i = 0; i < count; i++) {
+    words[i] = (uint16_t)(frame[3 * i] << 8 | frame[3 * i + 1]);
+  }
+  return true;
+}
+
+/**
+ * @brief Store a decoded measurement in the output columns
+ *
+ * @param words The six words of the measurement, native byte order
+ * @param index The frame's position in the output columns
+ * @param co2 CO2 column
+ * @param temperature Temperature column
+ * @param relative_humidity Humidity column
+ */
+static inline void store_measurement(const uint16_t *words, size_t index,
+                                     float *co2, float *temperature,
+                                     float *relative_humidity) {
+  uint32_t bits[3];
+  for (uint8_t i = 0; i < 3; i++) {
+    bits[i] = (uint32_t)words[2 * i] << 16 | words[2 * i + 1];
+  }
+  memcpy(&co2[index], &bits[0], sizeof(float));
+  memcpy(&temperature[index], &bits[1], sizeof(float));
+  memcpy(&relative_humidity[index], &bits[2], sizeof(float));
+}
+
+/**
+ * @brief Decode one frame, zeroing its readings if any CRC is bad
+ *
+ * @param frame The frame to decode
+ * @param index The frame's position in the output columns
+ * @param co2 CO2 column
+ * @param temperature Temperature column
+ * @param relative_humidity Humidity column
+ * @param valid Validity column, or NULL
+ * @return true: the frame was valid
+ */
+static bool decode_frame(const uint8_t *frame, size_t index, float *co2,
+                         float *temperature, float *relative_humidity,
+                         uint8_t *valid) {
+  uint16_t words[6];
+  bool ok = scd30_unpack_frame(frame, words, 6);
+  if (!ok) {
+    memset(words, 0, sizeof(words));
+  }
+  store_measurement(words, index, co2, temperature, relative_humidity);
+  if (valid) {
+    valid[index] = ok;
+  }
+  return ok;
+}
+
+/**
+ * @brief Validate and decode measurement frames one at a time. Gives the same
+ * results as `scd30_decode_frames`, and is what it uses without SIMD.
+ *
+ * @param frames `count` frames of `SCD30_FRAME_SIZE` bytes, back to back
+ * @param count The number of frames
+ * @param co2 Where to store `count` CO2 readings in ppm
+ * @param temperature Where to store `count` temperatures in degrees C
+ * @param relative_humidity Where to store `count` humidities in %
+ * @param valid Where to store `count` flags, 1 if the frame's CRCs matched, or
+ * NULL. Readings from frames with bad CRCs are set to 0.
+ * @return The number of valid frames
+ */
+size_t scd30_decode_frames_scalar(const uint8_t *frames, size_t count,
+                                  float *co2, float *temperature,
+                                  float *relative_humidity, uint8_t *valid) {
+  size_t good = 0;
+  for (size_t i = 0; i < count; i++) {
+    good += decode_frame(frames + i * SCD30_FRAME_SIZE, i, co2, temperature,
+                         relative_humidity, valid);
+  }
+  return good;
+}
+
+#if defined(SCD30_FRAME_SSSE3) || defined(SCD30_FRAME_NEON)
+/*
+ * The CRC8 of a word is linear in its bits apart from the effect of the
+ * initialization value, so it can be computed as the XOR of four 16 entry
+ * lookups, one per nibble, which map onto byte shuffle instructions. The
+ * constant from the initialization value is folded into the first table.
+ */
+#define CRC8_BYTE(n) crc8_shift(n, 8)
+#define CRC8_MSB(n) CRC8_BYTE(CRC8_BYTE(n))
+#define CRC8_INIT_TERM CRC8_MSB(SCD30_CRC8_INIT)
+#define CRC8_NIBBLES(f, k)                                                     \
+  f(0x0 * k), f(0x1 * k), f(0x2 * k), f(0x3 * k), f(0x4 * k), f(0x5 * k),     \
+      f(0x6 * k), f(0x7 * k), f(0x8 * k), f(0x9 * k), f(0xA * k),             \
+      f(0xB * k), f(0xC * k), f(0xD * k), f(0xE * k), f(0xF * k)
+#define CRC8_MSB_LOW(n) (uint8_t)(CRC8_MSB(n) ^ CRC8_INIT_TERM)
+
+/** Nibble lookups: MSB low and high nibble, then LSB low and high nibble */
+alignas(16) static const uint8_t crc8_nibble_tables[4][16] = {
+    {CRC8_NIBBLES(CRC8_MSB_LOW, 1)},
+    {CRC8_NIBBLES(CRC8_MSB, 16)},
+    {CRC8_NIBBLES(CRC8_BYTE, 1)},
+    {CRC8_NIBBLES(CRC8_BYTE, 16)}};
+
+#undef CRC8_MSB_LOW
+#undef CRC8_NIBBLES
+#undef CRC8_INIT_TERM
+#undef CRC8_MSB
+#undef CRC8_BYTE
+
+#define SIMD_FRAMES 8 ///< Frames per SIMD step, 48 words in 3 vectors of 16
+#endif
+
+#if defined(SCD30_FRAME_SSSE3)
+/** Byte shuffles that pick the MSBs, LSBs and CRCs of 16 words from each of
+    the three vectors holding them */
+alignas(16) static const int8_t deinterleave[3][3][16] = {
+    {{0, 3, 6, 9, 12, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+     {-1, -1, -1, -1, -1, -1, 2, 5, 8, 11, 14, -1, -1, -1, -1, -1},
+     {-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 1, 4, 7, 10, 13}},
+    {{1, 4, 7, 10, 13, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+     {-1, -1, -1, -1, -1, 0, 3, 6, 9, 12, 15, -1, -1, -1, -1, -1},
+     {-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 2, 5, 8, 11, 14}},
+    {{2, 5, 8, 11, 14, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+     {-1, -1, -1, -1, -1, 1, 4, 7, 10, 13, -1, -1, -1, -1, -1, -1},
+     {-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 0, 3, 6, 9, 12, 15}}};
+
+/**
+ * @brief Check and unpack 16 consecutive words
+ *
+ * @param data 48 bytes of words and CRCs
+ * @param words Where to store the 16 words, native byte order
+ * @return Bitmask with bit n set if word n's CRC matched
+ */
+static inline uint32_t check_words(const uint8_t *data, uint16_t *words) {
+  __m128i v[3], lanes[3];
+  for (uint8_t i = 0; i < 3; i++) {
+    v[i] = _mm_loadu_si128((const __m128i *)(data + 16 * i));
+  }
+  for (uint8_t k = 0; k < 3; k++) {
+    lanes[k] = _mm_setzero_si128();
+    for (uint8_t i = 0; i < 3; i++) {
+      __m128i mask = _mm_load_si128((const __m128i *)deinterleave[k][i]);
+      lanes[k] = _mm_or_si128(lanes[k], _mm_shuffle_epi8(v[i], mask));
+    }
+  }
+
+  const __m128i low = _mm_set1_epi8(0x0F);
+  __m128i crc = _mm_setzero_si128();
+  for (uint8_t k = 0; k < 2; k++) {
+    __m128i lo = _mm_and_si128(lanes[k], low);
+    __m128i hi = _mm_and_si128(_mm_srli_epi16(lanes[k], 4), low);
+    crc = _mm_xor_si128(
+        crc, _mm_shuffle_epi8(
+                 _mm_load_si128((const __m128i *)crc8_nibble_tables[2 * k]),
+                 lo));
+    crc = _mm_xor_si128(
+        crc,
+        _mm_shuffle_epi8(
+            _mm_load_si128((const __m128i *)crc8_nibble_tables[2 * k + 1]),
+            hi));
+  }
+
+  _mm_storeu_si128((__m128i *)words, _mm_unpacklo_epi8(lanes[1], lanes[0]));
+  _mm_storeu_si128((__m128i *)(words + 8),
+                   _mm_unpackhi_epi8(lanes[1], lanes[0]));
+  return _mm_movemask_epi8(_mm_cmpeq_epi8(crc, lanes[2]));
+}
+#elif defined(SCD30_FRAME_NEON)
+/**
+ * @brief Check and unpack 16 consecutive words
+ *
+ * @param data 48 bytes of words and CRCs
+ * @param words Where to store the 16 words, native byte order
+ * @return Bitmask with bit n set if word n's CRC matched
+ */
+static inline uint32_t check_words(const uint8_t *data, uint16_t *words) {
+  uint8x16x3_t lanes = vld3q_u8(data);
+
+  const uint8x16_t low = vdupq_n_u8(0x0F);
+  uint8x16_t crc = vdupq_n_u8(0);
+  for (uint8_t k = 0; k < 2; k++) {
+    uint8x16_t lo = vandq_u8(lanes.val[k], low);
+    uint8x16_t hi = vshrq_n_u8(lanes.val[k], 4);
+    crc = veorq_u8(crc, vqtbl1q_u8(vld1q_u8(crc8_nibble_tables[2 * k]), lo));
+    crc = veorq_u8(crc,
+                   vqtbl1q_u8(vld1q_u8(crc8_nibble_tables[2 * k + 1]), hi));
+  }
+
+  uint8x16x2_t swapped = {{lanes.val[1], lanes.val[0]}};
+  vst2q_u8((uint8_t *)words, swapped);
+
+  // narrow the 0x00/0xFF compare result to one bit per word
+  static const uint8_t bits[16] = {1, 2, 4, 8, 16, 32, 64, 128,
+                                   1, 2, 4, 8, 16, 32, 64, 128};
+  uint8x16_t match = vandq_u8(vceqq_u8(crc, lanes.val[2]), vld1q_u8(bits));
+  return vaddv_u8(vget_low_u8(match)) |
+         (uint32_t)vaddv_u8(vget_high_u8(match)) << 8;
+}
+#endif
+
+/**
+ * @brief Validate and decode many measurement frames, as received from field
+ * nodes, into one array per reading. Uses SSSE3 or AArch64 NEON when the
+ * compiler targets them, unless `SCD30_FRAME_NO_SIMD` is defined.
+ *
+ * @param frames `count` frames of `SCD30_FRAME_SIZE` bytes, back to back
+ * @param count The number of frames
+ * @param co2 Where to store `count` CO2 readings in ppm
+ * @param temperature Where to store `count` temperatures in degrees C
+ * @param relative_humidity Where to store `count` humidities in %
+ * @param valid Where to store `count` flags, 1 if the frame's CRCs matched, or
+ * NULL. Readings from frames with bad CRCs are set to 0.
+ * @return The number of valid frames
+ */
+size_t scd30_decode_frames(const uint8_t *frames, size_t count, float *co2,
+                           float *temperature, float *relative_humidity,
+                           uint8_t *valid) {
+  size_t i = 0, good = 0;
+
+#if defined(SCD30_FRAME_SSSE3) || defined(SCD30_FRAME_NEON)
+  for (; i + SIMD_FRAMES <= count; i += SIMD_FRAMES) {
+    const uint8_t *data = frames + i * SCD30_FRAME_SIZE;
+    uint16_t words[6 * SIMD_FRAMES];
+    uint64_t matched = 0;
+    for (uint8_t block = 0; block < 3; block++) {
+      matched |= (uint64_t)check_words(data + 48 * block, words + 16 * block)
+                 << (16 * block);
+    }
+
+    for (uint8_t f = 0; f < SIMD_FRAMES; f++) {
+      bool ok = ((matched >> (6 * f)) & 0x3F) == 0x3F;
+      if (!ok) {
+        memset(words + 6 * f, 0, 6 * sizeof(uint16_t));
+      }
+      store_measurement(words + 6 * f, i + f, co2, temperature,
+                        relative_humidity);
+      if (valid) {
+        valid[i + f] = ok;
+      }
+      good += ok;
+    }
+  }
+#endif
+
+  for (; i < count; i++) {
+    good += decode_frame(frames + i * SCD30_FRAME_SIZE, i, co2, temperature,
+                         relative_humidity, valid);
+  }
+  return good;
+}
@@ -0,0 +1,43 @@
+/*!
+ *  @file Adafruit_SCD30_Frame.h
+ *
+ * 	CRC checking and decoding of frames read from the Adafruit SCD30 CO2,
+ * 	Temperature, and Humidity sensor. Needs nothing from the Arduino core, so
+ * 	frames forwarded by field nodes can also be decoded on a gateway.
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	 license (see license.txt)
+ */
+
+#ifndef _ADAFRUIT_SCD30_FRAME_H
+#define _ADAFRUIT_SCD30_FRAME_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define SCD30_FRAME_SIZE                                                       \
+  18 ///< Measurement frame: six big-endian words, each followed by its CRC8
+
+#if !defined(SCD30_FRAME_NO_SIMD) && defined(__SSSE3__)
+#define SCD30_FRAME_SSSE3 ///< Bulk decoding uses SSSE3
+#elif !defined(SCD30_FRAME_NO_SIMD) && defined(__ARM_NEON) &&                 \
+    defined(__aarch64__)
+#define SCD30_FRAME_NEON ///< Bulk decoding uses AArch64 NEON
+#endif
+
+uint8_t scd30_crc8(const uint8_t *data, uint8_t len);
+bool scd30_validate_frame(const uint8_t *frame, uint8_t len);
+bool scd30_unpack_frame(const uint8_t *frame, uint16_t *words, uint8_t count);
+
+size_t scd30_decode_frames(const uint8_t *frames, size_t count, float *co2,
+                           float *temperature, float *relative_humidity,
+                           uint8_t *valid);
+size_t scd30_decode_frames_scalar(const uint8_t *frames, size_t count,
+                                  float *co2, float *temperature,
+                                  float *relative_humidity, uint8_t *valid);
+
+#endif
@@ -0,0 +1,267 @@
+/*!
+ *  @file Adafruit_SCD30_History.cpp
+ *
+ * 	Fixed size sample history with rolling statistics for the Adafruit SCD30
+ * 	CO2, Temperature, and Humidity sensor library
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ * 	BSD (see license.txt)
+ */
+
+#include "Adafruit_SCD30_History.h"
+#include <string.h>
+
+/**
+ * @brief Round a value to the nearest integer, clamped to a range
+ *
+ * @param value The value to convert
+ * @param min The smallest allowed result
+ * @param max The largest allowed result
+ * @return The rounded and clamped value, 0 for NaN
+ */
+static int32_t to_fixed(float value, int32_t min, int32_t max) {
+  if (!(value == value)) { // NaN
+    return 0;
+  }
+  if (value <= min) {
+    return min;
+  }
+  if (value >= max) {
+    return max;
+  }
+  return (int32_t)(value + (value < 0 ? -0.5f : 0.5f));
+}
+
+/**
+ * @brief Construct a new history using the given storage
+ *
+ * @param samples Storage for `capacity` samples
+ * @param deque_slots Storage for `capacity * SCD30_CHANNEL_COUNT * 2`
+ * positions, used to track the min and max of each channel
+ * @param capacity The number of samples to keep, up to `SCD30_HISTORY_MAX_SIZE`
+ */
+Adafruit_SCD30_HistoryBase::Adafruit_SCD30_HistoryBase(
+    scd30_history_sample_t *samples, uint16_t *deque_slots, uint16_t capacity) {
+  _samples = samples;
+  _capacity = capacity;
+
+  for (uint8_t ch = 0; ch < SCD30_CHANNEL_COUNT; ch++) {
+    _min[ch].slots = deque_slots + (2 * ch) * capacity;
+    _max[ch].slots = deque_slots + (2 * ch + 1) * capacity;
+  }
+  clear();
+}
+
+/**
+ * @brief Remove all samples from the history
+ */
+void Adafruit_SCD30_HistoryBase::clear(void) {
+  _head = 0;
+  _count = 0;
+
+  for (uint8_t ch = 0; ch < SCD30_CHANNEL_COUNT; ch++) {
+    _sum[ch] = 0;
+    _sum_squares[ch] = 0;
+    _min[ch].head = _min[ch].count = 0;
+    _max[ch].head = _max[ch].count = 0;
+  }
+}
+
+/**
+ * @brief Add a sample, replacing the oldest one if the history is full
+ *
+ * @param co2 CO2 concentration in ppm
+ * @param temperature Temperature in degrees C
+ * @param relative_humidity Relative humidity in %
+ * @param timestamp `millis()` when the sample was read
+ */
+void Adafruit_SCD30_HistoryBase::add(float co2, float temperature,
+                                     float relative_humidity,
+                                     uint32_t timestamp) {
+  uint16_t position;
+
+  if (_count == _capacity) {
+    position = _head;
+    evict(position);
+    _head = (_head + 1) % _capacity;
+  } else {
+    position = (_head + _count) % _capacity;
+    _count++;
+  }
+
+  scd30_history_sample_t *sample = &_samples[position];
+  sample->timestamp = timestamp;
+  sample->co2 = to_fixed(co2 * 10, 0, SCD30_COMPACT_CO2_MAX);
+  sample->temperature = to_fixed(temperature * 100, INT16_MIN, INT16_MAX);
+  sample->humidity = to_fixed(relative_humidity * 100, 0, 10000);
+
+  for (uint8_t ch = 0; ch < SCD30_CHANNEL_COUNT; ch++) {
+    int32_t v = value(position, ch);
+    _sum[ch] += v;
+    _sum_squares[ch] += (int64_t)v * v;
+    push(&_min[ch], position, ch, false);
+    push(&_max[ch], position, ch, true);
+  }
+}
+
+/**
+ * @brief Get a sample from the history
+ *
+ * @param index The sample to get, 0 being the oldest
+ * @param sample The sample to fill
+ * @return true: success false: `index` is past the newest sample
+ */
+bool Adafruit_SCD30_HistoryBase::get(uint16_t index,
+                                     scd30_history_sample_t *sample) const {
+  if (index >= _count) {
+    return false;
+  }
+  *sample = _samples[(_head + index) % _capacity];
+  return true;
+}
+
+/**
+ * @brief Copy a window of samples out of the history, oldest first
+ *
+ * @param dest Where to copy the samples
+ * @param max_samples The number of samples `dest` can hold
+ * @param start The first sample to copy, 0 being the oldest
+ * @return uint16_t The number of samples copied
+ */
+uint16_t Adafruit_SCD30_HistoryBase::copy(scd30_history_sample_t *dest,
+                                          uint16_t max_samples,
+                                          uint16_t start) const {
+  if (start >= _count) {
+    return 0;
+  }
+  uint16_t n = _count - start;
+  if (n > max_samples) {
+    n = max_samples;
+  }
+
+  // the window is at most two contiguous runs of the ring
+  uint16_t first = (_head + start) % _capacity;
+  uint16_t run = _capacity - first;
+  if (run > n) {
+    run = n;
+  }
+  memcpy(dest, &_samples[first], run * sizeof(scd30_history_sample_t));
+  memcpy(dest + run, _samples, (n - run) * sizeof(scd30_history_sample_t));
+  return n;
+}
+
+/**
+ * @brief Get the mean, variance, min and max of a channel over the samples in
+ * the history
+ *
+ * @param channel The channel to get statistics for
+ * @param stats The statistics to fill
+ * @return true: success false: the history is empty
+ */
+bool Adafruit_SCD30_HistoryBase::getStats(scd30_channel_t channel,
+                                          scd30_history_stats_t *stats) const {
+  if ((_count == 0) || (channel >= SCD30_CHANNEL_COUNT)) {
+    return false;
+  }
+  float scale = (channel == SCD30_CHANNEL_CO2) ? 0.1f : 0.01f;
+
+  // The sums are exact, so the variance doesn't drift as samples come and go.
+  // With sum = q * count + r, the squared deviations from q sum to `spread`
+  // and the variance is spread / count - (r / count)^2, all of which fits in
+  // 64 bits where count * sum of squares - sum^2 would not.
+  int64_t q = _sum[channel] / _count;
+  int64_t r = _sum[channel] % _count;
+  int64_t spread = _sum_squares[channel] - q * q * _count - 2 * q * r;
+  float fraction = (float)r / _count;
+
+  stats->mean = (float)_sum[channel] / _count * scale;
+  stats->variance =
+      ((float)spread / _count - fraction * fraction) * scale * scale;
+  stats->min = value(front(&_min[channel]), channel) * scale;
+  stats->max = value(front(&_max[channel]), channel) * scale;
+  return true;
+}
+
+/**
+ * @brief Get one channel of a stored sample
+ *
+ * @param position The position of the sample in the ring
+ * @param channel The channel to get
+ * @return int32_t The fixed point value
+ */
+int32_t Adafruit_SCD30_HistoryBase::value(uint16_t position,
+                                          uint8_t channel) const {
+  const scd30_history_sample_t *sample = &_samples[position];
+
+  switch (channel) {
+  case SCD30_CHANNEL_CO2:
+    return sample->co2;
+  case SCD30_CHANNEL_TEMPERATURE:
+    return sample->temperature;
+  default:
+    return sample->humidity;
+  }
+}
+
+/**
+ * @brief Take the sample at `position` out of the running sums and min/max
+ * queues before it is overwritten
+ *
+ * @param position The position of the oldest sample in the ring
+ */
+void Adafruit_SCD30_HistoryBase::evict(uint16_t position) {
+  for (uint8_t ch = 0; ch < SCD30_CHANNEL_COUNT; ch++) {
+    int32_t v = value(position, ch);
+    _sum[ch] -= v;
+    _sum_squares[ch] -= (int64_t)v * v;
+
+    // the oldest sample can only be at the front of a queue
+    extreme_queue_t *queues[2] = {&_min[ch], &_max[ch]};
+    for (uint8_t q = 0; q < 2; q++) {
+      if (queues[q]->count && (front(queues[q]) == position)) {
+        queues[q]->head = (queues[q]->head + 1) % _capacity;
+        queues[q]->count--;
+      }
+    }
+  }
+}
+
+/**
+ * @brief Add a sample to a monotonic queue, dropping the queued samples it
+ * supersedes as the min (or max) of every window they share
+ *
+ * @param queue The queue to add to
+ * @param position The position of the new sample in the ring
+ * @param channel The channel the queue tracks
+ * @param is_max true: the queue tracks the max false: the min
+ */
+void Adafruit_SCD30_HistoryBase::push(extreme_queue_t *queue,
+                                      uint16_t position, uint8_t channel,
+                                      bool is_max) {
+  int32_t v = value(position, channel);
+
+  while (queue->count) {
+    uint16_t back = queue->slots[(queue->head + queue->count - 1) % _capacity];
+    int32_t back_value = value(back, channel);
+    if (is_max ? (back_value > v) : (back_value < v)) {
+      break;
+    }
+    queue->count--;
+  }
+  queue->slots[(queue->head + queue->count) % _capacity] = position;
+  queue->count++;
+}
+
+/**
+ * @brief Get the position of the sample at the front of a queue
+ *
+ * @param queue The queue to look at, which must not be empty
+ * @return uint16_t The position of the queue's min (or max) sample
+ */
+uint16_t
+Adafruit_SCD30_HistoryBase::front(const extreme_queue_t *queue) const {
+  return queue->slots[queue->head];
+}
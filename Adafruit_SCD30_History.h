@@ -0,0 +1,133 @@
+/*!
+ *  @file Adafruit_SCD30_History.h
+ *
+ * 	Fixed size sample history with rolling statistics for the Adafruit SCD30
+ * 	CO2, Temperature, and Humidity sensor library
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	 license (see license.txt)
+ */
+
+#ifndef _ADAFRUIT_SCD30_HISTORY_H
+#define _ADAFRUIT_SCD30_HISTORY_H
+
+#include "Adafruit_SCD30_Compact.h"
+#include <stdint.h>
+
+#define SCD30_HISTORY_MAX_SIZE 32767 ///< Largest supported history size
+
+/**
+ * @brief
+ *
+ * A sample as stored in the history, in fixed point at the scale of
+ * `scd30_compact_sample_t`, 12 bytes with no padding.
+ */
+typedef struct {
+  uint32_t timestamp;  ///< `millis()` when the sample was read
+  uint32_t co2;        ///< CO2 concentration in 0.1 ppm
+  int16_t temperature; ///< Temperature in 0.01 degrees C
+  uint16_t humidity;   ///< Relative humidity in 0.01 %
+} scd30_history_sample_t;
+
+/**
+ * @brief
+ *
+ * Channels of a sample that statistics can be computed for.
+ */
+typedef enum {
+  SCD30_CHANNEL_CO2,         ///< CO2 concentration
+  SCD30_CHANNEL_TEMPERATURE, ///< Temperature
+  SCD30_CHANNEL_HUMIDITY,    ///< Relative humidity
+  SCD30_CHANNEL_COUNT,       ///< Number of channels
+} scd30_channel_t;
+
+/**
+ * @brief
+ *
+ * Statistics over the samples currently in the history, in the units of the
+ * driver's `CO2`, `temperature` and `relative_humidity` readings.
+ */
+typedef struct {
+  float mean;     ///< Mean of the samples
+  float variance; ///< Population variance of the samples
+  float min;      ///< Smallest sample
+  float max;      ///< Largest sample
+} scd30_history_stats_t;
+
+/*!
+ *    @brief  Ring buffer of the most recent samples, keeping the mean,
+ *            variance, min and max of each channel up to date in constant
+ *            time per sample. Storage is supplied by the caller; use
+ *            `Adafruit_SCD30_History` to have it allocated statically.
+ */
+class Adafruit_SCD30_HistoryBase {
+public:
+  Adafruit_SCD30_HistoryBase(scd30_history_sample_t *samples,
+                             uint16_t *deque_slots, uint16_t capacity);
+
+  void clear(void);
+  void add(float co2, float temperature, float relative_humidity,
+           uint32_t timestamp);
+
+  /** @brief Get the number of samples stored
+      @return The number of samples, up to `capacity()` */
+  uint16_t size(void) const { return _count; }
+  /** @brief Get the maximum number of samples stored
+      @return The history size */
+  uint16_t capacity(void) const { return _capacity; }
+
+  bool get(uint16_t index, scd30_history_sample_t *sample) const;
+  uint16_t copy(scd30_history_sample_t *dest, uint16_t max_samples,
+                uint16_t start = 0) const;
+
+  bool getStats(scd30_channel_t channel, scd30_history_stats_t *stats) const;
+
+private:
+  /** Monotonic queue of sample positions, used for the sliding min or max */
+  typedef struct {
+    uint16_t *slots; ///< Ring of sample positions
+    uint16_t head;   ///< Index in `slots` of the oldest position
+    uint16_t count;  ///< Number of positions queued
+  } extreme_queue_t;
+
+  int32_t value(uint16_t position, uint8_t channel) const;
+  void evict(uint16_t position);
+  void push(extreme_queue_t *queue, uint16_t position, uint8_t channel,
+            bool is_max);
+  uint16_t front(const extreme_queue_t *queue) const;
+
+  scd30_history_sample_t *_samples; ///< Ring of `_capacity` samples
+  uint16_t _capacity;               ///< Maximum number of samples
+  uint16_t _head = 0;               ///< Position of the oldest sample
+  uint16_t _count = 0;              ///< Number of samples stored
+
+  int64_t _sum[SCD30_CHANNEL_COUNT];         ///< Sum of each channel
+  int64_t _sum_squares[SCD30_CHANNEL_COUNT]; ///< Sum of squares per channel
+  extreme_queue_t _min[SCD30_CHANNEL_COUNT]; ///< Sliding min per channel
+  extreme_queue_t _max[SCD30_CHANNEL_COUNT]; ///< Sliding max per channel
+};
+
+/*!
+ *    @brief  Sample history holding the last `SIZE` samples in statically
+ *            allocated storage
+ */
+template <uint16_t SIZE>
+class Adafruit_SCD30_History : public Adafruit_SCD30_HistoryBase {
+  static_assert(SIZE > 0 && SIZE <= SCD30_HISTORY_MAX_SIZE,
+                "history size out of range");
+
+public:
+  /** @brief Create an empty history */
+  Adafruit_SCD30_History()
+      : Adafruit_SCD30_HistoryBase(_sample_storage, _deque_storage, SIZE) {}
+
+private:
+  scd30_history_sample_t _sample_storage[SIZE]; ///< Sample ring storage
+  uint16_t _deque_storage[SIZE * SCD30_CHANNEL_COUNT * 2]; ///< Min/max queues
+};
+
+#endif
@@ -0,0 +1,314 @@
+/*!
+ *  @file Adafruit_SCD30_Log.cpp
+ *
+ * 	Compact binary log format for samples from the Adafruit SCD30 CO2,
+ * 	Temperature, and Humidity sensor library
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ * 	BSD (see license.txt)
+ */
+
+#include "Adafruit_SCD30_Log.h"
+#include "Adafruit_SCD30_Frame.h"
+
+/*
+ * Record layout, integers are LEB128 style varints, signed ones zigzag coded:
+ *
+ * Header:   0xC0 'S' 'C' 'D' version sensor_id(signed) interval CRC8
+ * Keyframe: 0xC1 timestamp co2 temperature(signed) humidity CRC8
+ * Delta:    0xC2 timestamp-previous-interval co2 temperature humidity CRC8
+ *           with every field signed and relative to the previous sample
+ *
+ * The CRC8 covers every byte of the record before it.
+ */
+
+/**
+ * @brief Map a signed value to an unsigned one with small magnitudes first
+ *
+ * @param value The value to map
+ * @return The zigzag coded value
+ */
+static uint32_t zigzag(int32_t value) {
+  return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+/**
+ * @brief Undo `zigzag`
+ *
+ * @param value The zigzag coded value
+ * @return The original value
+ */
+static int32_t unzigzag(uint32_t value) {
+  return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+/**
+ * @brief Write a varint, seven bits per byte starting with the lowest
+ *
+ * @param buffer Where to write the up to 5 bytes
+ * @param value The value to write
+ * @return The number of bytes written
+ */
+static uint8_t put_varint(uint8_t *buffer, uint32_t value) {
+  uint8_t len = 0;
+  while (value >= 0x80) {
+    buffer[len++] = (value & 0x7F) | 0x80;
+    value >>= 7;
+  }
+  buffer[len++] = value;
+  return len;
+}
+
+/**
+ * @brief Read a varint
+ *
+ * @param data The data to read from
+ * @param len The number of bytes available
+ * @param pos The position to read at, advanced past the varint
+ * @param value Set to the value read
+ * @return 1: success 0: the data ends before the varint does -1: the varint
+ * is too long to be valid
+ */
+static int8_t get_varint(const uint8_t *data, size_t len, size_t *pos,
+                         uint32_t *value) {
+  *value = 0;
+  for (uint8_t shift = 0; shift < 35; shift += 7) {
+    if (*pos >= len) {
+      return 0;
+    }
+    uint8_t byte = data[(*pos)++];
+    *value |= (uint32_t)(byte & 0x7F) << shift;
+    if (!(byte & 0x80)) {
+      return 1;
+    }
+  }
+  return -1;
+}
+
+/**
+ * @brief Append the CRC8 of a record
+ *
+ * @param buffer The record
+ * @param len The length of the record so far
+ * @return The length of the record with its CRC
+ */
+static uint8_t finish_record(uint8_t *buffer, uint8_t len) {
+  buffer[len] = scd30_crc8(buffer, len);
+  return len + 1;
+}
+
+/**
+ * @brief Create an encoder. Call `begin` before adding samples.
+ *
+ * @param keyframe_interval The number of difference records written between
+ * keyframes. Lower values lose fewer samples to a corrupted record, higher
+ * values make smaller logs.
+ */
+Adafruit_SCD30_LogEncoder::Adafruit_SCD30_LogEncoder(
+    uint16_t keyframe_interval) {
+  _keyframe_interval = keyframe_interval;
+}
+
+/**
+ * @brief Start a new log segment
+ *
+ * @param sensor_id The sensor ID to record
+ * @param interval The measurement interval in seconds, used to store the
+ * time between samples compactly
+ * @param buffer Where to write the header, at least
+ * `SCD30_LOG_MAX_RECORD_SIZE` bytes
+ * @return The number of bytes written to `buffer`
+ */
+uint8_t Adafruit_SCD30_LogEncoder::begin(int32_t sensor_id, uint16_t interval,
+                                         uint8_t *buffer) {
+  _started = false;
+  _expected_ms = (uint32_t)interval * 1000;
+
+  uint8_t len = 0;
+  buffer[len++] = SCD30_LOG_RECORD_HEADER;
+  buffer[len++] = 'S';
+  buffer[len++] = 'C';
+  buffer[len++] = 'D';
+  buffer[len++] = SCD30_LOG_VERSION;
+  len += put_varint(buffer + len, zigzag(sensor_id));
+  len += put_varint(buffer + len, interval);
+  return finish_record(buffer, len);
+}
+
+/**
+ * @brief Encode a sample
+ *
+ * @param sample The sample in fixed point. CO2 and humidity are clamped to
+ * `SCD30_COMPACT_CO2_MAX` and `SCD30_COMPACT_HUMIDITY_MAX`.
+ * @param timestamp `millis()` when the sample was read
+ * @param buffer Where to write the record, at least
+ * `SCD30_LOG_MAX_RECORD_SIZE` bytes
+ * @return The number of bytes written to `buffer`
+ */
+uint8_t Adafruit_SCD30_LogEncoder::add(const scd30_compact_sample_t *sample,
+                                       uint32_t timestamp, uint8_t *buffer) {
+  uint32_t elapsed = timestamp - _timestamp;
+  uint8_t len = 0;
+
+  // larger values would make a record longer than the buffer is sized for
+  scd30_compact_sample_t clamped = *sample;
+  if (clamped.co2 > SCD30_COMPACT_CO2_MAX) {
+    clamped.co2 = SCD30_COMPACT_CO2_MAX;
+  }
+  if (clamped.humidity > SCD30_COMPACT_HUMIDITY_MAX) {
+    clamped.humidity = SCD30_COMPACT_HUMIDITY_MAX;
+  }
+  sample = &clamped;
+
+  // a keyframe also covers the clock going backwards
+  if (!_started || (_since_keyframe >= _keyframe_interval) ||
+      ((int32_t)elapsed < 0)) {
+    buffer[len++] = SCD30_LOG_RECORD_KEYFRAME;
+    len += put_varint(buffer + len, timestamp);
+    len += put_varint(buffer + len, sample->co2);
+    len += put_varint(buffer + len, zigzag(sample->temperature));
+    len += put_varint(buffer + len, sample->humidity);
+    _started = true;
+    _since_keyframe = 0;
+  } else {
+    buffer[len++] = SCD30_LOG_RECORD_DELTA;
+    len += put_varint(buffer + len,
+                      zigzag((int32_t)(elapsed - _expected_ms)));
+    len += put_varint(buffer + len,
+                      zigzag((int32_t)(sample->co2 - _previous.co2)));
+    len += put_varint(buffer + len,
+                      zigzag(sample->temperature - _previous.temperature));
+    len += put_varint(buffer + len,
+                      zigzag(sample->humidity - _previous.humidity));
+    _since_keyframe++;
+  }
+
+  _timestamp = timestamp;
+  _previous = *sample;
+  return finish_record(buffer, len);
+}
+
+/**
+ * @brief Encode a sample as read by `Adafruit_SCD30::read`
+ *
+ * @param co2 CO2 concentration in ppm
+ * @param temperature Temperature in degrees C
+ * @param relative_humidity Relative humidity in %
+ * @param timestamp `millis()` when the sample was read
+ * @param buffer Where to write the record, at least
+ * `SCD30_LOG_MAX_RECORD_SIZE` bytes
+ * @return The number of bytes written to `buffer`
+ */
+uint8_t Adafruit_SCD30_LogEncoder::add(float co2, float temperature,
+                                       float relative_humidity,
+                                       uint32_t timestamp, uint8_t *buffer) {
+  scd30_compact_sample_t sample;
+  scd30_compact_from_floats(co2, temperature, relative_humidity, &sample);
+  return add(&sample, timestamp, buffer);
+}
+
+/**
+ * @brief Create a decoder, waiting for a header or keyframe
+ */
+Adafruit_SCD30_LogDecoder::Adafruit_SCD30_LogDecoder() {
+  _sample.co2 = 0;
+  _sample.temperature = 0;
+  _sample.humidity = 0;
+}
+
+/**
+ * @brief Decode the record at the start of `data`
+ *
+ * Call repeatedly, advancing `data` by `used` each time. After bad data the
+ * decoder skips ahead until the next header or keyframe, so difference
+ * records that can't be applied are also reported as corrupt.
+ *
+ * @param data The log data, starting at a record
+ * @param len The number of bytes available
+ * @param used Set to the number of bytes consumed
+ * @return scd30_log_result_t What was found. Read the header fields or the
+ * sample with the accessors.
+ */
+scd30_log_result_t Adafruit_SCD30_LogDecoder::decode(const uint8_t *data,
+                                                     size_t len,
+                                                     size_t *used) {
+  *used = 0;
+  if (len == 0) {
+    return SCD30_LOG_NEED_MORE;
+  }
+
+  uint8_t type = data[0];
+  size_t pos = 1;
+  uint32_t fields[4];
+  uint8_t count;
+
+  if (type == SCD30_LOG_RECORD_HEADER) {
+    if (len < 5) {
+      return SCD30_LOG_NEED_MORE;
+    }
+    if ((data[1] != 'S') || (data[2] != 'C') || (data[3] != 'D') ||
+        (data[4] != SCD30_LOG_VERSION)) {
+      _synced = false;
+      *used = 1;
+      return SCD30_LOG_CORRUPT;
+    }
+    pos = 5;
+    count = 2;
+  } else if ((type == SCD30_LOG_RECORD_KEYFRAME) ||
+             (type == SCD30_LOG_RECORD_DELTA)) {
+    count = 4;
+  } else {
+    _synced = false;
+    *used = 1;
+    return SCD30_LOG_CORRUPT;
+  }
+
+  for (uint8_t i = 0; i < count; i++) {
+    int8_t result = get_varint(data, len, &pos, &fields[i]);
+    if (result < 0) {
+      _synced = false;
+      *used = 1;
+      return SCD30_LOG_CORRUPT;
+    }
+    if (result == 0) {
+      return SCD30_LOG_NEED_MORE;
+    }
+  }
+  if (pos >= len) {
+    return SCD30_LOG_NEED_MORE;
+  }
+  if (scd30_crc8(data, pos) != data[pos]) {
+    _synced = false;
+    *used = 1;
+    return SCD30_LOG_CORRUPT;
+  }
+  *used = pos + 1;
+
+  if (type == SCD30_LOG_RECORD_HEADER) {
+    _sensor_id = unzigzag(fields[0]);
+    _interval = fields[1];
+    _synced = false;
+    return SCD30_LOG_HEADER;
+  }
+
+  if (type == SCD30_LOG_RECORD_KEYFRAME) {
+    _timestamp = fields[0];
+    _sample.co2 = fields[1];
+    _sample.temperature = unzigzag(fields[2]);
+    _sample.humidity = fields[3];
+    _synced = true;
+    return SCD30_LOG_SAMPLE;
+  }
+
+  if (!_synced) {
+    return SCD30_LOG_CORRUPT;
+  }
+  _timestamp += (uint32_t)_interval * 1000 + unzigzag(fields[0]);
+  _sample.co2 += unzigzag(fields[1]);
+  _sample.temperature += unzigzag(fields[2]);
+  _sample.humidity += unzigzag(fields[3]);
+  return SCD30_LOG_SAMPLE;
+}
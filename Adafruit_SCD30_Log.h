@@ -0,0 +1,108 @@
+/*!
+ *  @file Adafruit_SCD30_Log.h
+ *
+ * 	Compact binary log format for samples from the Adafruit SCD30 CO2,
+ * 	Temperature, and Humidity sensor library. Needs nothing from the Arduino
+ * 	core, so logs can be decoded on a computer.
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	 license (see license.txt)
+ */
+
+#ifndef _ADAFRUIT_SCD30_LOG_H
+#define _ADAFRUIT_SCD30_LOG_H
+
+#include "Adafruit_SCD30_Compact.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#define SCD30_LOG_VERSION 1 ///< Format version written in headers
+#define SCD30_LOG_MAX_RECORD_SIZE                                              \
+  17 ///< Largest record, the buffer size needed by the encoder
+#define SCD30_LOG_KEYFRAME_INTERVAL                                            \
+  64 ///< Default number of records between keyframes
+
+#define SCD30_LOG_RECORD_HEADER 0xC0   ///< Starts a log segment
+#define SCD30_LOG_RECORD_KEYFRAME 0xC1 ///< Sample with absolute values
+#define SCD30_LOG_RECORD_DELTA 0xC2    ///< Sample relative to the previous one
+
+/**
+ * @brief
+ *
+ * What `Adafruit_SCD30_LogDecoder::decode` found.
+ */
+typedef enum {
+  SCD30_LOG_NEED_MORE, ///< The record is incomplete, supply more data
+  SCD30_LOG_HEADER,    ///< A segment header was decoded
+  SCD30_LOG_SAMPLE,    ///< A sample was decoded
+  SCD30_LOG_CORRUPT,   ///< Bad data was skipped, resynchronizing
+} scd30_log_result_t;
+
+/*!
+ *    @brief  Writes samples as a stream of small records, without using the
+ *            heap or buffering more than one record.
+ *
+ *            A log is made of segments, each starting with a header holding
+ *            the sensor ID and measurement interval, so a new segment can
+ *            simply be appended to an existing file after a restart. Samples
+ *            are stored in the units of `scd30_compact_sample_t`, either as a
+ *            keyframe of absolute values or as varint encoded differences
+ *            from the previous sample. Every record ends with a CRC8, and
+ *            regular keyframes limit how much a corrupted record loses.
+ */
+class Adafruit_SCD30_LogEncoder {
+public:
+  Adafruit_SCD30_LogEncoder(
+      uint16_t keyframe_interval = SCD30_LOG_KEYFRAME_INTERVAL);
+
+  uint8_t begin(int32_t sensor_id, uint16_t interval, uint8_t *buffer);
+  uint8_t add(const scd30_compact_sample_t *sample, uint32_t timestamp,
+              uint8_t *buffer);
+  uint8_t add(float co2, float temperature, float relative_humidity,
+              uint32_t timestamp, uint8_t *buffer);
+
+private:
+  uint16_t _keyframe_interval;      ///< Records between keyframes
+  uint16_t _since_keyframe = 0;     ///< Records since the last keyframe
+  bool _started = false;            ///< True once a keyframe was written
+  uint32_t _expected_ms = 0;        ///< Expected time between samples
+  uint32_t _timestamp = 0;          ///< Timestamp of the previous sample
+  scd30_compact_sample_t _previous; ///< The previous sample
+};
+
+/*!
+ *    @brief  Reads a log written by `Adafruit_SCD30_LogEncoder` one record at
+ *            a time, from any amount of buffered data
+ */
+class Adafruit_SCD30_LogDecoder {
+public:
+  Adafruit_SCD30_LogDecoder();
+
+  scd30_log_result_t decode(const uint8_t *data, size_t len, size_t *used);
+
+  /** @brief Get the sensor ID from the current segment's header
+      @return The sensor ID */
+  int32_t sensorId(void) const { return _sensor_id; }
+  /** @brief Get the measurement interval from the current segment's header
+      @return The interval in seconds */
+  uint16_t interval(void) const { return _interval; }
+  /** @brief Get the last sample decoded
+      @return The sample, in fixed point */
+  const scd30_compact_sample_t &sample(void) const { return _sample; }
+  /** @brief Get the timestamp of the last sample decoded
+      @return `millis()` when the sample was read */
+  uint32_t timestamp(void) const { return _timestamp; }
+
+private:
+  int32_t _sensor_id = 0;         ///< Sensor ID from the header
+  uint16_t _interval = 0;         ///< Interval from the header
+  bool _synced = false;           ///< True once a keyframe was decoded
+  uint32_t _timestamp = 0;        ///< Timestamp of the last sample
+  scd30_compact_sample_t _sample; ///< The last sample
+};
+
+#endif
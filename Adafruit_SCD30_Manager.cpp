@@ -0,0 +1,213 @@
+/*!
+ *  @file Adafruit_SCD30_Manager.cpp
+ *
+ * 	Polls several Adafruit SCD30 CO2, Temperature, and Humidity sensors,
+ * 	optionally behind TCA9548A style I2C multiplexers, without blocking
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ * 	BSD (see license.txt)
+ */
+
+#include "Adafruit_SCD30_Manager.h"
+
+/**
+ * @brief Construct a new Adafruit_SCD30_Manager object with no sensors
+ */
+Adafruit_SCD30_Manager::Adafruit_SCD30_Manager(void) {}
+
+/**
+ * @brief Add a sensor to be polled. The sensor must already be started with
+ * `begin`, with its multiplexer channel selected.
+ *
+ * @param sensor The sensor's driver
+ * @param mux The multiplexer the sensor is behind, already started with
+ * `begin`, or NULL if it is attached directly
+ * @param channel The multiplexer channel the sensor is on, 0-7
+ * @return int8_t The sensor's index, or -1 if it could not be added
+ */
+int8_t Adafruit_SCD30_Manager::addSensor(Adafruit_SCD30 *sensor,
+                                         Adafruit_I2CDevice *mux,
+                                         uint8_t channel) {
+  if ((_count >= SCD30_MANAGER_MAX_SENSORS) || (channel > 7)) {
+    return -1;
+  }
+
+  entry_t *entry = &_entries[_count];
+  entry->sensor = sensor;
+  entry->mux = mux;
+  entry->channel = channel;
+  entry->state = SENSOR_WAITING;
+  entry->next_check = millis();
+  entry->started_us = 0;
+  entry->frame = 0;
+  return _count++;
+}
+
+/**
+ * @brief Get the driver of a managed sensor
+ *
+ * @param index The sensor's index, as returned by `addSensor` or `poll`
+ * @return Adafruit_SCD30* The driver, or NULL if `index` is out of range
+ */
+Adafruit_SCD30 *Adafruit_SCD30_Manager::getSensor(uint8_t index) {
+  if (index >= _count) {
+    return NULL;
+  }
+  return _entries[index].sensor;
+}
+
+/**
+ * @brief Route the bus to a sensor, closing any other multiplexer so only one
+ * SCD30 answers at its fixed address. Call before using a sensor's driver
+ * directly.
+ *
+ * @param index The sensor's index
+ * @return true: success false: `index` is out of range or a multiplexer
+ * didn't respond
+ */
+bool Adafruit_SCD30_Manager::select(uint8_t index) {
+  if (index >= _count) {
+    return false;
+  }
+  entry_t *entry = &_entries[index];
+
+  if (_selected_mux && (_selected_mux != entry->mux)) {
+    uint8_t none = 0;
+    if (!_selected_mux->write(&none, 1)) {
+      return false;
+    }
+    _selected_mux = NULL;
+  }
+
+  if (entry->mux && ((_selected_mux != entry->mux) ||
+                     (_selected_channel != entry->channel))) {
+    uint8_t mask = 1 << entry->channel;
+    if (!entry->mux->write(&mask, 1)) {
+      return false;
+    }
+    _selected_mux = entry->mux;
+    _selected_channel = entry->channel;
+  }
+  return true;
+}
+
+/**
+ * @brief Advance every sensor's read cycle without blocking. Call as often as
+ * possible from `loop`.
+ *
+ * While one sensor waits out the datasheet gap between a command and its
+ * response, the others are serviced.
+ *
+ * @return int8_t The index of a sensor with a new sample in its `CO2`,
+ * `temperature` and `relative_humidity`, or -1 if there is none
+ */
+int8_t Adafruit_SCD30_Manager::poll(void) {
+  for (uint8_t n = 0; n < _count; n++) {
+    uint8_t index = (_next + n) % _count;
+    if (step(index)) {
+      // start after this sensor next time so every sensor gets a turn
+      _next = (index + 1) % _count;
+      return index;
+    }
+  }
+  return -1;
+}
+
+/**
+ * @brief Reset the sample count and bus time
+ */
+void Adafruit_SCD30_Manager::resetStats(void) {
+  _samples = 0;
+  _bus_us = 0;
+}
+
+/**
+ * @brief Advance one sensor's read cycle
+ *
+ * @param index The sensor's index
+ * @return true: a new sample was read
+ */
+bool Adafruit_SCD30_Manager::step(uint8_t index) {
+  entry_t *entry = &_entries[index];
+  Adafruit_SCD30 *sensor = entry->sensor;
+  uint32_t now = millis();
+
+  if (entry->state == SENSOR_WAITING) {
+    if ((int32_t)(now - entry->next_check) < 0) {
+      return false;
+    }
+  } else if ((uint32_t)(micros() - entry->started_us) < SCD30_READ_DELAY_US) {
+    // response isn't ready yet, don't switch the bus over for nothing
+    return false;
+  }
+
+  uint32_t start = micros();
+  bool sampled = false;
+
+  if (!select(index)) {
+    entry->state = SENSOR_WAITING;
+    entry->next_check = now + SCD30_MANAGER_RECHECK_MS;
+    _bus_us += micros() - start;
+    return false;
+  }
+
+  switch (entry->state) {
+  case SENSOR_WAITING:
+    if (!sensor->beginDataReady()) {
+      entry->next_check = now + SCD30_MANAGER_RECHECK_MS;
+      break;
+    }
+    // with an RDY pin the answer is there already, and a bus check just
+    // reports it pending
+    entry->state = SENSOR_CHECKING;
+    entry->started_us = micros();
+    // fall through
+  case SENSOR_CHECKING: {
+    bool ready = false;
+    if (sensor->pollDataReady(&ready) == SCD30_READ_PENDING) {
+      break;
+    }
+    if (ready && sensor->beginRead()) {
+      entry->state = SENSOR_READING;
+      entry->started_us = micros();
+    } else {
+      entry->state = SENSOR_WAITING;
+      entry->next_check = now + SCD30_MANAGER_RECHECK_MS;
+    }
+    break;
+  }
+
+  case SENSOR_READING: {
+    scd30_read_status_t status = sensor->pollRead();
+    if (status == SCD30_READ_PENDING) {
+      break;
+    }
+    entry->state = SENSOR_WAITING;
+    entry->next_check = now + SCD30_MANAGER_RECHECK_MS;
+    if (status != SCD30_READ_READY) {
+      break;
+    }
+    // only a measurement the frame clock hasn't seen before is a sample
+    scd30_timing_t timing;
+    sensor->getTiming(&timing);
+    if (timing.frame == entry->frame) {
+      break;
+    }
+    entry->frame = timing.frame;
+    // the next sample won't be ready for about a period
+    uint32_t period_ms = timing.period_us / 1000;
+    if (period_ms > 1000) {
+      entry->next_check = now + period_ms - 1000;
+    }
+    _samples++;
+    sampled = true;
+    break;
+  }
+  }
+
+  _bus_us += micros() - start;
+  return sampled;
+}
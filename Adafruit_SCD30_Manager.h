@@ -0,0 +1,84 @@
+/*!
+ *  @file Adafruit_SCD30_Manager.h
+ *
+ * 	Polls several Adafruit SCD30 CO2, Temperature, and Humidity sensors,
+ * 	optionally behind TCA9548A style I2C multiplexers, without blocking
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	 license (see license.txt)
+ */
+
+#ifndef _ADAFRUIT_SCD30_MANAGER_H
+#define _ADAFRUIT_SCD30_MANAGER_H
+
+#include "Adafruit_SCD30.h"
+
+#define SCD30_MANAGER_MAX_SENSORS 8 ///< Most sensors a manager can poll
+#define SCD30_MANAGER_RECHECK_MS                                               \
+  100 ///< Time between data ready checks once a sample is due
+
+/*!
+ *    @brief  Schedules reads across several SCD30s so that the write/read
+ *            gap of one sensor is spent servicing the others. Multiplexer
+ *            channels are switched before each transfer.
+ */
+class Adafruit_SCD30_Manager {
+public:
+  Adafruit_SCD30_Manager();
+
+  int8_t addSensor(Adafruit_SCD30 *sensor, Adafruit_I2CDevice *mux = NULL,
+                   uint8_t channel = 0);
+  bool select(uint8_t index);
+
+  int8_t poll(void);
+
+  /** @brief Get the number of sensors managed
+      @return The number of sensors added with `addSensor` */
+  uint8_t count(void) { return _count; }
+  Adafruit_SCD30 *getSensor(uint8_t index);
+
+  /** @brief Get the number of samples read by `poll`
+      @return The sample count since the last `resetStats` */
+  uint32_t getSampleCount(void) { return _samples; }
+  /** @brief Get the time `poll` spent talking to the sensors
+      @return Bus time in microseconds since the last `resetStats` */
+  uint32_t getBusTime(void) { return _bus_us; }
+  void resetStats(void);
+
+private:
+  /** Where a sensor is in its read cycle */
+  typedef enum {
+    SENSOR_WAITING,  ///< Waiting for the next sample to be due
+    SENSOR_CHECKING, ///< Data ready check in flight
+    SENSOR_READING,  ///< Measurement read in flight
+  } sensor_state_t;
+
+  /** A managed sensor and the multiplexer channel it sits behind */
+  typedef struct {
+    Adafruit_SCD30 *sensor;  ///< The sensor's driver
+    Adafruit_I2CDevice *mux; ///< The multiplexer, NULL if directly attached
+    uint8_t channel;         ///< The multiplexer channel
+    sensor_state_t state;    ///< Where the sensor is in its read cycle
+    uint32_t next_check;     ///< `millis()` when data ready is next checked
+    uint32_t started_us;     ///< `micros()` when the pending read was sent
+    uint32_t frame;          ///< Frame clock count of the last sample
+  } entry_t;
+
+  bool step(uint8_t index);
+
+  entry_t _entries[SCD30_MANAGER_MAX_SENSORS]; ///< The managed sensors
+  uint8_t _count = 0;                          ///< Number of sensors added
+  uint8_t _next = 0;                           ///< First sensor for `poll`
+
+  Adafruit_I2CDevice *_selected_mux = NULL; ///< Mux with an open channel
+  uint8_t _selected_channel = 0;            ///< The open channel
+
+  uint32_t _samples = 0; ///< Samples read since `resetStats`
+  uint32_t _bus_us = 0;  ///< Time spent in transfers since `resetStats`
+};
+
+#endif
@@ -0,0 +1,395 @@
+/*!
+ *  @file Adafruit_SCD30_Modbus.cpp
+ *
+ * 	Modbus RTU interface for the Adafruit SCD30 CO2, Temperature, and
+ * 	Humidity sensor library
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ * 	BSD (see license.txt)
+ */
+
+#include "Adafruit_SCD30_Modbus.h"
+#include "Adafruit_SCD30.h"
+
+#define MODBUS_READ_HOLDING_REGISTERS 0x03 ///< Function code to read
+#define MODBUS_WRITE_SINGLE_REGISTER 0x06  ///< Function code to write
+#define MODBUS_EXCEPTION 0x80              ///< Set in a function code on error
+#define MODBUS_NO_REGISTER 0xFFFF          ///< Command has no Modbus register
+
+/**
+ * @brief Construct a new Modbus transport
+ *
+ * @param serial The UART the sensor is connected to
+ * @param address The sensor's Modbus slave address
+ */
+Adafruit_SCD30_Modbus::Adafruit_SCD30_Modbus(Stream *serial, uint8_t address) {
+  _serial = serial;
+  _address = address;
+}
+
+/**
+ * @brief Get ready to talk to the sensor, discarding anything left in the
+ * receive buffer
+ *
+ * @return true: success false: no serial port was given
+ */
+bool Adafruit_SCD30_Modbus::begin(void) {
+  if (!_serial) {
+    return false;
+  }
+  while (_serial->available()) {
+    _serial->read();
+  }
+  _queued = false;
+  _expected = 0;
+  return true;
+}
+
+/**
+ * @brief Send a command that takes no argument. Over Modbus these are writes
+ * of 1 to the command's register
+ *
+ * @param command The I2C command code
+ * @return true: the sensor acknowledged the command false: failure
+ */
+bool Adafruit_SCD30_Modbus::write(uint16_t command) {
+  if ((command != SCD30_CMD_SOFT_RESET) &&
+      (command != SCD30_CMD_STOP_MEASUREMENTS)) {
+    _error = SCD30_ERROR_REJECTED;
+    return false;
+  }
+  return writeRegister(modbusRegister(command), 1);
+}
+
+/**
+ * @brief Send a command with an argument by writing the argument to the
+ * command's register
+ *
+ * @param command The I2C command code
+ * @param argument The value to write
+ * @return true: the sensor acknowledged the command false: failure
+ */
+bool Adafruit_SCD30_Modbus::write(uint16_t command, uint16_t argument) {
+  uint16_t reg = modbusRegister(command);
+  if (reg == MODBUS_NO_REGISTER) {
+    _error = SCD30_ERROR_REJECTED;
+    return false;
+  }
+  return writeRegister(reg, argument);
+}
+
+/**
+ * @brief Send a request to read `words` registers starting at the command's
+ * register
+ *
+ * @param command The I2C command code
+ * @param words The number of registers to read
+ * @return true: request sent false: failure
+ */
+bool Adafruit_SCD30_Modbus::request(uint16_t command, uint8_t words) {
+  uint16_t reg = modbusRegister(command);
+  if (reg == MODBUS_NO_REGISTER) {
+    _error = SCD30_ERROR_REJECTED;
+    return false;
+  }
+  return requestRegisters(reg, words);
+}
+
+/**
+ * @brief Collect the response to `request` if it has arrived
+ *
+ * @param words Where to store the register values
+ * @param count The number of registers requested
+ * @return scd30_read_status_t `SCD30_READ_PENDING` while the response is
+ * arriving, `SCD30_READ_READY` once `words` are filled or `SCD30_READ_ERROR`
+ * if the response was bad, an exception or timed out
+ */
+scd30_read_status_t Adafruit_SCD30_Modbus::poll(uint16_t *words,
+                                                uint8_t count) {
+  scd30_read_status_t status = receive();
+  if (status != SCD30_READ_READY) {
+    return status;
+  }
+  if ((_response[1] != MODBUS_READ_HOLDING_REGISTERS) ||
+      (_response[2] != 2 * count)) {
+    _error = SCD30_ERROR_BUS;
+    return SCD30_READ_ERROR;
+  }
+
+  for (uint8_t i = 0; i < count; i++) {
+    words[i] = (uint16_t)(_response[3 + 2 * i] << 8 | _response[4 + 2 * i]);
+  }
+  return SCD30_READ_READY;
+}
+
+/**
+ * @brief Read several registers. The settings registers, which sit next to
+ * each other, are read with a single request; the rest one at a time, so a
+ * request never spans the data ready, measurement or command registers
+ *
+ * @param commands The I2C commands to read the registers with
+ * @param values Where to store the register values
+ * @param count The number of registers to read
+ * @return true: every register was read false: failure
+ */
+bool Adafruit_SCD30_Modbus::readRegisters(const uint16_t *commands,
+                                          uint16_t *values, uint8_t count) {
+  uint16_t first = SCD30_MODBUS_LAST_SETTING;
+  uint16_t last = SCD30_MODBUS_FIRST_SETTING;
+  uint8_t settings = 0;
+
+  for (uint8_t i = 0; i < count; i++) {
+    uint16_t reg = modbusRegister(commands[i]);
+    if ((reg >= SCD30_MODBUS_FIRST_SETTING) &&
+        (reg <= SCD30_MODBUS_LAST_SETTING)) {
+      first = (reg < first) ? reg : first;
+      last = (reg > last) ? reg : last;
+      settings++;
+    }
+  }
+
+  uint16_t block[SCD30_MODBUS_LAST_SETTING - SCD30_MODBUS_FIRST_SETTING + 1];
+  if (settings > 1) {
+    uint8_t span = last - first + 1;
+    scd30_read_status_t status = SCD30_READ_ERROR;
+
+    if (requestRegisters(first, span)) {
+      do {
+        status = poll(block, span);
+      } while (status == SCD30_READ_PENDING);
+    }
+    if (status != SCD30_READ_READY) {
+      return false;
+    }
+  }
+
+  for (uint8_t i = 0; i < count; i++) {
+    uint16_t reg = modbusRegister(commands[i]);
+    if ((settings > 1) && (reg >= first) && (reg <= last)) {
+      values[i] = block[reg - first];
+    } else if (!Adafruit_SCD30_Transport::readRegisters(&commands[i],
+                                                        &values[i], 1)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * Performs a Modbus CRC16 calculation on the supplied values.
+ *
+ * @param data  Pointer to the data to use when calculating the CRC16.
+ * @param len   The number of bytes in 'data'.
+ *
+ * @return The computed CRC16 value, sent LSB first.
+ */
+uint16_t Adafruit_SCD30_Modbus::crc16(const uint8_t *data, uint8_t len) {
+  uint16_t crc = 0xFFFF;
+
+  while (len--) {
+    crc ^= *data++;
+    for (uint8_t i = 8; i; --i) {
+      crc = (crc & 0x0001) ? (crc >> 1) ^ 0xA001 : (crc >> 1);
+    }
+  }
+  return crc;
+}
+
+/**
+ * @brief Get the Modbus register matching an I2C command
+ *
+ * @param command The I2C command code
+ * @return uint16_t The register, or `MODBUS_NO_REGISTER`
+ */
+uint16_t Adafruit_SCD30_Modbus::modbusRegister(uint16_t command) {
+  switch (command) {
+  case SCD30_CMD_READ_REVISION:
+    return 0x0020;
+  case SCD30_CMD_SET_MEASUREMENT_INTERVAL:
+    return 0x0025;
+  case SCD30_CMD_GET_DATA_READY:
+    return 0x0027;
+  case SCD30_CMD_READ_MEASUREMENT:
+    return 0x0028;
+  case SCD30_CMD_SOFT_RESET:
+    return 0x0034;
+  case SCD30_CMD_CONTINUOUS_MEASUREMENT:
+    return 0x0036;
+  case SCD30_CMD_STOP_MEASUREMENTS:
+    return 0x0037;
+  case SCD30_CMD_SET_ALTITUDE_COMPENSATION:
+    return 0x0038;
+  case SCD30_CMD_SET_FORCED_RECALIBRATION_REF:
+    return 0x0039;
+  case SCD30_CMD_AUTOMATIC_SELF_CALIBRATION:
+    return 0x003A;
+  case SCD30_CMD_SET_TEMPERATURE_OFFSET:
+    return 0x003B;
+  default:
+    return MODBUS_NO_REGISTER;
+  }
+}
+
+/**
+ * @brief Build a request frame to send once the bus has been quiet for the
+ * gap Modbus requires between frames, and send it if it already has
+ *
+ * @param function The function code
+ * @param reg The first register
+ * @param value The register count for reads, or the value for writes
+ * @param expected The length of the response
+ */
+void Adafruit_SCD30_Modbus::queue(uint8_t function, uint16_t reg,
+                                  uint16_t value, uint8_t expected) {
+  _request[0] = _address;
+  _request[1] = function;
+  _request[2] = reg >> 8;
+  _request[3] = reg & 0xFF;
+  _request[4] = value >> 8;
+  _request[5] = value & 0xFF;
+  uint16_t crc = crc16(_request, 6);
+  _request[6] = crc & 0xFF;
+  _request[7] = crc >> 8;
+
+  _queued = true;
+  _expected = expected;
+  _received = 0;
+}
+
+/**
+ * @brief Send the queued request if the bus has been quiet long enough
+ *
+ * @return true: sent, or still waiting for the gap false: the UART did not
+ * take the frame
+ */
+bool Adafruit_SCD30_Modbus::transmit(void) {
+  if ((uint32_t)(micros() - _activity_us) < SCD30_MODBUS_FRAME_GAP_US) {
+    return true;
+  }
+  _queued = false;
+
+  // drop anything left over from an earlier, abandoned response
+  while (_serial->available()) {
+    _serial->read();
+  }
+
+  SCD30_STATS_ADD(_stats, transactions, 1);
+  if (_serial->write(_request, sizeof(_request)) != sizeof(_request)) {
+    _expected = 0;
+    _error = SCD30_ERROR_BUS;
+    return false;
+  }
+  SCD30_STATS_ADD(_stats, bytes_written, sizeof(_request));
+  _sent_ms = millis();
+  _activity_us = micros();
+  return true;
+}
+
+/**
+ * @brief Write a single register and wait for the sensor to echo it back.
+ * Blocks for the frame gap, if the bus was busy, and the round trip.
+ *
+ * @param reg The register to write
+ * @param value The value to write
+ * @return true: the sensor acknowledged the write false: failure
+ */
+bool Adafruit_SCD30_Modbus::writeRegister(uint16_t reg, uint16_t value) {
+  queue(MODBUS_WRITE_SINGLE_REGISTER, reg, value, 8);
+
+  scd30_read_status_t status;
+  do {
+    status = receive();
+  } while (status == SCD30_READ_PENDING);
+
+  if (status != SCD30_READ_READY) {
+    return false;
+  }
+
+  // a successful write is echoed back unchanged
+  if ((_response[1] != MODBUS_WRITE_SINGLE_REGISTER) ||
+      (_response[2] != (reg >> 8)) || (_response[3] != (reg & 0xFF)) ||
+      (_response[4] != (value >> 8)) || (_response[5] != (value & 0xFF))) {
+    _error = SCD30_ERROR_BUS;
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Send a request to read consecutive registers, without waiting for
+ * the response or the frame gap
+ *
+ * @param reg The first register
+ * @param count The number of registers, up to `SCD30_MODBUS_MAX_REGISTERS`
+ * @return true: request sent or queued false: failure
+ */
+bool Adafruit_SCD30_Modbus::requestRegisters(uint16_t reg, uint8_t count) {
+  if ((count == 0) || (count > SCD30_MODBUS_MAX_REGISTERS)) {
+    _error = SCD30_ERROR_REJECTED;
+    return false;
+  }
+  queue(MODBUS_READ_HOLDING_REGISTERS, reg, count, 5 + 2 * count);
+  return transmit();
+}
+
+/**
+ * @brief Send the request if it is still queued, then gather the bytes of the
+ * response that have arrived and check the frame once it is complete
+ *
+ * @return scd30_read_status_t The state of the response
+ */
+scd30_read_status_t Adafruit_SCD30_Modbus::receive(void) {
+  if (_expected == 0) {
+    return SCD30_READ_IDLE;
+  }
+  if (_queued) {
+    if (!transmit()) {
+      return SCD30_READ_ERROR;
+    }
+    if (_queued) {
+      return SCD30_READ_PENDING;
+    }
+  }
+
+  while (_serial->available() && (_received < _expected)) {
+    _response[_received++] = _serial->read();
+    _activity_us = micros();
+    SCD30_STATS_ADD(_stats, bytes_read, 1);
+
+    // exception responses are shorter: address, function, code and CRC
+    if ((_received == 2) && (_response[1] & MODBUS_EXCEPTION)) {
+      _expected = 5;
+    }
+  }
+
+  if (_received < _expected) {
+    if ((uint32_t)(millis() - _sent_ms) > SCD30_MODBUS_TIMEOUT_MS) {
+      _expected = 0;
+      _error = SCD30_ERROR_BUS;
+      SCD30_STATS_ADD(_stats, nacks, 1);
+      return SCD30_READ_ERROR;
+    }
+    return SCD30_READ_PENDING;
+  }
+
+  uint8_t len = _expected;
+  _expected = 0;
+
+  uint16_t crc = _response[len - 2] | (_response[len - 1] << 8);
+  if (crc16(_response, len - 2) != crc) {
+    _error = SCD30_ERROR_CRC;
+    SCD30_STATS_ADD(_stats, crc_errors[0], 1);
+    return SCD30_READ_ERROR;
+  }
+  if ((_response[0] != _address) || (_response[1] & MODBUS_EXCEPTION)) {
+    _error = (_response[1] & MODBUS_EXCEPTION) ? SCD30_ERROR_REJECTED
+                                               : SCD30_ERROR_BUS;
+    SCD30_STATS_ADD(_stats, nacks, 1);
+    return SCD30_READ_ERROR;
+  }
+  _error = SCD30_ERROR_NONE;
+  return SCD30_READ_READY;
+}
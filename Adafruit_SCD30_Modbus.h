@@ -0,0 +1,77 @@
+/*!
+ *  @file Adafruit_SCD30_Modbus.h
+ *
+ * 	Modbus RTU interface for the Adafruit SCD30 CO2, Temperature, and
+ * 	Humidity sensor library
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	 license (see license.txt)
+ */
+
+#ifndef _ADAFRUIT_SCD30_MODBUS_H
+#define _ADAFRUIT_SCD30_MODBUS_H
+
+#include "Adafruit_SCD30_Transport.h"
+
+#define SCD30_MODBUS_ADDR_DEFAULT 0x61 ///< SCD30 Modbus slave address
+#define SCD30_MODBUS_BAUD 19200        ///< Baud rate the SCD30 uses
+#define SCD30_MODBUS_TIMEOUT_MS 100    ///< Longest wait for a response
+#define SCD30_MODBUS_FRAME_GAP_US                                              \
+  2000 ///< Silence between frames, 3.5 characters at 19200 baud
+#define SCD30_MODBUS_MAX_REGISTERS                                             \
+  6 ///< Most registers read in one request, enough for a measurement
+#define SCD30_MODBUS_FIRST_SETTING                                             \
+  0x0038 ///< Start of the settings registers that can be read together
+#define SCD30_MODBUS_LAST_SETTING 0x003B ///< End of those registers
+
+/*!
+ *    @brief  Talks to the sensor with Modbus RTU over a UART, which allows
+ *            much longer cables than I2C. Start the serial port at
+ *            `SCD30_MODBUS_BAUD`, 8N1 before using it.
+ *
+ *            Read requests are queued until the bus has been quiet for
+ *            `SCD30_MODBUS_FRAME_GAP_US`, and sent by `poll`, so `request`
+ *            never waits. Commands wait for the gap and for the sensor to
+ *            echo them, up to `SCD30_MODBUS_TIMEOUT_MS`.
+ */
+class Adafruit_SCD30_Modbus : public Adafruit_SCD30_Transport {
+public:
+  Adafruit_SCD30_Modbus(Stream *serial,
+                        uint8_t address = SCD30_MODBUS_ADDR_DEFAULT);
+
+  bool begin(void);
+  bool write(uint16_t command);
+  bool write(uint16_t command, uint16_t argument);
+  bool request(uint16_t command, uint8_t words);
+  scd30_read_status_t poll(uint16_t *words, uint8_t count);
+  bool readRegisters(const uint16_t *commands, uint16_t *values,
+                     uint8_t count);
+
+  static uint16_t crc16(const uint8_t *data, uint8_t len);
+
+private:
+  static uint16_t modbusRegister(uint16_t command);
+  void queue(uint8_t function, uint16_t reg, uint16_t value, uint8_t expected);
+  bool transmit(void);
+  bool writeRegister(uint16_t reg, uint16_t value);
+  bool requestRegisters(uint16_t reg, uint8_t count);
+  scd30_read_status_t receive(void);
+
+  Stream *_serial;  ///< The UART the sensor is on
+  uint8_t _address; ///< The sensor's slave address
+
+  uint8_t _request[8];  ///< Request frame waiting for the bus to be quiet
+  bool _queued = false; ///< True until `_request` has been sent
+  /** Largest response: address, function, byte count, data and CRC */
+  uint8_t _response[5 + 2 * SCD30_MODBUS_MAX_REGISTERS];
+  uint8_t _expected = 0;     ///< Length of the response being received
+  uint8_t _received = 0;     ///< Bytes of the response received so far
+  uint32_t _sent_ms = 0;     ///< `millis()` when the request was sent
+  uint32_t _activity_us = 0; ///< `micros()` of the last byte on the bus
+};
+
+#endif
@@ -0,0 +1,551 @@
+/*!
+ *  @file Adafruit_SCD30_Serialize.cpp
+ *
+ * 	Line protocol, JSON and CBOR serializers for samples from the Adafruit
+ * 	SCD30 CO2, Temperature, and Humidity sensor library
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ * 	BSD (see license.txt)
+ */
+
+#include "Adafruit_SCD30_Serialize.h"
+#include <string.h>
+
+#define FIELD_GROUP_SIZE 6 ///< Fields in the readings, config and stats
+
+#define CBOR_UNSIGNED 0 ///< CBOR major type of unsigned integers
+#define CBOR_NEGATIVE 1 ///< CBOR major type of negative integers
+#define CBOR_TEXT 3     ///< CBOR major type of text strings
+#define CBOR_ARRAY 4    ///< CBOR major type of arrays
+#define CBOR_MAP 5      ///< CBOR major type of maps
+#define CBOR_TAG 6      ///< CBOR major type of tags
+#define CBOR_DECIMAL 4  ///< Tag of a decimal fraction: [exponent, mantissa]
+#define CBOR_FALSE 0xF4 ///< CBOR false
+#define CBOR_TRUE 0xF5  ///< CBOR true
+
+/**
+ * @brief
+ *
+ * How a field's value is written.
+ */
+typedef enum {
+  FIELD_UNSIGNED, ///< A count or setting
+  FIELD_FIXED,    ///< A signed fixed point value with `decimals` decimals
+  FIELD_BOOL,     ///< Zero or not
+} field_kind_t;
+
+/**
+ * @brief
+ *
+ * One named value of a record, the same in every format.
+ */
+typedef struct {
+  const char *name; ///< Key of the field
+  uint8_t kind;     ///< A `field_kind_t`
+  uint8_t decimals; ///< Decimal places of a fixed point value
+  uint32_t value;   ///< The value, an `int32_t` for fixed point
+} field_t;
+
+/**
+ * @brief
+ *
+ * A text buffer being written, that remembers running out of space.
+ */
+typedef struct {
+  char *position; ///< Where the next character goes
+  char *end;      ///< Last character of the buffer, kept for the NUL
+  bool overflow;  ///< True once something did not fit
+} text_t;
+
+/**
+ * @brief
+ *
+ * A binary buffer being written, that remembers running out of space.
+ */
+typedef struct {
+  uint8_t *position; ///< Where the next byte goes
+  uint8_t *end;      ///< One past the end of the buffer
+  bool overflow;     ///< True once something did not fit
+} binary_t;
+
+/** Powers of ten that fit a `uint32_t`, largest first */
+static const uint32_t powers_of_ten[] = {
+    1000000000UL, 100000000UL, 10000000UL, 1000000UL, 100000UL,
+    10000UL,      1000UL,      100UL,      10UL};
+
+/**
+ * @brief Fill the fields of the readings and when they were taken
+ *
+ * @param record The record
+ * @param fields Where to store `FIELD_GROUP_SIZE` fields
+ */
+static void sample_fields(const scd30_record_t *record, field_t *fields) {
+  field_t sample[FIELD_GROUP_SIZE] = {
+      {"co2", FIELD_FIXED, 1, record->sample.co2},
+      {"temperature", FIELD_FIXED, 2,
+       (uint32_t)(int32_t)record->sample.temperature},
+      {"humidity", FIELD_FIXED, 2, record->sample.humidity},
+      {"timestamp", FIELD_UNSIGNED, 0, record->timestamp},
+      {"sequence", FIELD_UNSIGNED, 0, record->sequence},
+      {"frame", FIELD_UNSIGNED, 0, record->frame},
+  };
+  memcpy(fields, sample, sizeof(sample));
+}
+
+/**
+ * @brief Fill the fields of the sensor's settings
+ *
+ * @param config The settings
+ * @param fields Where to store `FIELD_GROUP_SIZE` fields
+ */
+static void config_fields(const scd30_config_t *config, field_t *fields) {
+  field_t settings[FIELD_GROUP_SIZE] = {
+      {"measurement_interval", FIELD_UNSIGNED, 0,
+       config->measurement_interval},
+      {"ambient_pressure", FIELD_UNSIGNED, 0, config->ambient_pressure},
+      {"altitude_offset", FIELD_UNSIGNED, 0, config->altitude_offset},
+      {"temperature_offset", FIELD_FIXED, 2, config->temperature_offset},
+      {"forced_calibration_reference", FIELD_UNSIGNED, 0,
+       config->forced_calibration_reference},
+      {"self_calibration", FIELD_BOOL, 0, config->self_calibration},
+  };
+  memcpy(fields, settings, sizeof(settings));
+}
+
+/**
+ * @brief Fill the fields of the bus counters
+ *
+ * @param stats The counters
+ * @param fields Where to store `FIELD_GROUP_SIZE` fields
+ */
+static void stats_fields(const scd30_stats_t *stats, field_t *fields) {
+  uint32_t crc_errors = 0;
+  for (uint8_t i = 0; i < SCD30_MAX_RESPONSE_WORDS; i++) {
+    crc_errors += stats->crc_errors[i];
+  }
+
+  field_t counters[FIELD_GROUP_SIZE] = {
+      {"transactions", FIELD_UNSIGNED, 0, stats->transactions},
+      {"bytes_written", FIELD_UNSIGNED, 0, stats->bytes_written},
+      {"bytes_read", FIELD_UNSIGNED, 0, stats->bytes_read},
+      {"nacks", FIELD_UNSIGNED, 0, stats->nacks},
+      {"retries", FIELD_UNSIGNED, 0, stats->retries},
+      {"crc_errors", FIELD_UNSIGNED, 0, crc_errors},
+  };
+  memcpy(fields, counters, sizeof(counters));
+}
+
+/**
+ * @brief Write the decimal digits of a number
+ *
+ * Counts down by powers of ten instead of dividing, which 8 bit MCUs have
+ * to do in software.
+ *
+ * @param value The number
+ * @param digits Where to store the digits, room for 10
+ * @return The number of digits
+ */
+static uint8_t render_unsigned(uint32_t value, char *digits) {
+  uint8_t count = 0;
+  for (uint8_t i = 0; i < sizeof(powers_of_ten) / sizeof(uint32_t); i++) {
+    uint32_t power = powers_of_ten[i];
+    char digit = '0';
+    while (value >= power) {
+      value -= power;
+      digit++;
+    }
+    if (count || (digit != '0')) {
+      digits[count++] = digit;
+    }
+  }
+  digits[count++] = '0' + value;
+  return count;
+}
+
+/**
+ * @brief Append characters to a text buffer
+ *
+ * @param text The buffer
+ * @param characters The characters
+ * @param length The number of characters
+ */
+static void put_text(text_t *text, const char *characters, size_t length) {
+  if (text->overflow || ((size_t)(text->end - text->position) < length)) {
+    text->overflow = true;
+    return;
+  }
+  memcpy(text->position, characters, length);
+  text->position += length;
+}
+
+/**
+ * @brief Append a NUL terminated string to a text buffer
+ *
+ * @param text The buffer
+ * @param string The string
+ */
+static void put_string(text_t *text, const char *string) {
+  put_text(text, string, strlen(string));
+}
+
+/**
+ * @brief Append a number to a text buffer
+ *
+ * @param text The buffer
+ * @param value The number
+ */
+static void put_unsigned(text_t *text, uint32_t value) {
+  char digits[10];
+  put_text(text, digits, render_unsigned(value, digits));
+}
+
+/**
+ * @brief Append a fixed point number to a text buffer, with all its decimals
+ *
+ * @param text The buffer
+ * @param value The number in units of 10^-`decimals`
+ * @param decimals The number of decimals, 1 or 2
+ */
+static void put_fixed(text_t *text, int32_t value, uint8_t decimals) {
+  // room for a sign, 10 digits, a point and leading zeros
+  char characters[14];
+  uint8_t length = 0;
+  uint32_t magnitude = value;
+  if (value < 0) {
+    characters[length++] = '-';
+    magnitude = -magnitude;
+  }
+
+  char digits[10];
+  uint8_t count = render_unsigned(magnitude, digits);
+  uint8_t whole = (count > decimals) ? count - decimals : 0;
+  if (!whole) {
+    characters[length++] = '0';
+  }
+  memcpy(&characters[length], digits, whole);
+  length += whole;
+  characters[length++] = '.';
+  for (uint8_t i = count; i < decimals; i++) {
+    characters[length++] = '0';
+  }
+  memcpy(&characters[length], &digits[whole], count - whole);
+  length += count - whole;
+
+  put_text(text, characters, length);
+}
+
+/**
+ * @brief Append a field's value to a text buffer
+ *
+ * @param text The buffer
+ * @param field The field
+ * @param integer_suffix Appended to integers: line protocol marks them with
+ * an `i`, or they are taken as floats
+ */
+static void put_value(text_t *text, const field_t *field,
+                      const char *integer_suffix) {
+  switch (field->kind) {
+  case FIELD_FIXED:
+    put_fixed(text, (int32_t)field->value, field->decimals);
+    break;
+  case FIELD_BOOL:
+    put_string(text, field->value ? "true" : "false");
+    break;
+  default:
+    put_unsigned(text, field->value);
+    put_string(text, integer_suffix);
+    break;
+  }
+}
+
+/**
+ * @brief Start writing text to a buffer
+ *
+ * @param text The writer to set up
+ * @param buffer The buffer
+ * @param size The size of the buffer, including room for a NUL
+ */
+static void text_begin(text_t *text, char *buffer, size_t size) {
+  text->position = buffer;
+  text->end = size ? buffer + size - 1 : buffer;
+  text->overflow = !size;
+}
+
+/**
+ * @brief Terminate the text written to a buffer
+ *
+ * @param text The writer
+ * @param buffer The buffer
+ * @param size The size of the buffer
+ * @return The length of the text, 0 if it did not fit
+ */
+static size_t text_end(text_t *text, char *buffer, size_t size) {
+  if (!size) {
+    return 0;
+  }
+  if (text->overflow) {
+    buffer[0] = '\0';
+    return 0;
+  }
+  *text->position = '\0';
+  return text->position - buffer;
+}
+
+/**
+ * @brief Format a record as an InfluxDB line protocol line, without a
+ * trailing newline
+ *
+ * The readings, settings and counters are all fields of one point; integers
+ * carry the `i` suffix, fixed point values are written as decimals.
+ *
+ * @param record The record
+ * @param measurement The measurement name, which must not contain spaces,
+ * commas or equals signs
+ * @param tags Tags to add after the measurement, for example
+ * `"room=kitchen"`, or NULL for none
+ * @param epoch_s Unix time of the point in seconds, written in the default
+ * nanosecond precision, or 0 to let the server stamp it
+ * @param buffer Where to write the line, `SCD30_LINE_MAX_SIZE` plus the
+ * lengths of `measurement` and `tags` always fits
+ * @param size The size of `buffer`
+ * @return The length of the line, 0 if it did not fit
+ */
+size_t scd30_format_line(const scd30_record_t *record, const char *measurement,
+                         const char *tags, uint32_t epoch_s, char *buffer,
+                         size_t size) {
+  field_t fields[3 * FIELD_GROUP_SIZE];
+  uint8_t count = FIELD_GROUP_SIZE;
+  sample_fields(record, fields);
+  if (record->config) {
+    config_fields(record->config, &fields[count]);
+    count += FIELD_GROUP_SIZE;
+  }
+  if (record->stats) {
+    stats_fields(record->stats, &fields[count]);
+    count += FIELD_GROUP_SIZE;
+  }
+
+  text_t text;
+  text_begin(&text, buffer, size);
+  put_string(&text, measurement);
+  if (tags && *tags) {
+    put_text(&text, ",", 1);
+    put_string(&text, tags);
+  }
+  for (uint8_t i = 0; i < count; i++) {
+    put_text(&text, i ? "," : " ", 1);
+    put_string(&text, fields[i].name);
+    put_text(&text, "=", 1);
+    put_value(&text, &fields[i], "i");
+  }
+  if (epoch_s) {
+    put_text(&text, " ", 1);
+    put_unsigned(&text, epoch_s);
+    put_text(&text, "000000000", 9);
+  }
+  return text_end(&text, buffer, size);
+}
+
+/**
+ * @brief Append a JSON object of fields to a text buffer
+ *
+ * @param text The buffer
+ * @param fields The fields
+ * @param count The number of fields
+ */
+static void put_object(text_t *text, const field_t *fields, uint8_t count) {
+  for (uint8_t i = 0; i < count; i++) {
+    put_text(text, i ? ",\"" : "\"", i ? 2 : 1);
+    put_string(text, fields[i].name);
+    put_text(text, "\":", 2);
+    put_value(text, &fields[i], "");
+  }
+}
+
+/**
+ * @brief Format a record as compact JSON, with the settings and counters as
+ * nested `"config"` and `"stats"` objects
+ *
+ * @param record The record
+ * @param buffer Where to write the JSON, `SCD30_JSON_MAX_SIZE` always fits
+ * @param size The size of `buffer`
+ * @return The length of the JSON, 0 if it did not fit
+ */
+size_t scd30_format_json(const scd30_record_t *record, char *buffer,
+                         size_t size) {
+  field_t fields[FIELD_GROUP_SIZE];
+  text_t text;
+  text_begin(&text, buffer, size);
+
+  put_text(&text, "{", 1);
+  sample_fields(record, fields);
+  put_object(&text, fields, FIELD_GROUP_SIZE);
+  if (record->config) {
+    put_string(&text, ",\"config\":{");
+    config_fields(record->config, fields);
+    put_object(&text, fields, FIELD_GROUP_SIZE);
+    put_text(&text, "}", 1);
+  }
+  if (record->stats) {
+    put_string(&text, ",\"stats\":{");
+    stats_fields(record->stats, fields);
+    put_object(&text, fields, FIELD_GROUP_SIZE);
+    put_text(&text, "}", 1);
+  }
+  put_text(&text, "}", 1);
+  return text_end(&text, buffer, size);
+}
+
+/**
+ * @brief Append bytes to a binary buffer
+ *
+ * @param binary The buffer
+ * @param bytes The bytes
+ * @param length The number of bytes
+ */
+static void put_bytes(binary_t *binary, const void *bytes, size_t length) {
+  if (binary->overflow ||
+      ((size_t)(binary->end - binary->position) < length)) {
+    binary->overflow = true;
+    return;
+  }
+  memcpy(binary->position, bytes, length);
+  binary->position += length;
+}
+
+/**
+ * @brief Append a CBOR item head in its shortest form
+ *
+ * @param binary The buffer
+ * @param major The major type
+ * @param argument The head's argument: a value, length or tag
+ */
+static void put_head(binary_t *binary, uint8_t major, uint32_t argument) {
+  uint8_t head[5];
+  uint8_t length;
+  major <<= 5;
+  if (argument < 24) {
+    head[0] = major | argument;
+    length = 1;
+  } else if (argument <= 0xFF) {
+    head[0] = major | 24;
+    head[1] = argument;
+    length = 2;
+  } else if (argument <= 0xFFFF) {
+    head[0] = major | 25;
+    head[1] = argument >> 8;
+    head[2] = argument;
+    length = 3;
+  } else {
+    head[0] = major | 26;
+    head[1] = argument >> 24;
+    head[2] = argument >> 16;
+    head[3] = argument >> 8;
+    head[4] = argument;
+    length = 5;
+  }
+  put_bytes(binary, head, length);
+}
+
+/**
+ * @brief Append a CBOR text string
+ *
+ * @param binary The buffer
+ * @param string The NUL terminated string
+ */
+static void put_cbor_text(binary_t *binary, const char *string) {
+  size_t length = strlen(string);
+  put_head(binary, CBOR_TEXT, length);
+  put_bytes(binary, string, length);
+}
+
+/**
+ * @brief Append the keys and values of fields as CBOR map entries. Fixed
+ * point values are decimal fractions, which keep them exact without floating
+ * point.
+ *
+ * @param binary The buffer
+ * @param fields The fields
+ * @param count The number of fields
+ */
+static void put_entries(binary_t *binary, const field_t *fields,
+                        uint8_t count) {
+  for (uint8_t i = 0; i < count; i++) {
+    put_cbor_text(binary, fields[i].name);
+    switch (fields[i].kind) {
+    case FIELD_FIXED: {
+      int32_t mantissa = (int32_t)fields[i].value;
+      put_head(binary, CBOR_TAG, CBOR_DECIMAL);
+      put_head(binary, CBOR_ARRAY, 2);
+      put_head(binary, CBOR_NEGATIVE, fields[i].decimals - 1);
+      if (mantissa < 0) {
+        put_head(binary, CBOR_NEGATIVE, -(mantissa + 1));
+      } else {
+        put_head(binary, CBOR_UNSIGNED, mantissa);
+      }
+      break;
+    }
+    case FIELD_BOOL: {
+      uint8_t value = fields[i].value ? CBOR_TRUE : CBOR_FALSE;
+      put_bytes(binary, &value, 1);
+      break;
+    }
+    default:
+      put_head(binary, CBOR_UNSIGNED, fields[i].value);
+      break;
+    }
+  }
+}
+
+/**
+ * @brief Append a nested CBOR map of fields under a key
+ *
+ * @param binary The buffer
+ * @param key The key of the map
+ * @param fields The fields
+ * @param count The number of fields
+ */
+static void put_map(binary_t *binary, const char *key, const field_t *fields,
+                    uint8_t count) {
+  put_cbor_text(binary, key);
+  put_head(binary, CBOR_MAP, count);
+  put_entries(binary, fields, count);
+}
+
+/**
+ * @brief Encode a record as a CBOR map, with the settings and counters as
+ * nested `"config"` and `"stats"` maps
+ *
+ * @param record The record
+ * @param buffer Where to write the CBOR, `SCD30_CBOR_MAX_SIZE` always fits
+ * @param size The size of `buffer`
+ * @return The number of bytes written, 0 if the record did not fit
+ */
+size_t scd30_format_cbor(const scd30_record_t *record, uint8_t *buffer,
+                         size_t size) {
+  field_t fields[FIELD_GROUP_SIZE];
+  binary_t binary = {buffer, buffer + size, false};
+
+  // the readings' fields, then the nested maps
+  uint8_t entries = FIELD_GROUP_SIZE + (record->config ? 1 : 0) +
+                    (record->stats ? 1 : 0);
+  put_head(&binary, CBOR_MAP, entries);
+  sample_fields(record, fields);
+  put_entries(&binary, fields, FIELD_GROUP_SIZE);
+  if (record->config) {
+    config_fields(record->config, fields);
+    put_map(&binary, "config", fields, FIELD_GROUP_SIZE);
+  }
+  if (record->stats) {
+    stats_fields(record->stats, fields);
+    put_map(&binary, "stats", fields, FIELD_GROUP_SIZE);
+  }
+
+  if (binary.overflow) {
+    return 0;
+  }
+  return binary.position - buffer;
+}
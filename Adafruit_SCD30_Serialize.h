@@ -0,0 +1,53 @@
+/*!
+ *  @file Adafruit_SCD30_Serialize.h
+ *
+ * 	Line protocol, JSON and CBOR serializers for samples from the Adafruit
+ * 	SCD30 CO2, Temperature, and Humidity sensor library. Needs nothing from
+ * 	the Arduino core or the heap, and formats numbers with integer math only.
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	 license (see license.txt)
+ */
+
+#ifndef _ADAFRUIT_SCD30_SERIALIZE_H
+#define _ADAFRUIT_SCD30_SERIALIZE_H
+
+#include "Adafruit_SCD30_Compact.h"
+#include "Adafruit_SCD30_Driver.h"
+#include "Adafruit_SCD30_Stats.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#define SCD30_LINE_MAX_SIZE                                                    \
+  427 ///< Largest line protocol record and its NUL, less measurement and tags
+#define SCD30_JSON_MAX_SIZE 451 ///< Largest JSON record and its NUL
+#define SCD30_CBOR_MAX_SIZE 333 ///< Largest CBOR record
+
+/**
+ * @brief
+ *
+ * A sample and what to send along with it, for the `scd30_format_*`
+ * functions.
+ */
+typedef struct {
+  scd30_compact_sample_t sample; ///< The readings, in fixed point
+  uint32_t timestamp;            ///< `millis()` when the sensor measured it
+  uint32_t sequence;             ///< Number of the sample
+  uint32_t frame;                ///< Number of the sensor's measurement
+  const scd30_config_t *config;  ///< Settings to include, NULL for none
+  const scd30_stats_t *stats;    ///< Bus counters to include, NULL for none
+} scd30_record_t;
+
+size_t scd30_format_line(const scd30_record_t *record, const char *measurement,
+                         const char *tags, uint32_t epoch_s, char *buffer,
+                         size_t size);
+size_t scd30_format_json(const scd30_record_t *record, char *buffer,
+                         size_t size);
+size_t scd30_format_cbor(const scd30_record_t *record, uint8_t *buffer,
+                         size_t size);
+
+#endif
@@ -0,0 +1,89 @@
+/*!
+ *  @file Adafruit_SCD30_Stats.cpp
+ *
+ * 	Bus health counters for the Adafruit SCD30 CO2, Temperature, and
+ * 	Humidity sensor library
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ * 	BSD (see license.txt)
+ */
+
+#include "Adafruit_SCD30_Stats.h"
+#include <string.h>
+
+/**
+ * @brief Zero every counter
+ *
+ * @param stats The counters to clear
+ */
+void scd30_stats_clear(scd30_stats_t *stats) {
+  memset(stats, 0, sizeof(*stats));
+  for (uint8_t i = 0; i < SCD30_STATS_COMMAND_COUNT; i++) {
+    stats->latency[i].min_us = UINT32_MAX;
+  }
+}
+
+/**
+ * @brief Get the latency slot for a command
+ *
+ * @param command The I2C command code
+ * @return int8_t The `scd30_stats_command_t`, or -1 if not tracked
+ */
+static int8_t command_index(uint16_t command) {
+  switch (command) {
+  case SCD30_CMD_READ_MEASUREMENT:
+    return SCD30_STATS_READ_MEASUREMENT;
+  case SCD30_CMD_GET_DATA_READY:
+    return SCD30_STATS_DATA_READY;
+  case SCD30_CMD_CONTINUOUS_MEASUREMENT:
+    return SCD30_STATS_START_MEASUREMENT;
+  case SCD30_CMD_STOP_MEASUREMENTS:
+    return SCD30_STATS_STOP_MEASUREMENT;
+  case SCD30_CMD_SET_MEASUREMENT_INTERVAL:
+    return SCD30_STATS_INTERVAL;
+  case SCD30_CMD_AUTOMATIC_SELF_CALIBRATION:
+    return SCD30_STATS_SELF_CALIBRATION;
+  case SCD30_CMD_SET_FORCED_RECALIBRATION_REF:
+    return SCD30_STATS_FORCED_RECALIBRATION;
+  case SCD30_CMD_SET_TEMPERATURE_OFFSET:
+    return SCD30_STATS_TEMPERATURE_OFFSET;
+  case SCD30_CMD_SET_ALTITUDE_COMPENSATION:
+    return SCD30_STATS_ALTITUDE;
+  case SCD30_CMD_SOFT_RESET:
+    return SCD30_STATS_SOFT_RESET;
+  case SCD30_CMD_READ_REVISION:
+    return SCD30_STATS_REVISION;
+  default:
+    return -1;
+  }
+}
+
+/**
+ * @brief Record the latency of a successful transaction
+ *
+ * @param stats The counters to update
+ * @param command The I2C command code of the transaction
+ * @param latency_us The transaction's latency in microseconds
+ */
+void scd30_stats_add_latency(scd30_stats_t *stats, uint16_t command,
+                             uint32_t latency_us) {
+  int8_t index = command_index(command);
+  if (index < 0) {
+    return;
+  }
+
+  scd30_latency_stats_t *latency = &stats->latency[index];
+  // the first latency sets the min, so zeroed counters work without a
+  // `scd30_stats_clear`
+  latency->count++;
+  latency->total_us += latency_us;
+  if ((latency->count == 1) || (latency_us < latency->min_us)) {
+    latency->min_us = latency_us;
+  }
+  if (latency_us > latency->max_us) {
+    latency->max_us = latency_us;
+  }
+}
@@ -0,0 +1,92 @@
+/*!
+ *  @file Adafruit_SCD30_Stats.h
+ *
+ * 	Bus health counters for the Adafruit SCD30 CO2, Temperature, and
+ * 	Humidity sensor library. Define SCD30_NO_STATS to compile the counting
+ * 	out of the driver and transports.
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	 license (see license.txt)
+ */
+
+#ifndef _ADAFRUIT_SCD30_STATS_H
+#define _ADAFRUIT_SCD30_STATS_H
+
+#include "Adafruit_SCD30_Commands.h"
+
+#ifndef SCD30_NO_STATS
+/** Add `n` to a counter of a `scd30_stats_t`, if one is attached */
+#define SCD30_STATS_ADD(stats, field, n)                                       \
+  do {                                                                         \
+    if (stats) {                                                               \
+      (stats)->field += (n);                                                   \
+    }                                                                          \
+  } while (0)
+#else
+/** Counting is compiled out */
+#define SCD30_STATS_ADD(stats, field, n)                                       \
+  do {                                                                         \
+  } while (0)
+#endif
+
+/**
+ * @brief
+ *
+ * Commands that latency is tracked for, indexes into `scd30_stats_t::latency`.
+ */
+typedef enum {
+  SCD30_STATS_READ_MEASUREMENT,     ///< Read measurement
+  SCD30_STATS_DATA_READY,           ///< Get data ready status
+  SCD30_STATS_START_MEASUREMENT,    ///< Start continuous measurement
+  SCD30_STATS_STOP_MEASUREMENT,     ///< Stop continuous measurement
+  SCD30_STATS_INTERVAL,             ///< Get or set measurement interval
+  SCD30_STATS_SELF_CALIBRATION,     ///< Get or set self calibration
+  SCD30_STATS_FORCED_RECALIBRATION, ///< Get or set forced recalibration
+  SCD30_STATS_TEMPERATURE_OFFSET,   ///< Get or set temperature offset
+  SCD30_STATS_ALTITUDE,             ///< Get or set altitude compensation
+  SCD30_STATS_SOFT_RESET,           ///< Soft reset
+  SCD30_STATS_REVISION,             ///< Read firmware revision
+  SCD30_STATS_COMMAND_COUNT,        ///< Number of commands tracked
+} scd30_stats_command_t;
+
+/**
+ * @brief
+ *
+ * Latency of the transactions for one command: from sending the command to
+ * collecting the response for reads, the time to send it for writes.
+ */
+typedef struct {
+  uint32_t count;    ///< Successful transactions
+  uint32_t total_us; ///< Sum of their latencies, divide by `count` for mean
+  uint32_t min_us;   ///< Shortest latency, once `count` is not 0
+  uint32_t max_us;   ///< Longest latency
+} scd30_latency_stats_t;
+
+/**
+ * @brief
+ *
+ * Counters of bus activity and errors, attached with
+ * `Adafruit_SCD30::setStats`.
+ */
+typedef struct {
+  uint32_t transactions;  ///< Frames sent to the sensor
+  uint32_t bytes_written; ///< Bytes sent to the sensor
+  uint32_t bytes_read;    ///< Bytes received from the sensor
+  uint32_t nacks;         ///< Transfers not acknowledged, or not answered
+  uint32_t retries;       ///< Transactions repeated after a failure
+  /** Bad CRCs by word position in the response. Modbus checks whole
+      frames, so its CRC failures are counted in the first position. */
+  uint32_t crc_errors[SCD30_MAX_RESPONSE_WORDS];
+  /** Latency per command, indexed by `scd30_stats_command_t` */
+  scd30_latency_stats_t latency[SCD30_STATS_COMMAND_COUNT];
+} scd30_stats_t;
+
+void scd30_stats_clear(scd30_stats_t *stats);
+void scd30_stats_add_latency(scd30_stats_t *stats, uint16_t command,
+                             uint32_t latency_us);
+
+#endif
@@ -0,0 +1,263 @@
+/*!
+ *  @file Adafruit_SCD30_Timing.cpp
+ *
+ * 	Measurement time tracking for the Adafruit SCD30 CO2, Temperature, and
+ * 	Humidity sensor library
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ * 	BSD (see license.txt)
+ */
+
+#include "Adafruit_SCD30_Timing.h"
+#include <string.h>
+
+#define MUL_DIV_LIMIT 0x80000000UL ///< `mul_div` results saturate here
+
+/**
+ * @brief Compute a * b / c with 32 bit arithmetic only, by long division one
+ * bit of `b` at a time, so small MCUs don't pull in 64 bit division
+ *
+ * @param a First factor
+ * @param b Second factor
+ * @param c Divisor, below 2^31
+ * @param remainder Where to store the remainder, or NULL
+ * @return The quotient rounded down, or `MUL_DIV_LIMIT` if it is that big
+ */
+static uint32_t mul_div(uint32_t a, uint32_t b, uint32_t c,
+                        uint32_t *remainder = NULL) {
+  uint32_t a_quotient = a / c, a_remainder = a % c;
+  uint32_t quotient = 0, rest = 0;
+
+  uint32_t bit = 1;
+  while (bit <= b / 2) {
+    bit <<= 1;
+  }
+  for (; bit && b; bit >>= 1) {
+    // (quotient * c + rest) doubles, then gains a if the bit is set
+    if (quotient >= MUL_DIV_LIMIT / 2) {
+      quotient = MUL_DIV_LIMIT;
+      break;
+    }
+    quotient <<= 1;
+    rest <<= 1;
+    if (rest >= c) {
+      rest -= c;
+      quotient++;
+    }
+    if (b & bit) {
+      quotient += a_quotient;
+      rest += a_remainder;
+      if (rest >= c) {
+        rest -= c;
+        quotient++;
+      }
+      if (quotient >= MUL_DIV_LIMIT) {
+        quotient = MUL_DIV_LIMIT;
+        break;
+      }
+    }
+  }
+  if (remainder) {
+    *remainder = rest;
+  }
+  return quotient;
+}
+
+/**
+ * @brief Get the length of `count` periods in milliseconds, modulo 2^32 like
+ * `millis()`
+ *
+ * @param count The number of periods
+ * @param period_us The length of a period in microseconds
+ * @param round_up True to round up, false to round down
+ * @return The length in milliseconds
+ */
+static uint32_t periods_ms(uint32_t count, uint32_t period_us, bool round_up) {
+  uint32_t part_us = count * (period_us % 1000);
+  return count * (period_us / 1000) + (part_us + (round_up ? 999 : 0)) / 1000;
+}
+
+/**
+ * @brief Construct a new Adafruit_SCD30_FrameClock with no measurements
+ */
+Adafruit_SCD30_FrameClock::Adafruit_SCD30_FrameClock(void) { reset(); }
+
+/**
+ * @brief Forget the cadence, for when the sensor restarts measuring
+ */
+void Adafruit_SCD30_FrameClock::reset(void) {
+  memset(&_timing, 0, sizeof(_timing));
+  _interval = 0;
+  _tolerance_us = 0;
+  _earliest = 0;
+  _latest = 0;
+  _has_reference = false;
+  _reference_earliest = 0;
+  _reference_latest = 0;
+  _reference_frame = 0;
+}
+
+/**
+ * @brief Work out when the measurement just read was taken
+ *
+ * Each measurement is bounded by its window, and by the previous
+ * measurement's bounds carried forward by the period give or take
+ * `SCD30_TIMING_TOLERANCE_PPM`. The estimate is the middle of what's left,
+ * which narrows as the checks fall at different points of the cadence.
+ *
+ * @param interval The sensor's measurement interval in seconds
+ * @param fresh True if a check found new data, so it can't be a measurement
+ * read before
+ * @param opened True if a check found no new data since the last read
+ * @param open_ms `millis()` of the last such check
+ * @param close_ms `millis()` the new data was first seen, or of the read
+ * @return true: a new measurement false: the measurement was read before
+ */
+bool Adafruit_SCD30_FrameClock::update(uint16_t interval, bool fresh,
+                                       bool opened, uint32_t open_ms,
+                                       uint32_t close_ms) {
+  if (interval != _interval) {
+    // a new interval restarts the sensor's cadence
+    uint32_t missed = _timing.missed;
+    uint32_t duplicates = _timing.duplicates;
+    reset();
+    _timing.missed = missed;
+    _timing.duplicates = duplicates;
+    _interval = interval;
+    _timing.period_us = (uint32_t)interval * 1000000UL;
+    // until it is measured, the period is only known to be near nominal
+    _tolerance_us =
+        mul_div(_timing.period_us, SCD30_TIMING_MAX_DRIFT_PPM, 1000000);
+  }
+  uint32_t nominal_us = (uint32_t)interval * 1000000UL;
+  uint32_t period_ms = (_timing.period_us + 999) / 1000;
+
+  // the newest measurement is never more than a period old
+  uint32_t earliest = close_ms - period_ms;
+  if (opened && ((int32_t)(open_ms - earliest) > 0)) {
+    earliest = open_ms;
+  }
+  uint32_t latest = close_ms;
+
+  if (_timing.frame) {
+    uint32_t shortest_us = _timing.period_us - _tolerance_us;
+    uint32_t longest_us = _timing.period_us + _tolerance_us;
+
+    // a check saw the data arrive, so it is most likely the next measurement;
+    // a blind read may be any number of measurements on, so take the one
+    // that fits best
+    bool checked = fresh || opened;
+    int32_t ahead = (int32_t)(earliest - _latest);
+    uint32_t count = (ahead > 0) ? mul_div(ahead, 1000, longest_us) : 0;
+    if (fresh && !count) {
+      count = 1;
+    }
+    bool found = false;
+    uint32_t best_count = 0, best_distance = 0;
+    uint32_t carried_earliest = 0, carried_latest = 0;
+    for (uint8_t i = 0; i < 3; i++, count++) {
+      uint32_t low = _earliest + periods_ms(count, shortest_us, false);
+      uint32_t high = _latest + periods_ms(count, longest_us, true);
+      if (((int32_t)(low - latest) > 0) || ((int32_t)(high - earliest) < 0)) {
+        continue;
+      }
+      int32_t offset = (int32_t)((low + (high - low) / 2) -
+                                 (earliest + (latest - earliest) / 2));
+      uint32_t distance = (offset < 0) ? -offset : offset;
+      if (!found || (distance < best_distance)) {
+        carried_earliest = low;
+        carried_latest = high;
+        best_count = count;
+        best_distance = distance;
+        found = true;
+      }
+      if (checked) {
+        break;
+      }
+    }
+    if (found) {
+      count = best_count;
+      if ((int32_t)(carried_earliest - earliest) > 0) {
+        earliest = carried_earliest;
+      }
+      if ((int32_t)(carried_latest - latest) < 0) {
+        latest = carried_latest;
+      }
+    } else {
+      // the bounds went wrong: count by the middles and trust the window
+      int32_t gap = (int32_t)((earliest + (latest - earliest) / 2) -
+                              _timing.acquired);
+      count = 0;
+      if (gap > 0) {
+        uint32_t rest;
+        count = mul_div(gap, 1000, _timing.period_us, &rest);
+        count += (rest >= _timing.period_us - _timing.period_us / 2);
+      }
+      if (fresh && !count) {
+        count = 1;
+      }
+    }
+
+    if (!count) {
+      _timing.duplicates++;
+      return false;
+    }
+    _timing.missed += count - 1;
+    _timing.frame += count;
+  } else {
+    _timing.frame = 1;
+  }
+
+  _earliest = earliest;
+  _latest = latest;
+  _timing.uncertainty = latest - earliest;
+  _timing.acquired = earliest + _timing.uncertainty / 2;
+
+  // measure the period against the best bounded measurement so far, trading
+  // baseline for a reference a lot better than the one kept
+  uint32_t frames = _timing.frame - _reference_frame;
+  if (!_has_reference ||
+      (_timing.uncertainty * 4 < _reference_latest - _reference_earliest)) {
+    _has_reference = true;
+    _reference_earliest = earliest;
+    _reference_latest = latest;
+    _reference_frame = _timing.frame;
+  } else if (frames >= SCD30_TIMING_MIN_FRAMES) {
+    // the period is the middle of the shortest and longest spans, in ms,
+    // over the frames between: (shortest + longest) * 1000 / 2 / frames
+    uint32_t shortest_ms = earliest - _reference_latest;
+    uint32_t longest_ms = latest - _reference_earliest;
+    uint32_t short_rest, long_rest;
+    uint32_t period = mul_div(shortest_ms, 500, frames, &short_rest) +
+                      mul_div(longest_ms, 500, frames, &long_rest) +
+                      (short_rest + long_rest >= frames);
+    uint32_t limit = mul_div(nominal_us, SCD30_TIMING_MAX_DRIFT_PPM, 1000000);
+    if ((period + limit >= nominal_us) && (period <= nominal_us + limit)) {
+      _timing.period_us = period;
+      // the period is known to half the spread, plus jitter in the sensor
+      _tolerance_us = mul_div(longest_ms - shortest_ms, 500, frames) +
+                      mul_div(nominal_us, SCD30_TIMING_TOLERANCE_PPM, 1000000);
+    }
+  }
+  if (_timing.period_us >= nominal_us) {
+    _timing.drift_ppm =
+        mul_div(_timing.period_us - nominal_us, 1000000, nominal_us);
+  } else {
+    _timing.drift_ppm =
+        -(int32_t)mul_div(nominal_us - _timing.period_us, 1000000, nominal_us);
+  }
+  return true;
+}
+
+/**
+ * @brief Get when the last sample was measured and how the sensor's clock
+ * compares to the MCU's
+ *
+ * @param timing Where to store the results
+ */
+void Adafruit_SCD30_FrameClock::getTiming(scd30_timing_t *timing) const {
+  *timing = _timing;
+}
@@ -0,0 +1,80 @@
+/*!
+ *  @file Adafruit_SCD30_Timing.h
+ *
+ * 	Measurement time tracking for the Adafruit SCD30 CO2, Temperature, and
+ * 	Humidity sensor library
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	 license (see license.txt)
+ */
+
+#ifndef _ADAFRUIT_SCD30_TIMING_H
+#define _ADAFRUIT_SCD30_TIMING_H
+
+#include <stdint.h>
+
+#define SCD30_TIMING_MIN_FRAMES                                                \
+  8 ///< Measurements after the reference before the period is estimated
+#define SCD30_TIMING_TOLERANCE_PPM                                             \
+  100 ///< Period jitter allowed for when carrying bounds forward
+#define SCD30_TIMING_MAX_DRIFT_PPM                                             \
+  50000 ///< Largest believable difference between the sensor and MCU clocks
+
+/**
+ * @brief
+ *
+ * When the sensor took its measurements, from `Adafruit_SCD30::getTiming`.
+ */
+typedef struct {
+  uint32_t acquired;    ///< `millis()` when the last sample was measured
+  uint32_t uncertainty; ///< Width in ms of the window it was measured in
+  uint32_t frame;       ///< Measurements since the sensor (re)started
+  uint32_t missed;      ///< Measurements never read
+  uint32_t duplicates;  ///< Reads that returned a measurement already read
+  uint32_t period_us;   ///< Estimated time between measurements
+  int32_t drift_ppm;    ///< Sensor period error, positive when it is slow
+} scd30_timing_t;
+
+/*!
+ *    @brief  Works out when the sensor took each measurement from the window
+ *            it must have been taken in and the sensor's cadence. The window
+ *            opens at the last check that found no new data and closes at
+ *            the first check that found some, the RDY edge, or the read.
+ *
+ *            The bounds of each measurement are carried forward by the
+ *            cadence and narrowed by the next window, and the period is
+ *            measured from a well bounded measurement.
+ */
+class Adafruit_SCD30_FrameClock {
+public:
+  Adafruit_SCD30_FrameClock(void);
+
+  void reset(void);
+  bool update(uint16_t interval, bool fresh, bool opened, uint32_t open_ms,
+              uint32_t close_ms);
+
+  void getTiming(scd30_timing_t *timing) const;
+  /** @brief Get when the last sample was measured
+      @return `millis()` of the measurement, estimated */
+  uint32_t acquired(void) const { return _timing.acquired; }
+  /** @brief Get the number of the last measurement read
+      @return Measurements since the sensor (re)started, the first is 1 */
+  uint32_t frame(void) const { return _timing.frame; }
+
+private:
+  scd30_timing_t _timing;       ///< Latest results
+  uint16_t _interval;           ///< Nominal interval of the cadence, seconds
+  uint32_t _tolerance_us;       ///< How far off `period_us` may be
+  uint32_t _earliest;           ///< Earliest the last measurement was taken
+  uint32_t _latest;             ///< Latest the last measurement was taken
+  bool _has_reference;          ///< True once a reference is kept
+  uint32_t _reference_earliest; ///< Earliest the reference was taken
+  uint32_t _reference_latest;   ///< Latest the reference was taken
+  uint32_t _reference_frame;    ///< Number of the reference measurement
+};
+
+#endif
@@ -0,0 +1,171 @@
+/*!
+ *  @file Adafruit_SCD30_Transport.cpp
+ *
+ * 	Bus interfaces for the Adafruit SCD30 CO2, Temperature, and Humidity
+ * 	sensor library
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ * 	BSD (see license.txt)
+ */
+
+#include "Adafruit_SCD30_Transport.h"
+#include "Adafruit_SCD30_Frame.h"
+
+/**
+ * @brief Read several single word registers, waiting for each. Transports
+ * that can read several registers in one request override this.
+ *
+ * @param commands The commands to read the registers with
+ * @param values Where to store the register values
+ * @param count The number of registers to read
+ * @return true: every register was read false: failure
+ */
+bool Adafruit_SCD30_Transport::readRegisters(const uint16_t *commands,
+                                             uint16_t *values, uint8_t count) {
+  for (uint8_t i = 0; i < count; i++) {
+    if (!request(commands[i], 1)) {
+      return false;
+    }
+    delay(SCD30_READ_DELAY_US / 1000);
+
+    scd30_read_status_t status;
+    do {
+      status = poll(&values[i], 1);
+    } while (status == SCD30_READ_PENDING);
+
+    if (status != SCD30_READ_READY) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief Set up the I2C device
+ *
+ * @return true: the sensor responded false: failure
+ */
+bool Adafruit_SCD30_I2C::begin(void) {
+  _pending = false;
+  return _device && _device->begin();
+}
+
+/**
+ * @brief Send a command that takes no argument
+ *
+ * @param command The command to send
+ * @return true: success false: failure
+ */
+bool Adafruit_SCD30_I2C::write(uint16_t command) {
+  uint8_t buffer[2];
+  buffer[0] = (command >> 8) & 0xFF;
+  buffer[1] = command & 0xFF;
+
+  return send(buffer, sizeof(buffer));
+}
+
+/**
+ * @brief Send a command with an argument, followed by its CRC
+ *
+ * @param command The command to send
+ * @param argument The argument to send with it
+ * @return true: success false: failure
+ */
+bool Adafruit_SCD30_I2C::write(uint16_t command, uint16_t argument) {
+  uint8_t buffer[5];
+  buffer[0] = (command >> 8) & 0xFF;
+  buffer[1] = command & 0xFF;
+  buffer[2] = argument >> 8;
+  buffer[3] = argument & 0xFF;
+  buffer[4] = scd30_crc8(buffer + 2, 2);
+  return send(buffer, sizeof(buffer));
+}
+
+/**
+ * @brief Send a read command. The SCD30 wants a stop before the read, and
+ * the datasheet gap before it has the data
+ *
+ * @param command The command to read the data with
+ * @param words The number of words that will be read
+ * @return true: success false: failure
+ */
+bool Adafruit_SCD30_I2C::request(uint16_t command, uint8_t words) {
+  (void)words;
+  _pending = false;
+
+  if (!write(command)) {
+    return false;
+  }
+  _requested_us = micros();
+  _pending = true;
+  return true;
+}
+
+/**
+ * @brief Read the response to `request` once the datasheet gap has elapsed
+ * and check the CRC of every word
+ *
+ * @param words Where to store the response
+ * @param count The number of words to read, up to `SCD30_MAX_RESPONSE_WORDS`
+ * @return scd30_read_status_t The state of the request
+ */
+scd30_read_status_t Adafruit_SCD30_I2C::poll(uint16_t *words, uint8_t count) {
+  if (!_pending) {
+    return SCD30_READ_IDLE;
+  }
+  if ((uint32_t)(micros() - _requested_us) < SCD30_READ_DELAY_US) {
+    return SCD30_READ_PENDING;
+  }
+  _pending = false;
+
+  // each word is followed by its CRC: MSB, LSB, CRC
+  uint8_t buffer[SCD30_MAX_RESPONSE_WORDS * 3];
+  uint8_t len = count * 3;
+  if (count > SCD30_MAX_RESPONSE_WORDS) {
+    _error = SCD30_ERROR_REJECTED;
+    return SCD30_READ_ERROR;
+  }
+  if (!_device->read(buffer, len)) {
+    _error = SCD30_ERROR_BUS;
+    SCD30_STATS_ADD(_stats, nacks, 1);
+    return SCD30_READ_ERROR;
+  }
+  SCD30_STATS_ADD(_stats, bytes_read, len);
+
+  if (!scd30_unpack_frame(buffer, words, count)) {
+#ifndef SCD30_NO_STATS
+    // only on failure: find which words were corrupted
+    for (uint8_t i = 0; _stats && (i < count); i++) {
+      if (scd30_crc8(buffer + 3 * i, 2) != buffer[3 * i + 2]) {
+        _stats->crc_errors[i]++;
+      }
+    }
+#endif
+    _error = SCD30_ERROR_CRC;
+    return SCD30_READ_ERROR;
+  }
+  _error = SCD30_ERROR_NONE;
+  return SCD30_READ_READY;
+}
+
+/**
+ * @brief Write a frame to the sensor, counting it
+ *
+ * @param buffer The frame
+ * @param len The length of the frame
+ * @return true: the sensor acknowledged it false: failure
+ */
+bool Adafruit_SCD30_I2C::send(const uint8_t *buffer, uint8_t len) {
+  SCD30_STATS_ADD(_stats, transactions, 1);
+  if (!_device->write(buffer, len)) {
+    _error = SCD30_ERROR_BUS;
+    SCD30_STATS_ADD(_stats, nacks, 1);
+    return false;
+  }
+  _error = SCD30_ERROR_NONE;
+  SCD30_STATS_ADD(_stats, bytes_written, len);
+  return true;
+}
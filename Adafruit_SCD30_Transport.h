@@ -0,0 +1,187 @@
+/*!
+ *  @file Adafruit_SCD30_Transport.h
+ *
+ * 	Bus interfaces for the Adafruit SCD30 CO2, Temperature, and Humidity
+ * 	sensor library
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	 license (see license.txt)
+ */
+
+#ifndef _ADAFRUIT_SCD30_TRANSPORT_H
+#define _ADAFRUIT_SCD30_TRANSPORT_H
+
+#include "Adafruit_SCD30_Driver.h"
+#include "Adafruit_SCD30_Stats.h"
+#include "Arduino.h"
+#include <Adafruit_I2CDevice.h>
+
+/*!
+ *    @brief  Interface the driver uses to talk to the sensor. Commands are
+ *            given as their I2C command codes, whatever the bus.
+ */
+class Adafruit_SCD30_Transport {
+public:
+  virtual ~Adafruit_SCD30_Transport() {}
+
+  /** @brief Set up the bus
+      @return true: success false: failure */
+  virtual bool begin(void) = 0;
+
+  /** @brief Send a command that takes no argument
+      @param command The command to send
+      @return true: success false: failure */
+  virtual bool write(uint16_t command) = 0;
+
+  /** @brief Send a command with an argument
+      @param command The command to send
+      @param argument The argument to send with it
+      @return true: success false: failure */
+  virtual bool write(uint16_t command, uint16_t argument) = 0;
+
+  /** @brief Ask the sensor for data, without waiting for the response
+      @param command The command to read the data with
+      @param words The number of 16 bit words to read
+      @return true: success false: failure */
+  virtual bool request(uint16_t command, uint8_t words) = 0;
+
+  /** @brief Collect the response to `request` if it has arrived
+      @param words Where to store the response, checked for errors
+      @param count The number of words requested
+      @return The state of the request */
+  virtual scd30_read_status_t poll(uint16_t *words, uint8_t count) = 0;
+
+  virtual bool readRegisters(const uint16_t *commands, uint16_t *values,
+                             uint8_t count);
+
+  /** @brief Count bus activity and errors
+      @param stats The counters to update, or NULL to stop counting */
+  void setStats(scd30_stats_t *stats) { _stats = stats; }
+
+  /** @brief Get why the last transfer failed
+      @return The error, `SCD30_ERROR_NONE` if it succeeded */
+  scd30_error_t lastError(void) { return _error; }
+
+protected:
+  scd30_stats_t *_stats = NULL;            ///< Counters to update, if any
+  scd30_error_t _error = SCD30_ERROR_NONE; ///< Result of the last transfer
+};
+
+/*!
+ *    @brief  Talks to the sensor over I2C
+ */
+class Adafruit_SCD30_I2C : public Adafruit_SCD30_Transport {
+public:
+  /** @brief Create an I2C transport
+      @param device The I2C device for the sensor */
+  Adafruit_SCD30_I2C(Adafruit_I2CDevice *device = NULL) { _device = device; }
+
+  /** @brief Change the I2C device used
+      @param device The I2C device for the sensor */
+  void setDevice(Adafruit_I2CDevice *device) { _device = device; }
+
+  bool begin(void);
+  bool write(uint16_t command);
+  bool write(uint16_t command, uint16_t argument);
+  bool request(uint16_t command, uint8_t words);
+  scd30_read_status_t poll(uint16_t *words, uint8_t count);
+
+private:
+  bool send(const uint8_t *buffer, uint8_t len);
+
+  Adafruit_I2CDevice *_device; ///< The I2C device for the sensor
+  bool _pending = false;       ///< True while a request is in flight
+  uint32_t _requested_us = 0;  ///< `micros()` when the request was sent
+};
+
+/*!
+ *    @brief  Lets `Adafruit_SCD30_Driver` use a transport chosen at runtime,
+ *            forwarding each call through the `Adafruit_SCD30_Transport`
+ *            interface
+ */
+class Adafruit_SCD30_TransportRef {
+public:
+  /** @brief Refer to a transport
+      @param transport The transport, or NULL until one is chosen */
+  Adafruit_SCD30_TransportRef(Adafruit_SCD30_Transport *transport = NULL) {
+    _transport = transport;
+  }
+
+  /** @brief Get the transport referred to
+      @return The transport, NULL if none was chosen */
+  Adafruit_SCD30_Transport *get(void) { return _transport; }
+
+  /** @brief Set up the bus
+      @return true: success false: failure */
+  bool begin(void) { return _transport->begin(); }
+  /** @brief Send a command that takes no argument
+      @param command The command to send
+      @return true: success false: failure */
+  bool write(uint16_t command) { return _transport->write(command); }
+  /** @brief Send a command with an argument
+      @param command The command to send
+      @param argument The argument to send with it
+      @return true: success false: failure */
+  bool write(uint16_t command, uint16_t argument) {
+    return _transport->write(command, argument);
+  }
+  /** @brief Ask the sensor for data, without waiting for the response
+      @param command The command to read the data with
+      @param words The number of 16 bit words to read
+      @return true: success false: failure */
+  bool request(uint16_t command, uint8_t words) {
+    return _transport->request(command, words);
+  }
+  /** @brief Collect the response to `request` if it has arrived
+      @param words Where to store the response, checked for errors
+      @param count The number of words requested
+      @return The state of the request */
+  scd30_read_status_t poll(uint16_t *words, uint8_t count) {
+    return _transport->poll(words, count);
+  }
+  /** @brief Read several single word registers
+      @param commands The commands to read the registers with
+      @param values Where to store the register values
+      @param count The number of registers to read
+      @return true: every register was read false: failure */
+  bool readRegisters(const uint16_t *commands, uint16_t *values,
+                     uint8_t count) {
+    return _transport->readRegisters(commands, values, count);
+  }
+  /** @brief Get why the last transfer failed
+      @return The error, `SCD30_ERROR_NONE` if it succeeded */
+  scd30_error_t lastError(void) { return _transport->lastError(); }
+
+private:
+  Adafruit_SCD30_Transport *_transport; ///< The transport referred to
+};
+
+/*!
+ *    @brief  Clock policy for `Adafruit_SCD30_Driver` using the Arduino core
+ */
+struct Adafruit_SCD30_ArduinoClock {
+  /** @brief Get the time since startup
+      @return `millis()` */
+  static uint32_t millis(void) { return ::millis(); }
+  /** @brief Get the time since startup in microseconds
+      @return `micros()` */
+  static uint32_t micros(void) { return ::micros(); }
+  /** @brief Wait for a while
+      @param ms The time to wait in milliseconds */
+  static void delay(uint32_t ms) { ::delay(ms); }
+};
+
+/** Statically dispatched driver for a sensor on I2C */
+typedef Adafruit_SCD30_Driver<Adafruit_SCD30_I2C, Adafruit_SCD30_ArduinoClock>
+    Adafruit_SCD30_I2CDriver;
+
+/** The driver core `Adafruit_SCD30` runs on, for a transport set at runtime */
+typedef Adafruit_SCD30_Driver<Adafruit_SCD30_TransportRef,
+                              Adafruit_SCD30_ArduinoClock>
+    Adafruit_SCD30_Core;
+
+#endif
@@ -0,0 +1,46 @@
+// Demo of the adaptive measurement interval: measure every 2 seconds while
+// CO2 changes quickly and back off to once a minute while it is steady
+#include <Adafruit_SCD30.h>
+#include <Adafruit_SCD30_Adaptive.h>
+
+Adafruit_SCD30  scd30;
+Adafruit_SCD30_AdaptiveInterval adaptive(&scd30);
+
+void setup(void) {
+  Serial.begin(115200);
+  while (!Serial) delay(10);     // will pause Zero, Leonardo, etc until serial console opens
+
+  Serial.println("Adafruit SCD30 adaptive interval test!");
+
+  // Try to initialize!
+  if (!scd30.begin()) {
+    Serial.println("Failed to find SCD30 chip");
+    while (1) { delay(10); }
+  }
+  Serial.println("SCD30 Found!");
+
+  if (!adaptive.begin(2, 60)) {
+    Serial.println("Failed to set the measurement interval");
+    while (1) { delay(10); }
+  }
+}
+
+void loop() {
+  if (scd30.dataReady()) {
+    if (!scd30.read()){ Serial.println("Error reading sensor data"); return; }
+
+    Serial.print("CO2: ");
+    Serial.print(scd30.CO2, 1);
+    Serial.print(" ppm, rate: ");
+    Serial.print(adaptive.getRate(), 1);
+    Serial.println(" ppm/minute");
+
+    if (adaptive.update()) {
+      Serial.print("Measurement interval now ");
+      Serial.print(scd30.getMeasurementInterval());
+      Serial.print(" seconds, writes so far: ");
+      Serial.println(adaptive.getWrites());
+    }
+  }
+  delay(100);
+}
@@ -0,0 +1,92 @@
+// Measures how long each Adafruit SCD30 API call holds up the main loop
+#include <Adafruit_SCD30.h>
+
+Adafruit_SCD30  scd30;
+
+#define TIMING_RUNS 10
+
+// Print the average time taken by a call, in microseconds
+#define TIME_CALL(name, call)                      \
+  do {                                             \
+    uint32_t total = 0;                            \
+    for (uint8_t i = 0; i < TIMING_RUNS; i++) {    \
+      uint32_t start = micros();                   \
+      call;                                        \
+      total += micros() - start;                   \
+    }                                              \
+    Serial.print(name);                            \
+    Serial.print(": ");                            \
+    Serial.print(total / TIMING_RUNS);             \
+    Serial.println(" us");                         \
+  } while (0)
+
+// Time a non-blocking read from beginRead() until pollRead() completes it.
+// Each read must finish before the next starts, or pollRead() would only be
+// timed on reads that are still waiting out the write/read gap.
+void timeReadCycle(void) {
+  uint32_t begin_total = 0, complete_total = 0, cycle_total = 0;
+  for (uint8_t i = 0; i < TIMING_RUNS; i++) {
+    uint32_t start = micros();
+    scd30.beginRead();
+    begin_total += micros() - start;
+
+    scd30_read_status_t status;
+    do {
+      uint32_t poll_start = micros();
+      status = scd30.pollRead();
+      if (status != SCD30_READ_PENDING) {
+        complete_total += micros() - poll_start;
+      }
+    } while (status == SCD30_READ_PENDING);
+    cycle_total += micros() - start;
+  }
+
+  Serial.print("beginRead(): ");
+  Serial.print(begin_total / TIMING_RUNS);
+  Serial.println(" us");
+  Serial.print("pollRead() that completes the read: ");
+  Serial.print(complete_total / TIMING_RUNS);
+  Serial.println(" us");
+  Serial.print("beginRead() until pollRead() completes: ");
+  Serial.print(cycle_total / TIMING_RUNS);
+  Serial.println(" us");
+}
+
+void setup(void) {
+  Serial.begin(115200);
+  while (!Serial) delay(10);     // will pause Zero, Leonardo, etc until serial console opens
+
+  Serial.println("Adafruit SCD30 API timing!");
+
+  uint32_t start = micros();
+  // Try to initialize!
+  if (!scd30.begin()) {
+    Serial.println("Failed to find SCD30 chip");
+    while (1) { delay(10); }
+  }
+  Serial.print("begin(): ");
+  Serial.print(micros() - start);
+  Serial.println(" us");
+  Serial.println("");
+}
+
+void loop() {
+  // wait for fresh data so read() has a real frame to fetch
+  while (!scd30.dataReady()) {
+    delay(100);
+  }
+
+  TIME_CALL("read()", scd30.read());
+  timeReadCycle();
+  TIME_CALL("dataReady()", scd30.dataReady());
+  TIME_CALL("getMeasurementInterval()", scd30.getMeasurementInterval());
+  TIME_CALL("getAmbientPressureOffset()", scd30.getAmbientPressureOffset());
+  TIME_CALL("getAltitudeOffset()", scd30.getAltitudeOffset());
+  TIME_CALL("getTemperatureOffset()", scd30.getTemperatureOffset());
+  TIME_CALL("getForcedCalibrationReference()",
+            scd30.getForcedCalibrationReference());
+  TIME_CALL("selfCalibrationEnabled()", scd30.selfCalibrationEnabled());
+  Serial.println("");
+
+  delay(5000);
+}
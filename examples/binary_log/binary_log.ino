@@ -0,0 +1,65 @@
+// Demo of the compact binary log format. Each sample is encoded into a few
+// bytes that can be appended straight to a file, for example with
+// `file.write(record, len)` from the SD library. Here the records are
+// printed in hex along with how much space they save over CSV
+#include <Adafruit_SCD30.h>
+#include <Adafruit_SCD30_Log.h>
+
+Adafruit_SCD30  scd30;
+Adafruit_SCD30_LogEncoder encoder;
+
+uint32_t log_bytes = 0, csv_bytes = 0;
+
+void writeRecord(const uint8_t *record, uint8_t len) {
+  for (uint8_t i = 0; i < len; i++) {
+    if (record[i] < 0x10) Serial.print("0");
+    Serial.print(record[i], HEX);
+  }
+  Serial.println("");
+  log_bytes += len;
+}
+
+void setup(void) {
+  Serial.begin(115200);
+  while (!Serial) delay(10);     // will pause Zero, Leonardo, etc until serial console opens
+
+  Serial.println("Adafruit SCD30 binary log test!");
+
+  // Try to initialize!
+  if (!scd30.begin()) {
+    Serial.println("Failed to find SCD30 chip");
+    while (1) { delay(10); }
+  }
+  Serial.println("SCD30 Found!");
+
+  // every time logging starts, a header is appended
+  uint8_t record[SCD30_LOG_MAX_RECORD_SIZE];
+  uint8_t len = encoder.begin(0, scd30.getMeasurementInterval(), record);
+  writeRecord(record, len);
+}
+
+void loop() {
+  if (scd30.dataReady()) {
+    if (!scd30.read()){ Serial.println("Error reading sensor data"); return; }
+    uint32_t now = millis();
+
+    uint8_t record[SCD30_LOG_MAX_RECORD_SIZE];
+    uint8_t len = encoder.add(scd30.CO2, scd30.temperature,
+                              scd30.relative_humidity, now, record);
+    writeRecord(record, len);
+
+    // the same sample as a CSV line
+    String line = String(now) + "," + String(scd30.CO2, 1) + "," +
+                  String(scd30.temperature, 2) + "," +
+                  String(scd30.relative_humidity, 2) + "\n";
+    csv_bytes += line.length();
+
+    Serial.print("Log: ");
+    Serial.print(log_bytes);
+    Serial.print(" bytes, CSV: ");
+    Serial.print(csv_bytes);
+    Serial.println(" bytes");
+  }
+
+  delay(100);
+}
@@ -0,0 +1,65 @@
+// Demo of the bus health counters, useful to spot a degrading cable by
+// its CRC errors and NACKs, and to see how much bus time the sensor costs
+#include <Adafruit_SCD30.h>
+
+Adafruit_SCD30  scd30;
+scd30_stats_t stats;
+
+void setup(void) {
+  Serial.begin(115200);
+  while (!Serial) delay(10);     // will pause Zero, Leonardo, etc until serial console opens
+
+  Serial.println("Adafruit SCD30 bus stats test!");
+
+  // attach the counters before begin() to count initialization too
+  scd30_stats_clear(&stats);
+  scd30.setStats(&stats);
+
+  // Try to initialize!
+  if (!scd30.begin()) {
+    Serial.println("Failed to find SCD30 chip");
+    while (1) { delay(10); }
+  }
+  Serial.println("SCD30 Found!");
+}
+
+void loop() {
+  if (scd30.dataReady()) {
+    if (!scd30.read()){ Serial.println("Error reading sensor data"); }
+
+    scd30_stats_t snapshot;
+    scd30.getStats(&snapshot);
+
+    Serial.print("Transactions: ");
+    Serial.print(snapshot.transactions);
+    Serial.print(", bytes written: ");
+    Serial.print(snapshot.bytes_written);
+    Serial.print(", bytes read: ");
+    Serial.println(snapshot.bytes_read);
+
+    Serial.print("NACKs: ");
+    Serial.print(snapshot.nacks);
+    Serial.print(", retries: ");
+    Serial.print(snapshot.retries);
+    Serial.print(", CRC errors by word:");
+    for (uint8_t i = 0; i < SCD30_MAX_RESPONSE_WORDS; i++) {
+      Serial.print(" ");
+      Serial.print(snapshot.crc_errors[i]);
+    }
+    Serial.println("");
+
+    scd30_latency_stats_t *read = &snapshot.latency[SCD30_STATS_READ_MEASUREMENT];
+    if (read->count) {
+      Serial.print("Read latency min/mean/max: ");
+      Serial.print(read->min_us);
+      Serial.print("/");
+      Serial.print(read->total_us / read->count);
+      Serial.print("/");
+      Serial.print(read->max_us);
+      Serial.println(" us");
+    }
+    Serial.println("");
+  }
+
+  delay(100);
+}
@@ -0,0 +1,47 @@
+// Demo of change-only reporting: samples are only printed when CO2 or
+// temperature moved enough, or nothing was printed for a minute
+#include <Adafruit_SCD30.h>
+
+Adafruit_SCD30  scd30;
+scd30_observer_t reporter;
+
+void report(const scd30_snapshot_t *sample, uint8_t reasons, void *context) {
+  (void)context;
+
+  Serial.print("CO2: ");
+  Serial.print(sample->CO2, 1);
+  Serial.print(" ppm, temperature: ");
+  Serial.print(sample->temperature);
+  Serial.print(" degrees C, sample #");
+  Serial.print(sample->sequence);
+  if (reasons & SCD30_OBSERVE_SILENCE) {
+    Serial.print(" (keepalive)");
+  }
+  Serial.println("");
+}
+
+void setup(void) {
+  Serial.begin(115200);
+  while (!Serial) delay(10);     // will pause Zero, Leonardo, etc until serial console opens
+
+  Serial.println("Adafruit SCD30 change reporting test!");
+
+  // Try to initialize!
+  if (!scd30.begin()) {
+    Serial.println("Failed to find SCD30 chip");
+    while (1) { delay(10); }
+  }
+  Serial.println("SCD30 Found!");
+
+  // 20 ppm, 0.5 degrees C, humidity ignored, at least once a minute
+  scd30_deadband_t deadband = {20, 0.5, -1, 60000};
+  scd30.addObserver(&reporter, report, NULL, &deadband);
+}
+
+void loop() {
+  // the observer is called from read() when the sample is worth reporting
+  if (scd30.dataReady()) {
+    if (!scd30.read()){ Serial.println("Error reading sensor data"); }
+  }
+  delay(100);
+}
@@ -0,0 +1,58 @@
+// Demo of reading measurements without any floating point math, converting
+// them to the 7 byte compact format for storing or forwarding
+#include <Adafruit_SCD30.h>
+
+Adafruit_SCD30  scd30;
+
+void setup(void) {
+  Serial.begin(115200);
+  while (!Serial) delay(10);     // will pause Zero, Leonardo, etc until serial console opens
+
+  Serial.println("Adafruit SCD30 compact sample test!");
+
+  // Try to initialize!
+  if (!scd30.begin()) {
+    Serial.println("Failed to find SCD30 chip");
+    while (1) { delay(10); }
+  }
+  Serial.println("SCD30 Found!");
+}
+
+void loop() {
+  if (scd30.dataReady()) {
+    uint8_t payload[SCD30_RAW_PAYLOAD_SIZE];
+    if (!scd30.readRaw(payload)){ Serial.println("Error reading sensor data"); return; }
+
+    scd30_compact_sample_t sample;
+    if (!scd30_compact_from_payload(payload, &sample)) {
+      Serial.println("Reading out of range, clamped");
+    }
+
+    // temperature is in hundredths of a degree C
+    Serial.print("Temperature: ");
+    Serial.print(sample.temperature);
+    Serial.println(" x 0.01 degrees C");
+
+    // humidity is in hundredths of a percent
+    Serial.print("Relative Humidity: ");
+    Serial.print(sample.humidity);
+    Serial.println(" x 0.01 %");
+
+    // CO2 is in tenths of a ppm
+    Serial.print("CO2: ");
+    Serial.print(sample.co2);
+    Serial.println(" x 0.1 ppm");
+
+    uint8_t packed[SCD30_COMPACT_SIZE];
+    scd30_compact_pack(&sample, packed);
+    Serial.print("Packed: ");
+    for (uint8_t i = 0; i < SCD30_COMPACT_SIZE; i++) {
+      if (packed[i] < 0x10) Serial.print("0");
+      Serial.print(packed[i], HEX);
+    }
+    Serial.println("");
+    Serial.println("");
+  }
+
+  delay(100);
+}
@@ -0,0 +1,70 @@
+// Compares the bitwise CRC8 the SCD30 driver used to run with the lookup table
+// version. Build the library with SCD30_CRC8_NIBBLE_TABLE defined to measure
+// the smaller 16 entry table instead. No sensor is needed.
+#include <Adafruit_SCD30.h>
+
+#define BENCHMARK_RUNS 1000
+
+// A measurement frame as read from the sensor: six words, each followed by
+// its CRC
+uint8_t frame[18] = {0x43, 0xDB, 0xCB, 0x8C, 0x2E, 0x8F, 0x41, 0xD9, 0x70,
+                     0xE7, 0xFF, 0xF5, 0x42, 0x43, 0xBF, 0x3A, 0x1B, 0x74};
+
+uint8_t bitwise_crc8(const uint8_t *data, int len) {
+  uint8_t crc = 0xFF;
+
+  for (int j = len; j; --j) {
+    crc ^= *data++;
+
+    for (int i = 8; i; --i) {
+      crc = (crc & 0x80) ? (crc << 1) ^ 0x31 : (crc << 1);
+    }
+  }
+  return crc;
+}
+
+bool bitwise_validate(const uint8_t *data) {
+  for (uint8_t i = 0; i < 18; i += 3) {
+    if (bitwise_crc8(data + i, 2) != data[i + 2]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void setup(void) {
+  Serial.begin(115200);
+  while (!Serial) delay(10);     // will pause Zero, Leonardo, etc until serial console opens
+
+  Serial.println("Adafruit SCD30 CRC8 benchmark!");
+  Serial.print("Test frame is ");
+  Serial.println(Adafruit_SCD30::validateFrame(frame, 18) ? "valid" : "INVALID");
+}
+
+void loop() {
+  volatile bool valid = true;
+  uint32_t start;
+
+  start = micros();
+  for (uint16_t i = 0; i < BENCHMARK_RUNS; i++) {
+    valid = bitwise_validate(frame);
+  }
+  uint32_t bitwise_us = micros() - start;
+
+  start = micros();
+  for (uint16_t i = 0; i < BENCHMARK_RUNS; i++) {
+    valid = Adafruit_SCD30::validateFrame(frame, 18);
+  }
+  uint32_t table_us = micros() - start;
+
+  Serial.print("Bitwise frame check: ");
+  Serial.print((float)bitwise_us / BENCHMARK_RUNS);
+  Serial.println(" us");
+  Serial.print("Table frame check:   ");
+  Serial.print((float)table_us / BENCHMARK_RUNS);
+  Serial.println(" us");
+  Serial.println("");
+
+  (void)valid;
+  delay(2000);
+}
@@ -0,0 +1,50 @@
+// Demo of duty cycled acquisition: the sensor is stopped between samples
+// and restarted shortly before each one is due, to save power
+#include <Adafruit_SCD30.h>
+#include <Adafruit_SCD30_DutyCycle.h>
+
+Adafruit_SCD30  scd30;
+Adafruit_SCD30_DutyCycle duty(&scd30);
+
+void setup(void) {
+  Serial.begin(115200);
+  while (!Serial) delay(10);     // will pause Zero, Leonardo, etc until serial console opens
+
+  Serial.println("Adafruit SCD30 duty cycle test!");
+
+  // Try to initialize!
+  if (!scd30.begin()) {
+    Serial.println("Failed to find SCD30 chip");
+    while (1) { delay(10); }
+  }
+  Serial.println("SCD30 Found!");
+
+  // one sample every 5 minutes, discarding the first 10 seconds after a restart
+  if (!duty.begin(5 * 60 * 1000UL, 10000)) {
+    Serial.println("Failed to stop measurement");
+    while (1) { delay(10); }
+  }
+}
+
+void loop() {
+  if (duty.poll()) {
+    Serial.print("CO2: ");
+    Serial.print(scd30.CO2, 3);
+    Serial.print(" ppm, temperature: ");
+    Serial.print(scd30.temperature);
+    Serial.print(" degrees C, relative humidity: ");
+    Serial.print(scd30.relative_humidity);
+    Serial.println(" %");
+
+    scd30_duty_budget_t budget;
+    duty.getBudget(&budget);
+    Serial.print("Measuring ");
+    Serial.print(budget.active_ms);
+    Serial.print(" ms, stopped ");
+    Serial.print(budget.idle_ms);
+    Serial.print(" ms, estimated average ");
+    Serial.print(budget.average_ua);
+    Serial.println(" uA");
+    Serial.println("");
+  }
+}
@@ -0,0 +1,50 @@
+// Demo of the filter pipeline: CO2 goes through a median to reject spikes
+// and then a moving average, while the raw reading stays available
+#include <Adafruit_SCD30.h>
+
+Adafruit_SCD30  scd30;
+Adafruit_SCD30_Filter filter;
+Adafruit_SCD30_Median<5> co2_median;
+Adafruit_SCD30_EMA co2_average(3);                  // averages over about 8 samples
+Adafruit_SCD30_Kalman temp_kalman(1, 5UL * 5);      // 0.05 degrees C noise
+
+void setup(void) {
+  Serial.begin(115200);
+  while (!Serial) delay(10);     // will pause Zero, Leonardo, etc until serial console opens
+
+  Serial.println("Adafruit SCD30 filter test!");
+
+  // Try to initialize!
+  if (!scd30.begin()) {
+    Serial.println("Failed to find SCD30 chip");
+    while (1) { delay(10); }
+  }
+  Serial.println("SCD30 Found!");
+
+  filter.addStage(SCD30_CHANNEL_CO2, &co2_median);
+  filter.addStage(SCD30_CHANNEL_CO2, &co2_average);
+  filter.addStage(SCD30_CHANNEL_TEMPERATURE, &temp_kalman);
+  scd30.setFilter(&filter);
+}
+
+void loop() {
+  if (scd30.dataReady()) {
+    if (!scd30.read()){ Serial.println("Error reading sensor data"); return; }
+
+    float co2, temperature, humidity;
+    filter.getFiltered(&co2, &temperature, &humidity);
+
+    Serial.print("CO2 raw: ");
+    Serial.print(scd30.CO2, 1);
+    Serial.print(" ppm, filtered: ");
+    Serial.print(co2, 1);
+    Serial.println(" ppm");
+
+    Serial.print("Temperature raw: ");
+    Serial.print(scd30.temperature);
+    Serial.print(" degrees C, filtered: ");
+    Serial.print(temperature);
+    Serial.println(" degrees C");
+    Serial.println("");
+  }
+}
@@ -0,0 +1,56 @@
+// Demo of keeping the last few minutes of SCD30 readings with their
+// mean, standard deviation, min and max
+#include <Adafruit_SCD30.h>
+
+Adafruit_SCD30  scd30;
+
+// 5 minutes of samples at the default 2 second measurement interval
+Adafruit_SCD30_History<150> history;
+
+void printStats(const char *name, scd30_channel_t channel) {
+  scd30_history_stats_t stats;
+  if (!history.getStats(channel, &stats)) {
+    return;
+  }
+  Serial.print(name);
+  Serial.print(" mean: ");
+  Serial.print(stats.mean);
+  Serial.print(" std dev: ");
+  Serial.print(sqrt(stats.variance));
+  Serial.print(" min: ");
+  Serial.print(stats.min);
+  Serial.print(" max: ");
+  Serial.println(stats.max);
+}
+
+void setup(void) {
+  Serial.begin(115200);
+  while (!Serial) delay(10);     // will pause Zero, Leonardo, etc until serial console opens
+
+  Serial.println("Adafruit SCD30 history test!");
+
+  // Try to initialize!
+  if (!scd30.begin()) {
+    Serial.println("Failed to find SCD30 chip");
+    while (1) { delay(10); }
+  }
+  Serial.println("SCD30 Found!");
+
+  // every successful read() is added to the history from now on
+  scd30.setHistory(&history);
+}
+
+void loop() {
+  if (scd30.dataReady()) {
+    if (!scd30.read()){ Serial.println("Error reading sensor data"); return; }
+
+    Serial.print(history.size());
+    Serial.println(" samples");
+    printStats("CO2", SCD30_CHANNEL_CO2);
+    printStats("Temperature", SCD30_CHANNEL_TEMPERATURE);
+    printStats("Humidity", SCD30_CHANNEL_HUMIDITY);
+    Serial.println("");
+  }
+
+  delay(100);
+}
@@ -0,0 +1,49 @@
+// Demo of talking to the SCD30 with Modbus RTU over a UART instead of I2C,
+// which allows much longer cables. Pull the SCD30's SEL pin high to select
+// Modbus, and connect its TX/RX to the board's Serial1 RX/TX
+#include <Adafruit_SCD30.h>
+#include <Adafruit_SCD30_Modbus.h>
+
+Adafruit_SCD30_Modbus modbus(&Serial1);
+Adafruit_SCD30  scd30;
+
+void setup(void) {
+  Serial.begin(115200);
+  while (!Serial) delay(10);     // will pause Zero, Leonardo, etc until serial console opens
+
+  Serial.println("Adafruit SCD30 Modbus test!");
+
+  Serial1.begin(SCD30_MODBUS_BAUD);
+
+  // Try to initialize!
+  if (!scd30.begin(&modbus)) {
+    Serial.println("Failed to find SCD30 chip");
+    while (1) { delay(10); }
+  }
+  Serial.println("SCD30 Found!");
+
+  Serial.print("Measurement Interval: ");
+  Serial.print(scd30.getMeasurementInterval());
+  Serial.println(" seconds");
+}
+
+void loop() {
+  if (scd30.dataReady()) {
+    if (!scd30.read()){ Serial.println("Error reading sensor data"); return; }
+
+    Serial.print("Temperature: ");
+    Serial.print(scd30.temperature);
+    Serial.println(" degrees C");
+
+    Serial.print("Relative Humidity: ");
+    Serial.print(scd30.relative_humidity);
+    Serial.println(" %");
+
+    Serial.print("CO2: ");
+    Serial.print(scd30.CO2, 3);
+    Serial.println(" ppm");
+    Serial.println("");
+  }
+
+  delay(100);
+}
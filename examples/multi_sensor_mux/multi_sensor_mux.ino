@@ -0,0 +1,61 @@
+// Demo of reading several SCD30s, which all share the same I2C address, from
+// behind a TCA9548A I2C multiplexer without blocking the main loop
+#include <Adafruit_SCD30.h>
+#include <Adafruit_SCD30_Manager.h>
+
+#define TCA_ADDR 0x70
+#define SENSOR_COUNT 3
+
+Adafruit_I2CDevice mux(TCA_ADDR, &Wire);
+Adafruit_SCD30  scd30[SENSOR_COUNT];
+Adafruit_SCD30_Manager manager;
+
+void setup(void) {
+  Serial.begin(115200);
+  while (!Serial) delay(10);     // will pause Zero, Leonardo, etc until serial console opens
+
+  Serial.println("Adafruit SCD30 multiplexer test!");
+
+  if (!mux.begin()) {
+    Serial.println("Failed to find multiplexer");
+    while (1) { delay(10); }
+  }
+
+  for (uint8_t i = 0; i < SENSOR_COUNT; i++) {
+    // the sensors are on multiplexer channels 0, 1, 2...
+    int8_t index = manager.addSensor(&scd30[i], &mux, i);
+    manager.select(index);
+    if (!scd30[i].begin()) {
+      Serial.print("Failed to find SCD30 chip on channel ");
+      Serial.println(i);
+      while (1) { delay(10); }
+    }
+  }
+  Serial.println("SCD30s Found!");
+}
+
+void loop() {
+  int8_t index = manager.poll();
+  if (index >= 0) {
+    Adafruit_SCD30 *sensor = manager.getSensor(index);
+    Serial.print("Sensor ");
+    Serial.print(index);
+    Serial.print(" CO2: ");
+    Serial.print(sensor->CO2, 3);
+    Serial.print(" ppm, Temperature: ");
+    Serial.print(sensor->temperature);
+    Serial.print(" degrees C, Relative Humidity: ");
+    Serial.print(sensor->relative_humidity);
+    Serial.println(" %");
+  }
+
+  static uint32_t last_report = 0;
+  if (millis() - last_report > 10000) {
+    last_report = millis();
+    Serial.print(manager.getSampleCount());
+    Serial.print(" samples using ");
+    Serial.print(manager.getBusTime());
+    Serial.println(" us of bus time");
+    manager.resetStats();
+  }
+}
@@ -0,0 +1,54 @@
+// Demo of reading the Adafruit SCD30 without blocking the main loop
+#include <Adafruit_SCD30.h>
+
+Adafruit_SCD30  scd30;
+
+void setup(void) {
+  Serial.begin(115200);
+  while (!Serial) delay(10);     // will pause Zero, Leonardo, etc until serial console opens
+
+  Serial.println("Adafruit SCD30 non-blocking read test!");
+
+  // Try to initialize!
+  if (!scd30.begin()) {
+    Serial.println("Failed to find SCD30 chip");
+    while (1) { delay(10); }
+  }
+  Serial.println("SCD30 Found!");
+}
+
+void loop() {
+  switch (scd30.pollRead()) {
+  case SCD30_READ_IDLE:
+    // nothing in flight, start a read once the sensor has new data
+    if (scd30.dataReady() && !scd30.beginRead()) {
+      Serial.println("Error requesting sensor data");
+    }
+    break;
+
+  case SCD30_READ_PENDING:
+    // the sensor is preparing the data, go do something else
+    break;
+
+  case SCD30_READ_READY:
+    Serial.print("Temperature: ");
+    Serial.print(scd30.temperature);
+    Serial.println(" degrees C");
+
+    Serial.print("Relative Humidity: ");
+    Serial.print(scd30.relative_humidity);
+    Serial.println(" %");
+
+    Serial.print("CO2: ");
+    Serial.print(scd30.CO2, 3);
+    Serial.println(" ppm");
+    Serial.println("");
+    break;
+
+  case SCD30_READ_ERROR:
+    Serial.println("Error reading sensor data");
+    break;
+  }
+
+  // the rest of the loop keeps running while a read is pending
+}
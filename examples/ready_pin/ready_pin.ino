@@ -0,0 +1,43 @@
+// Demo of using the SCD30's RDY pin to know when new data is available,
+// without asking the sensor over I2C
+#include <Adafruit_SCD30.h>
+
+// Connect the SCD30's RDY pin here. Use an interrupt capable pin so the
+// rising edge is caught by the library
+#define SCD30_RDY_PIN 2
+
+Adafruit_SCD30  scd30;
+
+void setup(void) {
+  Serial.begin(115200);
+  while (!Serial) delay(10);     // will pause Zero, Leonardo, etc until serial console opens
+
+  Serial.println("Adafruit SCD30 RDY pin test!");
+
+  // Try to initialize!
+  if (!scd30.begin(SCD30_I2CADDR_DEFAULT, &Wire, 0, SCD30_RDY_PIN)) {
+    Serial.println("Failed to find SCD30 chip");
+    while (1) { delay(10); }
+  }
+  Serial.println("SCD30 Found!");
+}
+
+void loop() {
+  // dataReady() only checks the RDY pin, so it can be called as often as needed
+  if (scd30.dataReady()) {
+    if (!scd30.read()){ Serial.println("Error reading sensor data"); return; }
+
+    Serial.print("Temperature: ");
+    Serial.print(scd30.temperature);
+    Serial.println(" degrees C");
+
+    Serial.print("Relative Humidity: ");
+    Serial.print(scd30.relative_humidity);
+    Serial.println(" %");
+
+    Serial.print("CO2: ");
+    Serial.print(scd30.CO2, 3);
+    Serial.println(" ppm");
+    Serial.println("");
+  }
+}
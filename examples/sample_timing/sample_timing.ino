@@ -0,0 +1,50 @@
+// Demo of measurement timing: when each sample was measured, how far the
+// sensor's clock is from the MCU's, and whether any samples were missed
+#include <Adafruit_SCD30.h>
+
+Adafruit_SCD30  scd30;
+
+void setup(void) {
+  Serial.begin(115200);
+  while (!Serial) delay(10);     // will pause Zero, Leonardo, etc until serial console opens
+
+  Serial.println("Adafruit SCD30 sample timing test!");
+
+  // Try to initialize!
+  if (!scd30.begin()) {
+    Serial.println("Failed to find SCD30 chip");
+    while (1) { delay(10); }
+  }
+  Serial.println("SCD30 Found!");
+}
+
+void loop() {
+  // checking often narrows the window each measurement is known to be in;
+  // passing the RDY pin to begin() narrows it to the edge, see ready_pin
+  if (scd30.dataReady()) {
+    if (!scd30.read()){ Serial.println("Error reading sensor data"); return; }
+
+    scd30_timing_t timing;
+    scd30.getTiming(&timing);
+
+    Serial.print("Measurement #");
+    Serial.print(timing.frame);
+    Serial.print(" taken ");
+    Serial.print(millis() - timing.acquired);
+    Serial.print(" ms ago, give or take ");
+    Serial.print(timing.uncertainty / 2);
+    Serial.print(" ms, CO2: ");
+    Serial.print(scd30.CO2, 1);
+    Serial.println(" ppm");
+
+    Serial.print("Sensor period: ");
+    Serial.print(timing.period_us);
+    Serial.print(" us, drift: ");
+    Serial.print(timing.drift_ppm);
+    Serial.print(" ppm, missed: ");
+    Serial.print(timing.missed);
+    Serial.print(", duplicates: ");
+    Serial.println(timing.duplicates);
+  }
+  delay(10);
+}
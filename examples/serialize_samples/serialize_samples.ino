@@ -0,0 +1,71 @@
+// Demo of formatting samples for a gateway without Serial.print of floats or
+// String: each sample is written into a fixed buffer as InfluxDB line
+// protocol, JSON and CBOR, along with the sensor settings and bus counters
+#include <Adafruit_SCD30.h>
+#include <Adafruit_SCD30_Serialize.h>
+
+Adafruit_SCD30  scd30;
+scd30_stats_t stats;
+
+char text[SCD30_JSON_MAX_SIZE];
+uint8_t cbor[SCD30_CBOR_MAX_SIZE];
+
+void setup(void) {
+  Serial.begin(115200);
+  while (!Serial) delay(10);     // will pause Zero, Leonardo, etc until serial console opens
+
+  Serial.println("Adafruit SCD30 serialization test!");
+
+  // Try to initialize!
+  if (!scd30.begin()) {
+    Serial.println("Failed to find SCD30 chip");
+    while (1) { delay(10); }
+  }
+  Serial.println("SCD30 Found!");
+
+  scd30.setStats(&stats);
+}
+
+void loop() {
+  if (scd30.dataReady()) {
+    if (!scd30.read()){ Serial.println("Error reading sensor data"); return; }
+
+    scd30_snapshot_t snapshot;
+    scd30_config_t config;
+    if (!scd30.getSnapshot(&snapshot) || !scd30.getConfig(&config)) {
+      return;
+    }
+
+    scd30_record_t record;
+    scd30_compact_from_floats(snapshot.CO2, snapshot.temperature,
+                              snapshot.relative_humidity, &record.sample);
+    record.timestamp = snapshot.timestamp;
+    record.sequence = snapshot.sequence;
+    record.frame = snapshot.frame;
+    record.config = &config;
+    record.stats = &stats;
+
+    // no clock here, so let the server stamp the point
+    if (scd30_format_line(&record, "scd30", "room=office", 0, text,
+                          sizeof(text))) {
+      Serial.println(text);
+    }
+
+    if (scd30_format_json(&record, text, sizeof(text))) {
+      Serial.println(text);
+    }
+
+    size_t length = scd30_format_cbor(&record, cbor, sizeof(cbor));
+    Serial.print("CBOR, ");
+    Serial.print(length);
+    Serial.print(" bytes: ");
+    for (size_t i = 0; i < length; i++) {
+      if (cbor[i] < 0x10) Serial.print("0");
+      Serial.print(cbor[i], HEX);
+    }
+    Serial.println("");
+    Serial.println("");
+  }
+
+  delay(100);
+}
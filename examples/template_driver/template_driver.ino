@@ -0,0 +1,43 @@
+// Demo of the statically dispatched driver, which trades the Unified Sensor,
+// RDY pin and history features of Adafruit_SCD30 for a smaller, fully
+// inlined read path
+#include <Adafruit_SCD30.h>
+
+Adafruit_I2CDevice scd30_dev(SCD30_I2CADDR_DEFAULT, &Wire);
+Adafruit_SCD30_I2CDriver scd30;
+
+void setup(void) {
+  Serial.begin(115200);
+  while (!Serial) delay(10);     // will pause Zero, Leonardo, etc until serial console opens
+
+  Serial.println("Adafruit SCD30 template driver test!");
+
+  // Try to initialize!
+  scd30.transport().setDevice(&scd30_dev);
+  if (!scd30.begin()) {
+    Serial.println("Failed to find SCD30 chip");
+    while (1) { delay(10); }
+  }
+  Serial.println("SCD30 Found!");
+}
+
+void loop() {
+  if (scd30.dataReady()) {
+    if (!scd30.read()){ Serial.println("Error reading sensor data"); return; }
+
+    Serial.print("Temperature: ");
+    Serial.print(scd30.temperature);
+    Serial.println(" degrees C");
+
+    Serial.print("Relative Humidity: ");
+    Serial.print(scd30.relative_humidity);
+    Serial.println(" %");
+
+    Serial.print("CO2: ");
+    Serial.print(scd30.CO2, 3);
+    Serial.println(" ppm");
+    Serial.println("");
+  }
+
+  delay(100);
+}
@@ -0,0 +1,160 @@
+/*!
+ *  @file bench_adaptive.cpp
+ *
+ * 	Bus cost of a simulated day of an office's CO2 read at a fixed 2 s
+ * 	interval, next to the same day with Adafruit_SCD30_AdaptiveInterval
+ * 	between 2 and 300 s. Samples are taken on the RDY pin's interrupt, so
+ * 	the bus carries only the reads and the interval changes; polling
+ * 	dataReady() over the bus would add the same cost per check to both.
+ * 	"max error" is the furthest the last reading got from the room's CO2.
+ *
+ *
+ *	 BSD (see license.txt)
+ */
+
+#include "sim_scd30.h"
+#include <Adafruit_SCD30_Adaptive.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCH_DAY_MS 86400000UL ///< Length of the trace
+#define BENCH_STEP_MS 100       ///< Time between passes through `loop()`
+#define BENCH_READY_PIN 5       ///< Host pin wired to RDY
+#define HOUR_MS 3600000.0       ///< An hour in ms
+
+static SimSCD30 sensor;
+static Adafruit_SCD30 scd30;
+
+/** What one day cost */
+typedef struct {
+  uint32_t samples;      ///< Samples read
+  uint32_t transactions; ///< I2C transfers
+  uint32_t bytes;        ///< Bytes moved
+  uint32_t writes;       ///< Interval writes
+  uint16_t max_interval; ///< Longest interval used, seconds
+  float max_error;       ///< Furthest the last reading got from the room
+} run_t;
+
+/**
+ * @brief CO2 of a room that settles towards a level
+ *
+ * @param from CO2 at the start, ppm
+ * @param to The level it settles towards, ppm
+ * @param hours Time since the start
+ * @param tau_hours Time constant
+ * @return float CO2 in ppm
+ */
+static float settle(float from, float to, double hours, double tau_hours) {
+  return to + (from - to) * exp(-hours / tau_hours);
+}
+
+/**
+ * @brief CO2 of an office over a day: empty at night, filling up in the
+ * morning and afternoon and airing out over lunch and the evening
+ *
+ * @param ms Time of day
+ * @return float CO2 in ppm
+ */
+static float office(uint32_t ms) {
+  double h = ms / HOUR_MS;
+  if (h < 8) {
+    return 420;
+  }
+  float noon = settle(420, 1400, 4, 1);
+  if (h < 12) {
+    return settle(420, 1400, h - 8, 1);
+  }
+  float lunch = settle(noon, 600, 1, 0.5);
+  if (h < 13) {
+    return settle(noon, 600, h - 12, 0.5);
+  }
+  float evening = settle(lunch, 1400, 4, 1);
+  if (h < 17) {
+    return settle(lunch, 1400, h - 13, 1);
+  }
+  return settle(evening, 420, h - 17, 1.5);
+}
+
+/**
+ * @brief Run through the day, reading every sample, with the room's CO2 and
+ * a few ppm of noise on the simulated sensor
+ *
+ * @param adaptive The adaptive interval, or NULL for the fixed interval
+ * @param run Where to store the cost
+ * @return true: success false: the driver failed or broke the write/read gap
+ */
+static bool run_day(Adafruit_SCD30_AdaptiveInterval *adaptive, run_t *run) {
+  sim_reset();
+  sensor = SimSCD30();
+  sensor.ready_pin = BENCH_READY_PIN;
+  sim_attach(&sensor, SCD30_I2CADDR_DEFAULT);
+  host_set_pin(BENCH_READY_PIN, LOW);
+  if (!scd30.begin(SCD30_I2CADDR_DEFAULT, &Wire, 0, BENCH_READY_PIN)) {
+    return false;
+  }
+  if (adaptive && !adaptive->begin(2, 300)) {
+    return false;
+  }
+
+  srand(22);
+  memset(run, 0, sizeof(*run));
+  run->transactions = sim_bus_stats.transactions;
+  run->bytes = sim_bus_stats.bytes;
+  uint32_t start = millis();
+  for (uint32_t t = 0; t < BENCH_DAY_MS; t += BENCH_STEP_MS) {
+    delay(BENCH_STEP_MS);
+    float co2 = office(millis() - start);
+    sensor.co2 = co2 + (rand() % 11 - 5);
+    sensor.updatePin();
+    if (scd30.dataReady() && scd30.read()) {
+      run->samples++;
+      if (adaptive) {
+        adaptive->update();
+      }
+    }
+    if (run->samples && (fabsf(scd30.CO2 - co2) > run->max_error)) {
+      run->max_error = fabsf(scd30.CO2 - co2);
+    }
+    if (sensor.interval > run->max_interval) {
+      run->max_interval = sensor.interval;
+    }
+  }
+  run->transactions = sim_bus_stats.transactions - run->transactions;
+  run->bytes = sim_bus_stats.bytes - run->bytes;
+  run->writes = adaptive ? adaptive->getWrites() : 0;
+  return !sensor.gap_violations;
+}
+
+/**
+ * @brief Print one line of the table
+ *
+ * @param name The interval control
+ * @param run The cost of the day
+ */
+static void report(const char *name, const run_t *run) {
+  printf("%-10s %8lu %8lu %9lu %7lu %10u %10.1f\n", name,
+         (unsigned long)run->samples, (unsigned long)run->transactions,
+         (unsigned long)run->bytes, (unsigned long)run->writes,
+         run->max_interval, run->max_error);
+}
+
+int main(void) {
+  run_t fixed, adaptive;
+  Adafruit_SCD30_AdaptiveInterval controller(&scd30);
+  if (!run_day(NULL, &fixed) || !run_day(&controller, &adaptive)) {
+    printf("a run failed to start or broke the write/read gap\n");
+    return 1;
+  }
+
+  printf("%-10s %8s %8s %9s %7s %10s %10s\n", "interval", "samples", "xfers",
+         "bytes", "writes", "longest s", "max error");
+  report("fixed 2 s", &fixed);
+  report("adaptive", &adaptive);
+  printf("transfers saved over the day: %lu (%.1f%%)\n",
+         (unsigned long)(fixed.transactions - adaptive.transactions),
+         100.0 * (fixed.transactions - adaptive.transactions) /
+             fixed.transactions);
+  return (adaptive.transactions < fixed.transactions) ? 0 : 1;
+}
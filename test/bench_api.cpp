@@ -0,0 +1,96 @@
+/*!
+ *  @file bench_api.cpp
+ *
+ * 	Bus cost of each Adafruit SCD30 API call against the simulated sensor:
+ * 	I2C transactions, bytes moved and simulated wall time, which includes
+ * 	the bus time at 100 kHz and any waits the call makes.
+ *
+ *
+ *	 BSD (see license.txt)
+ */
+
+#include "sim_scd30.h"
+#include <Adafruit_SCD30.h>
+#include <stdio.h>
+
+#define BENCH_RUNS 10 ///< Calls averaged per line
+
+/** Average the bus cost of `call` over `BENCH_RUNS` calls and print it */
+#define BENCH(name, call)                                                      \
+  do {                                                                         \
+    sim_bus_stats_t before = sim_bus_stats;                                    \
+    uint64_t start = host_time_us();                                           \
+    for (int run = 0; run < BENCH_RUNS; run++) {                               \
+      call;                                                                    \
+    }                                                                          \
+    report(name, &before, host_time_us() - start);                             \
+  } while (0)
+
+/**
+ * @brief Print one line of the table
+ *
+ * @param name The call
+ * @param before The bus totals before the calls
+ * @param elapsed_us Simulated time taken by the calls
+ */
+static void report(const char *name, const sim_bus_stats_t *before,
+                   uint64_t elapsed_us) {
+  printf("%-34s %6.1f %7.1f %9.1f\n", name,
+         (double)(sim_bus_stats.transactions - before->transactions) /
+             BENCH_RUNS,
+         (double)(sim_bus_stats.bytes - before->bytes) / BENCH_RUNS,
+         (double)elapsed_us / BENCH_RUNS);
+}
+
+/**
+ * @brief Complete a non-blocking read, spinning on `pollRead`
+ *
+ * @param scd30 The driver
+ * @return scd30_read_status_t The final state of the read
+ */
+static scd30_read_status_t read_cycle(Adafruit_SCD30 *scd30) {
+  if (!scd30->beginRead()) {
+    return SCD30_READ_ERROR;
+  }
+  scd30_read_status_t status;
+  do {
+    status = scd30->pollRead();
+  } while (status == SCD30_READ_PENDING);
+  return status;
+}
+
+int main(void) {
+  static SimSCD30 sensor;
+  static Adafruit_SCD30 scd30;
+  static Adafruit_I2CDevice device(SCD30_I2CADDR_DEFAULT);
+  static Adafruit_SCD30_I2CDriver driver;
+  scd30_config_t config;
+
+  sim_reset();
+  sim_attach(&sensor, SCD30_I2CADDR_DEFAULT);
+  driver.transport().setDevice(&device);
+
+  printf("%-34s %6s %7s %9s\n", "call (average of 10)", "xfers", "bytes",
+         "sim us");
+  BENCH("begin()", scd30.begin());
+  delay(2000);
+  BENCH("dataReady()", scd30.dataReady());
+  BENCH("read()", scd30.read());
+  BENCH("beginRead() until pollRead() done", read_cycle(&scd30));
+  BENCH("getMeasurementInterval()", scd30.getMeasurementInterval());
+  BENCH("setMeasurementInterval(2)", scd30.setMeasurementInterval(2));
+  BENCH("getConfig()", scd30.getConfig(&config));
+  BENCH("refreshConfig()", scd30.refreshConfig());
+  BENCH("getFirmwareRevision()", scd30.getFirmwareRevision());
+  BENCH("reset()", scd30.reset());
+  BENCH("template begin()", driver.begin());
+  BENCH("template dataReady()", driver.dataReady());
+  BENCH("template read()", driver.read());
+
+  if (sensor.gap_violations) {
+    printf("%lu reads broke the write/read gap\n",
+           (unsigned long)sensor.gap_violations);
+    return 1;
+  }
+  return 0;
+}
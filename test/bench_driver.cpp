@@ -0,0 +1,134 @@
+/*!
+ *  @file bench_driver.cpp
+ *
+ * 	Speed and size of a blocking read() through Adafruit_SCD30, which talks
+ * 	to its transport through the virtual interface, next to the
+ * 	Adafruit_SCD30_Driver template on the same transport by reference and
+ * 	on a transport held by value. The bus and clock are fakes that answer at
+ * 	once, so only the driver's own work is timed. "object" is the RAM the
+ * 	driver takes; run `size` on size_driver and size_driver_template for the
+ * 	code a program using each one links in.
+ *
+ *
+ *	 BSD (see license.txt)
+ */
+
+#include <Adafruit_SCD30.h>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCH_SECONDS 0.25 ///< Minimum time per measurement
+
+/** A measurement of 400 ppm, 21.5 degrees C and 45 % */
+static const uint16_t measurement[6] = {0x43C8, 0x0000, 0x41AC,
+                                        0x0000, 0x4234, 0x0000};
+
+/*!
+ *    @brief  Transport that answers every request at once with a measurement
+ */
+class FakeTransport : public Adafruit_SCD30_Transport {
+public:
+  /** @brief Nothing to set up
+      @return true */
+  bool begin(void) { return true; }
+  /** @brief Drop a command
+      @param command Unused
+      @return true */
+  bool write(uint16_t command) {
+    (void)command;
+    return true;
+  }
+  /** @brief Drop a command
+      @param command Unused
+      @param argument Unused
+      @return true */
+  bool write(uint16_t command, uint16_t argument) {
+    (void)command;
+    (void)argument;
+    return true;
+  }
+  /** @brief Accept a request
+      @param command Unused
+      @param words Unused
+      @return true */
+  bool request(uint16_t command, uint8_t words) {
+    (void)command;
+    (void)words;
+    return true;
+  }
+  /** @brief Answer with the measurement
+      @param words Where to store the response
+      @param count The number of words requested
+      @return `SCD30_READ_READY` */
+  scd30_read_status_t poll(uint16_t *words, uint8_t count) {
+    memcpy(words, measurement, count * sizeof(uint16_t));
+    return SCD30_READ_READY;
+  }
+};
+
+/*!
+ *    @brief  Clock that never waits
+ */
+struct FakeClock {
+  /** @brief Get the time
+      @return 0 */
+  static uint32_t millis(void) { return 0; }
+  /** @brief Get the time in microseconds
+      @return 0 */
+  static uint32_t micros(void) { return 0; }
+  /** @brief Return at once
+      @param ms Unused */
+  static void delay(uint32_t ms) { (void)ms; }
+};
+
+static FakeTransport transport;
+static Adafruit_SCD30 scd30;
+static Adafruit_SCD30_Driver<Adafruit_SCD30_TransportRef, FakeClock>
+    by_reference{Adafruit_SCD30_TransportRef(&transport)};
+static Adafruit_SCD30_Driver<FakeTransport, FakeClock> by_value;
+
+/**
+ * @brief Call `read()` until `BENCH_SECONDS` have passed
+ *
+ * @param driver The driver
+ * @return double Nanoseconds per call
+ */
+template <class Driver> static double measure(Driver *driver) {
+  typedef std::chrono::steady_clock clock;
+  clock::time_point start = clock::now();
+  double elapsed;
+  uint32_t calls = 0, failed = 0;
+  do {
+    for (int i = 0; i < 1000; i++) {
+      failed += !driver->read();
+    }
+    calls += 1000;
+    elapsed = std::chrono::duration<double>(clock::now() - start).count();
+  } while (elapsed < BENCH_SECONDS);
+  if (failed || (driver->CO2 != 400)) {
+    printf("read() failed\n");
+    exit(1);
+  }
+  return elapsed * 1e9 / calls;
+}
+
+int main(void) {
+  if (!scd30.begin(&transport)) {
+    printf("begin() failed\n");
+    return 1;
+  }
+
+  double full = measure(&scd30);
+  double ref = measure(&by_reference);
+  double value = measure(&by_value);
+  printf("%-38s %10s %8s\n", "read() through", "ns/call", "object");
+  printf("%-38s %10.1f %8u\n", "Adafruit_SCD30", full,
+         (unsigned)sizeof(scd30));
+  printf("%-38s %10.1f %8u\n", "Adafruit_SCD30_Driver, by reference", ref,
+         (unsigned)sizeof(by_reference));
+  printf("%-38s %10.1f %8u\n", "Adafruit_SCD30_Driver, by value", value,
+         (unsigned)sizeof(by_value));
+  return 0;
+}
@@ -0,0 +1,146 @@
+/*!
+ *  @file bench_filter.cpp
+ *
+ * 	Cost of the fixed point filter stages per value, and of a full sample
+ * 	through Adafruit_SCD30_Filter with a median and an average on CO2 and a
+ * 	Kalman filter on temperature. The median's sorted insertion is shown
+ * 	next to sorting a copy of the window with qsort() for every value.
+ *
+ *
+ *	 BSD (see license.txt)
+ */
+
+#include <Adafruit_SCD30_Filter.h>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCH_VALUES 4096  ///< Values per batch
+#define BENCH_SECONDS 0.25 ///< Minimum time per measurement
+
+static int32_t values[BENCH_VALUES];
+static volatile int32_t sink; ///< Keeps the results from being optimized out
+
+/*!
+ *    @brief  Median taken by sorting a copy of the window for every value
+ */
+template <uint8_t SIZE> class SortedCopyMedian {
+public:
+  /** @brief Add a value
+      @param value The value
+      @return The median of the window */
+  int32_t update(int32_t value) {
+    _window[_head] = value;
+    _head = (_head + 1) % SIZE;
+    if (_count < SIZE) {
+      _count++;
+    }
+    int32_t sorted[SIZE];
+    memcpy(sorted, _window, _count * sizeof(int32_t));
+    qsort(sorted, _count, sizeof(int32_t), compare);
+    return sorted[_count / 2];
+  }
+
+private:
+  /** @brief Order two values for `qsort`
+      @param a The first value
+      @param b The second value
+      @return Negative, zero or positive as `a` is below, at or above `b` */
+  static int compare(const void *a, const void *b) {
+    int32_t x = *(const int32_t *)a, y = *(const int32_t *)b;
+    return (x > y) - (x < y);
+  }
+
+  int32_t _window[SIZE]; ///< Ring of the last values
+  uint8_t _head = 0;     ///< Next slot to write
+  uint8_t _count = 0;    ///< Values in the window
+};
+
+/**
+ * @brief Run batches of values through a filter until `BENCH_SECONDS` have
+ * passed
+ *
+ * @param filter The filter
+ * @return double Nanoseconds per value
+ */
+template <class Filter> static double measure(Filter *filter) {
+  typedef std::chrono::steady_clock clock;
+  clock::time_point start = clock::now();
+  double elapsed;
+  uint32_t batches = 0;
+  do {
+    int32_t last = 0;
+    for (int i = 0; i < BENCH_VALUES; i++) {
+      last = filter->update(values[i]);
+    }
+    sink = last;
+    batches++;
+    elapsed = std::chrono::duration<double>(clock::now() - start).count();
+  } while (elapsed < BENCH_SECONDS);
+  return elapsed * 1e9 / ((double)batches * BENCH_VALUES);
+}
+
+/*!
+ *    @brief  Runs a value through a whole pipeline as the CO2 of a sample
+ */
+class Pipeline {
+public:
+  /** @brief Set up the stages */
+  Pipeline() : _ema(3), _kalman(4, 900) {
+    _filter.addStage(SCD30_CHANNEL_CO2, &_median);
+    _filter.addStage(SCD30_CHANNEL_CO2, &_ema);
+    _filter.addStage(SCD30_CHANNEL_TEMPERATURE, &_kalman);
+  }
+  /** @brief Filter a sample built from a value
+      @param value The CO2 value
+      @return The filtered CO2 */
+  int32_t update(int32_t value) {
+    scd30_compact_sample_t raw = {(uint32_t)value, (int16_t)(value & 0x7FF),
+                                  5000};
+    _filter.update(&raw);
+    scd30_compact_sample_t filtered;
+    _filter.getFiltered(&filtered);
+    return filtered.co2;
+  }
+
+private:
+  Adafruit_SCD30_Filter _filter;    ///< The pipeline
+  Adafruit_SCD30_Median<5> _median; ///< CO2 spike rejection
+  Adafruit_SCD30_EMA _ema;          ///< CO2 smoothing
+  Adafruit_SCD30_Kalman _kalman;    ///< Temperature smoothing
+};
+
+int main(void) {
+  // CO2 around 800 ppm in 0.1 ppm, with an occasional spike
+  srand(1);
+  for (int i = 0; i < BENCH_VALUES; i++) {
+    values[i] = 8000 + rand() % 400 - 200;
+    if (i % 61 == 0) {
+      values[i] += 20000;
+    }
+  }
+
+  Adafruit_SCD30_Median<5> median5;
+  Adafruit_SCD30_Median<15> median15;
+  Adafruit_SCD30_Median<31> median31;
+  SortedCopyMedian<5> sorted5;
+  SortedCopyMedian<15> sorted15;
+  SortedCopyMedian<31> sorted31;
+  Adafruit_SCD30_EMA ema(3);
+  Adafruit_SCD30_Kalman kalman(4, 90000);
+  Pipeline pipeline;
+
+  printf("%-38s %10s\n", "filter", "ns/value");
+  printf("%-38s %10.1f\n", "Adafruit_SCD30_Median<5>", measure(&median5));
+  printf("%-38s %10.1f\n", "  sorted copy of 5", measure(&sorted5));
+  printf("%-38s %10.1f\n", "Adafruit_SCD30_Median<15>", measure(&median15));
+  printf("%-38s %10.1f\n", "  sorted copy of 15", measure(&sorted15));
+  printf("%-38s %10.1f\n", "Adafruit_SCD30_Median<31>", measure(&median31));
+  printf("%-38s %10.1f\n", "  sorted copy of 31", measure(&sorted31));
+  printf("%-38s %10.1f\n", "Adafruit_SCD30_EMA", measure(&ema));
+  printf("%-38s %10.1f\n", "Adafruit_SCD30_Kalman", measure(&kalman));
+  printf("%-38s %10.1f\n", "Adafruit_SCD30_Filter, 3 stages",
+         measure(&pipeline));
+  return 0;
+}
@@ -0,0 +1,75 @@
+/*!
+ *  @file bench_frame.cpp
+ *
+ * 	Throughput of the bulk frame decoder in frames per second, for the code
+ * 	path this build selects and for the scalar decoder next to it. Built
+ * 	once per native code path.
+ *
+ *
+ *	 BSD (see license.txt)
+ */
+
+#include <Adafruit_SCD30_Frame.h>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCH_FRAMES 4096  ///< Frames per batch, about 72 kB
+#define BENCH_SECONDS 0.25 ///< Minimum time per measurement
+
+#if defined(SCD30_FRAME_SSSE3)
+#define FRAME_PATH "SSSE3" ///< Code path measured
+#elif defined(SCD30_FRAME_NEON)
+#define FRAME_PATH "NEON" ///< Code path measured
+#else
+#define FRAME_PATH "scalar" ///< Code path measured
+#endif
+
+/** A bulk decoder */
+typedef size_t (*decoder_t)(const uint8_t *, size_t, float *, float *,
+                            float *, uint8_t *);
+
+static uint8_t frames[BENCH_FRAMES * SCD30_FRAME_SIZE];
+static float co2[BENCH_FRAMES], temperature[BENCH_FRAMES],
+    humidity[BENCH_FRAMES];
+static uint8_t valid[BENCH_FRAMES];
+
+/**
+ * @brief Decode batches until `BENCH_SECONDS` have passed
+ *
+ * @param decode The decoder
+ * @return double Frames decoded per second
+ */
+static double measure(decoder_t decode) {
+  typedef std::chrono::steady_clock clock;
+  clock::time_point start = clock::now();
+  double elapsed;
+  size_t batches = 0, good = 0;
+  do {
+    good += decode(frames, BENCH_FRAMES, co2, temperature, humidity, valid);
+    batches++;
+    elapsed = std::chrono::duration<double>(clock::now() - start).count();
+  } while (elapsed < BENCH_SECONDS);
+  if (good != batches * BENCH_FRAMES) {
+    printf("decoder rejected good frames\n");
+    exit(1);
+  }
+  return batches * BENCH_FRAMES / elapsed;
+}
+
+int main(void) {
+  for (size_t i = 0; i < sizeof(frames); i += 3) {
+    frames[i] = rand();
+    frames[i + 1] = rand();
+    frames[i + 2] = scd30_crc8(frames + i, 2);
+  }
+
+  double scalar = measure(scd30_decode_frames_scalar);
+  double fast = measure(scd30_decode_frames);
+  printf("%-34s %12s\n", "decoder", "Mframes/s");
+  printf("%-34s %12.1f\n", "scd30_decode_frames_scalar()", scalar / 1e6);
+  printf("%-34s %12.1f  (%.1fx)\n", "scd30_decode_frames() " FRAME_PATH,
+         fast / 1e6, fast / scalar);
+  return 0;
+}
@@ -0,0 +1,194 @@
+/*!
+ *  @file bench_manager.cpp
+ *
+ * 	Cost of polling several simulated SCD30s behind a TCA9548A with
+ * 	Adafruit_SCD30_Manager, next to a plain loop that selects each sensor
+ * 	and calls the blocking dataReady() and read(). Both run for the same
+ * 	simulated minute with `loop()` doing 100 us of other work per pass.
+ * 	Transfers, bytes, bus time and time blocked in the library are given
+ * 	per sample; "blocked %" is the share of the minute spent in the library.
+ * 	The host clock moves 1 us on every `micros()` or `millis()` call, so the
+ * 	manager's idle passes each count a few us of blocked time.
+ *
+ *
+ *	 BSD (see license.txt)
+ */
+
+#include "sim_scd30.h"
+#include <Adafruit_SCD30_Manager.h>
+#include <stdio.h>
+
+#define BENCH_MAX_SENSORS 8    ///< Most sensors simulated
+#define BENCH_RUN_US 60000000  ///< Simulated time per run
+#define BENCH_LOOP_WORK_US 100 ///< Other work done per pass through `loop()`
+#define BENCH_MUX_ADDRESS 0x70 ///< Multiplexer address
+
+static SimSCD30 sensors[BENCH_MAX_SENSORS];
+static SimMux mux;
+static Adafruit_SCD30 drivers[BENCH_MAX_SENSORS];
+static Adafruit_I2CDevice mux_device(BENCH_MUX_ADDRESS);
+
+/** What one run cost */
+typedef struct {
+  uint32_t samples;      ///< Samples read
+  uint32_t transactions; ///< I2C transfers
+  uint32_t bytes;        ///< Bytes moved
+  uint64_t busy_us;      ///< Time the transfers took on the wire
+  uint64_t blocked_us;   ///< Time spent inside the library
+  uint32_t violations;   ///< Reads that broke the write/read gap
+} run_t;
+
+/**
+ * @brief Open one multiplexer channel
+ *
+ * @param channel The channel
+ * @return true: success false: the multiplexer didn't answer
+ */
+static bool open_channel(uint8_t channel) {
+  uint8_t mask = 1 << channel;
+  return mux_device.write(&mask, 1);
+}
+
+/**
+ * @brief Put `count` freshly powered sensors behind the multiplexer and start
+ * their drivers
+ *
+ * @param count The number of sensors
+ * @return true: success false: a driver did not start
+ */
+static bool setup_sensors(uint8_t count) {
+  sim_reset();
+  mux = SimMux();
+  sim_attach(&mux, BENCH_MUX_ADDRESS);
+  for (uint8_t i = 0; i < count; i++) {
+    sensors[i] = SimSCD30();
+    sim_attach(&sensors[i], SCD30_I2CADDR_DEFAULT, &Wire, &mux, i);
+    if (!open_channel(i) || !drivers[i].begin()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief Note the bus totals at the start of a run
+ *
+ * @param run The run
+ */
+static void start_run(run_t *run) {
+  memset(run, 0, sizeof(*run));
+  run->transactions = sim_bus_stats.transactions;
+  run->bytes = sim_bus_stats.bytes;
+  run->busy_us = sim_bus_stats.busy_us;
+}
+
+/**
+ * @brief Turn the bus totals into the cost of the run
+ *
+ * @param run The run
+ * @param count The number of sensors
+ */
+static void end_run(run_t *run, uint8_t count) {
+  run->transactions = sim_bus_stats.transactions - run->transactions;
+  run->bytes = sim_bus_stats.bytes - run->bytes;
+  run->busy_us = sim_bus_stats.busy_us - run->busy_us;
+  for (uint8_t i = 0; i < count; i++) {
+    run->violations += sensors[i].gap_violations;
+  }
+}
+
+/**
+ * @brief Poll with Adafruit_SCD30_Manager
+ *
+ * @param count The number of sensors
+ * @param run Where to store the cost
+ * @return true: success false: setup failed
+ */
+static bool run_manager(uint8_t count, run_t *run) {
+  if (!setup_sensors(count)) {
+    return false;
+  }
+  Adafruit_SCD30_Manager manager;
+  for (uint8_t i = 0; i < count; i++) {
+    manager.addSensor(&drivers[i], &mux_device, i);
+  }
+
+  start_run(run);
+  uint64_t end = host_time_us() + BENCH_RUN_US;
+  while (host_time_us() < end) {
+    uint64_t start = host_time_us();
+    if (manager.poll() >= 0) {
+      run->samples++;
+    }
+    run->blocked_us += host_time_us() - start;
+    host_advance_us(BENCH_LOOP_WORK_US);
+  }
+  end_run(run, count);
+  return true;
+}
+
+/**
+ * @brief Poll each sensor in turn with the blocking calls
+ *
+ * @param count The number of sensors
+ * @param run Where to store the cost
+ * @return true: success false: setup failed
+ */
+static bool run_blocking(uint8_t count, run_t *run) {
+  if (!setup_sensors(count)) {
+    return false;
+  }
+
+  start_run(run);
+  uint64_t end = host_time_us() + BENCH_RUN_US;
+  while (host_time_us() < end) {
+    uint64_t start = host_time_us();
+    for (uint8_t i = 0; i < count; i++) {
+      if (open_channel(i) && drivers[i].dataReady() && drivers[i].read()) {
+        run->samples++;
+      }
+    }
+    run->blocked_us += host_time_us() - start;
+    host_advance_us(BENCH_LOOP_WORK_US);
+  }
+  end_run(run, count);
+  return true;
+}
+
+/**
+ * @brief Print one line of the table
+ *
+ * @param name The polling method
+ * @param count The number of sensors
+ * @param run The cost of the run
+ */
+static void report(const char *name, uint8_t count, const run_t *run) {
+  double samples = run->samples ? run->samples : 1;
+  printf("%-9s %7u %7lu %9.1f %9.1f %11.0f %11.0f %9.2f\n", name, count,
+         (unsigned long)run->samples, run->transactions / samples,
+         run->bytes / samples, run->busy_us / samples,
+         run->blocked_us / samples,
+         100.0 * run->blocked_us / BENCH_RUN_US);
+}
+
+int main(void) {
+  static const uint8_t counts[] = {1, 2, 4, 8};
+  bool ok = true;
+
+  printf("%-9s %7s %7s %9s %9s %11s %11s %9s\n", "method", "sensors",
+         "samples", "xfers", "bytes", "bus us", "blocked us",
+         "blocked %");
+  for (uint8_t c = 0; c < sizeof(counts); c++) {
+    run_t run = {};
+    ok &= run_manager(counts[c], &run) && !run.violations;
+    report("manager", counts[c], &run);
+    ok &= run_blocking(counts[c], &run) && !run.violations;
+    report("blocking", counts[c], &run);
+  }
+
+  if (!ok) {
+    printf("a run failed to start or broke the write/read gap\n");
+    return 1;
+  }
+  return 0;
+}
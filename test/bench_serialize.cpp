@@ -0,0 +1,183 @@
+/*!
+ *  @file bench_serialize.cpp
+ *
+ * 	Speed of the line protocol, JSON and CBOR serializers on a full record,
+ * 	next to snprintf() writing the same JSON and line from float readings,
+ * 	which is what a sketch would do without them. The host has an FPU and a
+ * 	fast divider, so the gap on an 8 bit MCU is wider still.
+ *
+ *
+ *	 BSD (see license.txt)
+ */
+
+#include <Adafruit_SCD30_Serialize.h>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCH_SECONDS 0.25 ///< Minimum time per measurement
+
+static const scd30_config_t config = {2, 1013, 0, 150, 400, 1};
+static scd30_stats_t stats;
+static scd30_record_t record;
+static char text[SCD30_JSON_MAX_SIZE + 64];
+static uint8_t cbor[SCD30_CBOR_MAX_SIZE];
+static volatile size_t sink; ///< Keeps the results from being optimized out
+
+/** A way of writing the record */
+typedef size_t (*writer_t)(void);
+
+/**
+ * @brief Write the record with `scd30_format_json`
+ * @return size_t The length written
+ */
+static size_t json(void) {
+  return scd30_format_json(&record, text, sizeof(text));
+}
+
+/**
+ * @brief Write the record with `scd30_format_line`
+ * @return size_t The length written
+ */
+static size_t line(void) {
+  return scd30_format_line(&record, "scd30", "room=lab", 1700000000, text,
+                           sizeof(text));
+}
+
+/**
+ * @brief Write the record with `scd30_format_cbor`
+ * @return size_t The length written
+ */
+static size_t binary(void) {
+  return scd30_format_cbor(&record, cbor, sizeof(cbor));
+}
+
+/**
+ * @brief Write the same JSON with snprintf, from floats
+ * @return size_t The length written
+ */
+static size_t json_printf(void) {
+  float co2 = record.sample.co2 / 10.0f;
+  float temperature = record.sample.temperature / 100.0f;
+  float humidity = record.sample.humidity / 100.0f;
+  const scd30_config_t *c = record.config;
+  const scd30_stats_t *s = record.stats;
+  return snprintf(
+      text, sizeof(text),
+      "{\"co2\":%.1f,\"temperature\":%.2f,\"humidity\":%.2f,"
+      "\"timestamp\":%lu,\"sequence\":%lu,\"frame\":%lu,"
+      "\"config\":{\"measurement_interval\":%u,\"ambient_pressure\":%u,"
+      "\"altitude_offset\":%u,\"temperature_offset\":%.2f,"
+      "\"forced_calibration_reference\":%u,\"self_calibration\":%s},"
+      "\"stats\":{\"transactions\":%lu,\"bytes_written\":%lu,"
+      "\"bytes_read\":%lu,\"nacks\":%lu,\"retries\":%lu,"
+      "\"crc_errors\":%lu}}",
+      co2, temperature, humidity, (unsigned long)record.timestamp,
+      (unsigned long)record.sequence, (unsigned long)record.frame,
+      c->measurement_interval, c->ambient_pressure, c->altitude_offset,
+      c->temperature_offset / 100.0f, c->forced_calibration_reference,
+      c->self_calibration ? "true" : "false",
+      (unsigned long)s->transactions, (unsigned long)s->bytes_written,
+      (unsigned long)s->bytes_read, (unsigned long)s->nacks,
+      (unsigned long)s->retries, (unsigned long)s->crc_errors[0]);
+}
+
+/**
+ * @brief Write the same line with snprintf, from floats
+ * @return size_t The length written
+ */
+static size_t line_printf(void) {
+  float co2 = record.sample.co2 / 10.0f;
+  float temperature = record.sample.temperature / 100.0f;
+  float humidity = record.sample.humidity / 100.0f;
+  const scd30_config_t *c = record.config;
+  const scd30_stats_t *s = record.stats;
+  return snprintf(
+      text, sizeof(text),
+      "scd30,room=lab co2=%.1f,temperature=%.2f,humidity=%.2f,"
+      "timestamp=%lui,sequence=%lui,frame=%lui,measurement_interval=%ui,"
+      "ambient_pressure=%ui,altitude_offset=%ui,temperature_offset=%.2f,"
+      "forced_calibration_reference=%ui,self_calibration=%s,"
+      "transactions=%lui,bytes_written=%lui,bytes_read=%lui,nacks=%lui,"
+      "retries=%lui,crc_errors=%lui %lu000000000",
+      co2, temperature, humidity, (unsigned long)record.timestamp,
+      (unsigned long)record.sequence, (unsigned long)record.frame,
+      c->measurement_interval, c->ambient_pressure, c->altitude_offset,
+      c->temperature_offset / 100.0f, c->forced_calibration_reference,
+      c->self_calibration ? "true" : "false",
+      (unsigned long)s->transactions, (unsigned long)s->bytes_written,
+      (unsigned long)s->bytes_read, (unsigned long)s->nacks,
+      (unsigned long)s->retries, (unsigned long)s->crc_errors[0],
+      1700000000UL);
+}
+
+/**
+ * @brief Write the record until `BENCH_SECONDS` have passed
+ *
+ * @param writer How to write it
+ * @return double Nanoseconds per record
+ */
+static double measure(writer_t writer) {
+  typedef std::chrono::steady_clock clock;
+  clock::time_point start = clock::now();
+  double elapsed;
+  uint32_t calls = 0;
+  do {
+    size_t total = 0;
+    for (int i = 0; i < 1000; i++) {
+      total += writer();
+      record.sequence++;
+    }
+    sink = total;
+    calls += 1000;
+    elapsed = std::chrono::duration<double>(clock::now() - start).count();
+  } while (elapsed < BENCH_SECONDS);
+  return elapsed * 1e9 / calls;
+}
+
+int main(void) {
+  stats.transactions = 123456;
+  stats.bytes_written = 456789;
+  stats.bytes_read = 1234567;
+  stats.nacks = 3;
+  stats.retries = 5;
+  record.sample.co2 = 8125;
+  record.sample.temperature = 2234;
+  record.sample.humidity = 4150;
+  record.timestamp = 86400000;
+  record.sequence = 43200;
+  record.frame = 43200;
+  record.config = &config;
+  record.stats = &stats;
+
+  // the two ways must agree before they are timed
+  char expected[sizeof(text)];
+  json();
+  strcpy(expected, text);
+  json_printf();
+  if (strcmp(expected, text)) {
+    printf("snprintf JSON differs:\n%s\n%s\n", expected, text);
+    return 1;
+  }
+  line();
+  strcpy(expected, text);
+  line_printf();
+  if (strcmp(expected, text)) {
+    printf("snprintf line differs:\n%s\n%s\n", expected, text);
+    return 1;
+  }
+
+  printf("%-38s %10s %8s\n", "full record", "ns/call", "bytes");
+  printf("%-38s %10.1f %8u\n", "scd30_format_json()", measure(json),
+         (unsigned)json());
+  printf("%-38s %10.1f %8u\n", "  snprintf() from floats",
+         measure(json_printf), (unsigned)json_printf());
+  printf("%-38s %10.1f %8u\n", "scd30_format_line()", measure(line),
+         (unsigned)line());
+  printf("%-38s %10.1f %8u\n", "  snprintf() from floats",
+         measure(line_printf), (unsigned)line_printf());
+  printf("%-38s %10.1f %8u\n", "scd30_format_cbor()", measure(binary),
+         (unsigned)binary());
+  return 0;
+}
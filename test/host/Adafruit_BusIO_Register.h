@@ -0,0 +1,16 @@
+/*!
+ *  @file Adafruit_BusIO_Register.h
+ *
+ * 	Host stand-in for the Adafruit BusIO register header. The SCD30 library
+ * 	only needs the I2C device it brings in.
+ *
+ *
+ *	 license (see license.txt)
+ */
+
+#ifndef _SCD30_HOST_BUSIO_REGISTER_H
+#define _SCD30_HOST_BUSIO_REGISTER_H
+
+#include "Adafruit_I2CDevice.h"
+
+#endif
@@ -0,0 +1,48 @@
+/*!
+ *  @file Adafruit_I2CDevice.h
+ *
+ * 	Host stand-in for the Adafruit BusIO I2C device, backed by the simulated
+ * 	bus in `sim_bus.h`
+ *
+ *
+ *	 license (see license.txt)
+ */
+
+#ifndef _SCD30_HOST_I2CDEVICE_H
+#define _SCD30_HOST_I2CDEVICE_H
+
+#include "Wire.h"
+
+/*!
+ *    @brief  A device on the simulated I2C bus
+ */
+class Adafruit_I2CDevice {
+public:
+  Adafruit_I2CDevice(uint8_t addr, TwoWire *theWire = &Wire);
+
+  /** @brief Get the device's address
+      @return The 7 bit address */
+  uint8_t address(void) { return _addr; }
+  bool begin(bool addr_detect = true);
+  /** @brief Release the device */
+  void end(void) {}
+  bool detected(void);
+
+  bool read(uint8_t *buffer, size_t len, bool stop = true);
+  bool write(const uint8_t *buffer, size_t len, bool stop = true,
+             const uint8_t *prefix_buffer = NULL, size_t prefix_len = 0);
+  bool write_then_read(const uint8_t *write_buffer, size_t write_len,
+                       uint8_t *read_buffer, size_t read_len,
+                       bool stop = false);
+
+  /** @brief Get the largest transfer the bus can make
+      @return The size in bytes */
+  size_t maxBufferSize(void) { return 32; }
+
+private:
+  uint8_t _addr;  ///< The device's address
+  TwoWire *_wire; ///< The bus the device is on
+  bool _begun;    ///< True once `begin` has found the device
+};
+
+#endif
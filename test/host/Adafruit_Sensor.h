@@ -0,0 +1,65 @@
+/*!
+ *  @file Adafruit_Sensor.h
+ *
+ * 	Host stand-in for the parts of the Adafruit Unified Sensor library used
+ * 	by the Adafruit SCD30 library
+ *
+ *
+ *	 license (see license.txt)
+ */
+
+#ifndef _SCD30_HOST_SENSOR_H
+#define _SCD30_HOST_SENSOR_H
+
+#include "Arduino.h"
+
+/** Sensor types used by the SCD30 */
+typedef enum {
+  SENSOR_TYPE_PRESSURE = 6,
+  SENSOR_TYPE_RELATIVE_HUMIDITY = 12,
+  SENSOR_TYPE_AMBIENT_TEMPERATURE = 13,
+} sensors_type_t;
+
+/** A reading from a sensor */
+typedef struct {
+  int32_t version;   ///< Must be `sizeof(sensors_event_t)`
+  int32_t sensor_id; ///< Unique sensor identifier
+  int32_t type;      ///< Sensor type
+  int32_t reserved0; ///< Reserved
+  int32_t timestamp; ///< `millis()` of the reading
+  union {
+    float data[4];           ///< Raw data
+    float temperature;       ///< Temperature in degrees C
+    float relative_humidity; ///< Relative humidity in percent
+    float pressure;          ///< Pressure in hPa
+  };
+} sensors_event_t;
+
+/** Details of a sensor */
+typedef struct {
+  char name[12];     ///< Sensor name
+  int32_t version;   ///< Driver version
+  int32_t sensor_id; ///< Unique sensor identifier
+  int32_t type;      ///< Sensor type
+  float max_value;   ///< Largest value
+  float min_value;   ///< Smallest value
+  float resolution;  ///< Smallest difference between values
+  int32_t min_delay; ///< Shortest time between events in microseconds
+} sensor_t;
+
+/*!
+ *    @brief  Common interface of Unified Sensor drivers
+ */
+class Adafruit_Sensor {
+public:
+  virtual ~Adafruit_Sensor() {}
+  /** @brief Get the latest reading
+      @param event The reading to fill
+      @return true: success false: failure */
+  virtual bool getEvent(sensors_event_t *event) = 0;
+  /** @brief Get the sensor's details
+      @param sensor The details to fill */
+  virtual void getSensor(sensor_t *sensor) = 0;
+};
+
+#endif
@@ -0,0 +1,93 @@
+/*!
+ *  @file Arduino.h
+ *
+ * 	Host stand-in for the parts of the Arduino core used by the Adafruit
+ * 	SCD30 library, so it can be built and tested off target. Time is
+ * 	virtual: it only moves when the code under test waits, reads the clock
+ * 	or uses the simulated bus.
+ *
+ *
+ *	 license (see license.txt)
+ */
+
+#ifndef _SCD30_HOST_ARDUINO_H
+#define _SCD30_HOST_ARDUINO_H
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef bool boolean; ///< Arduino's name for bool
+
+#define LOW 0  ///< Pin level
+#define HIGH 1 ///< Pin level
+
+#define INPUT 0        ///< Pin mode
+#define OUTPUT 1       ///< Pin mode
+#define INPUT_PULLUP 2 ///< Pin mode
+
+#define CHANGE 1  ///< Interrupt on any edge
+#define FALLING 2 ///< Interrupt on a falling edge
+#define RISING 3  ///< Interrupt on a rising edge
+
+#define HOST_PIN_COUNT 64 ///< Number of simulated pins
+
+uint32_t millis(void);
+uint32_t micros(void);
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void yield(void);
+
+void pinMode(uint8_t pin, uint8_t mode);
+int digitalRead(uint8_t pin);
+void digitalWrite(uint8_t pin, uint8_t level);
+int digitalPinToInterrupt(uint8_t pin);
+void attachInterrupt(int interrupt, void (*isr)(void), int mode);
+void detachInterrupt(int interrupt);
+void noInterrupts(void);
+void interrupts(void);
+
+uint64_t host_time_us(void);
+void host_set_time_us(uint64_t us);
+void host_advance_us(uint64_t us);
+void host_set_pin(uint8_t pin, uint8_t level);
+
+/*!
+ *    @brief  Byte stream, as implemented by the Arduino serial ports
+ */
+class Stream {
+public:
+  virtual ~Stream() {}
+
+  /** @brief Send a byte
+      @param byte The byte to send
+      @return The number of bytes sent */
+  virtual size_t write(uint8_t byte) = 0;
+
+  /** @brief Send several bytes
+      @param buffer The bytes to send
+      @param len The number of bytes
+      @return The number of bytes sent */
+  virtual size_t write(const uint8_t *buffer, size_t len) {
+    size_t sent = 0;
+    while ((sent < len) && write(buffer[sent])) {
+      sent++;
+    }
+    return sent;
+  }
+
+  /** @brief Get the number of bytes waiting to be read
+      @return The number of bytes */
+  virtual int available(void) = 0;
+
+  /** @brief Read a byte
+      @return The byte, or -1 if there is none */
+  virtual int read(void) = 0;
+
+  /** @brief Wait for sent bytes to leave */
+  virtual void flush(void) {}
+};
+
+#endif
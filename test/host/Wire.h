@@ -0,0 +1,34 @@
+/*!
+ *  @file Wire.h
+ *
+ * 	Host stand-in for the Arduino I2C bus. Transfers go to the simulated
+ * 	targets attached with `sim_attach`.
+ *
+ *
+ *	 license (see license.txt)
+ */
+
+#ifndef _SCD30_HOST_WIRE_H
+#define _SCD30_HOST_WIRE_H
+
+#include "Arduino.h"
+
+/*!
+ *    @brief  An I2C bus. Only identifies the bus; the transfers are made by
+ *            `Adafruit_I2CDevice`.
+ */
+class TwoWire {
+public:
+  /** @brief Set up the bus */
+  void begin(void) {}
+  /** @brief Set the bus clock
+      @param hz The clock in Hz */
+  void setClock(uint32_t hz) { clock = hz; }
+
+  uint32_t clock = 100000; ///< Bus clock in Hz, sets the simulated bus time
+};
+
+extern TwoWire Wire;  ///< The first I2C bus
+extern TwoWire Wire1; ///< The second I2C bus
+
+#endif
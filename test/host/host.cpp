@@ -0,0 +1,175 @@
+/*!
+ *  @file host.cpp
+ *
+ * 	Virtual clock and pins behind the host stand-in for the Arduino core.
+ *
+ * 	Every clock read costs a microsecond, so that code spinning on
+ * 	`micros()` or `millis()` still sees time pass.
+ *
+ *
+ *	 BSD (see license.txt)
+ */
+
+#include "Arduino.h"
+#include "Wire.h"
+#include <atomic>
+
+TwoWire Wire;
+TwoWire Wire1;
+
+static std::atomic<uint64_t> now_us(0);
+static uint8_t pin_levels[HOST_PIN_COUNT];
+static void (*pin_isrs[HOST_PIN_COUNT])(void);
+static int pin_modes[HOST_PIN_COUNT];
+
+/**
+ * @brief Get the virtual time without moving it
+ *
+ * @return uint64_t Microseconds since the start of the run
+ */
+uint64_t host_time_us(void) { return now_us.load(); }
+
+/**
+ * @brief Set the virtual time
+ *
+ * @param us Microseconds since the start of the run
+ */
+void host_set_time_us(uint64_t us) { now_us.store(us); }
+
+/**
+ * @brief Move the virtual time forward
+ *
+ * @param us Microseconds to move it by
+ */
+void host_advance_us(uint64_t us) { now_us.fetch_add(us); }
+
+/**
+ * @brief Drive a simulated pin, running its interrupt handler on a matching
+ * edge
+ *
+ * @param pin The pin to drive
+ * @param level `HIGH` or `LOW`
+ */
+void host_set_pin(uint8_t pin, uint8_t level) {
+  if (pin >= HOST_PIN_COUNT) {
+    return;
+  }
+  uint8_t previous = pin_levels[pin];
+  pin_levels[pin] = level;
+
+  bool rising = (previous == LOW) && (level == HIGH);
+  bool falling = (previous == HIGH) && (level == LOW);
+  int mode = pin_modes[pin];
+  if (pin_isrs[pin] && ((rising && (mode != FALLING)) ||
+                        (falling && (mode != RISING)))) {
+    pin_isrs[pin]();
+  }
+}
+
+/**
+ * @brief Get the time since the start of the run
+ *
+ * @return uint32_t The time in microseconds
+ */
+uint32_t micros(void) { return (uint32_t)(now_us.fetch_add(1) + 1); }
+
+/**
+ * @brief Get the time since the start of the run
+ *
+ * @return uint32_t The time in milliseconds
+ */
+uint32_t millis(void) { return (uint32_t)((now_us.fetch_add(1) + 1) / 1000); }
+
+/**
+ * @brief Wait for a while
+ *
+ * @param ms The time to wait in milliseconds
+ */
+void delay(uint32_t ms) { host_advance_us((uint64_t)ms * 1000); }
+
+/**
+ * @brief Wait for a short while
+ *
+ * @param us The time to wait in microseconds
+ */
+void delayMicroseconds(uint32_t us) { host_advance_us(us); }
+
+/**
+ * @brief Let other tasks run, which takes a microsecond here
+ */
+void yield(void) { host_advance_us(1); }
+
+/**
+ * @brief Set the mode of a pin. Modes are not simulated
+ *
+ * @param pin The pin
+ * @param mode The mode
+ */
+void pinMode(uint8_t pin, uint8_t mode) {
+  (void)pin;
+  (void)mode;
+}
+
+/**
+ * @brief Read the level of a simulated pin
+ *
+ * @param pin The pin
+ * @return int `HIGH` or `LOW`
+ */
+int digitalRead(uint8_t pin) {
+  return (pin < HOST_PIN_COUNT) ? pin_levels[pin] : LOW;
+}
+
+/**
+ * @brief Drive a simulated pin
+ *
+ * @param pin The pin
+ * @param level `HIGH` or `LOW`
+ */
+void digitalWrite(uint8_t pin, uint8_t level) { host_set_pin(pin, level); }
+
+/**
+ * @brief Get the interrupt of a pin; every simulated pin has its own
+ *
+ * @param pin The pin
+ * @return int The interrupt number, -1 if there is none
+ */
+int digitalPinToInterrupt(uint8_t pin) {
+  return (pin < HOST_PIN_COUNT) ? pin : -1;
+}
+
+/**
+ * @brief Run a handler when a simulated pin changes
+ *
+ * @param interrupt The interrupt, from `digitalPinToInterrupt`
+ * @param isr The handler
+ * @param mode `RISING`, `FALLING` or `CHANGE`
+ */
+void attachInterrupt(int interrupt, void (*isr)(void), int mode) {
+  if ((interrupt >= 0) && (interrupt < HOST_PIN_COUNT)) {
+    pin_isrs[interrupt] = isr;
+    pin_modes[interrupt] = mode;
+  }
+}
+
+/**
+ * @brief Stop running the handler of a simulated pin
+ *
+ * @param interrupt The interrupt, from `digitalPinToInterrupt`
+ */
+void detachInterrupt(int interrupt) {
+  if ((interrupt >= 0) && (interrupt < HOST_PIN_COUNT)) {
+    pin_isrs[interrupt] = NULL;
+  }
+}
+
+/**
+ * @brief Mask interrupts. Handlers only run from `host_set_pin`, so there is
+ * nothing to mask
+ */
+void noInterrupts(void) {}
+
+/**
+ * @brief Unmask interrupts
+ */
+void interrupts(void) {}
@@ -0,0 +1,174 @@
+/*!
+ *  @file arm_neon.h
+ *
+ * 	Portable stand-in for the AArch64 NEON intrinsics the bulk frame decoder
+ * 	uses, written lane by lane from the Arm reference, so the NEON path of
+ * 	Adafruit_SCD30_Frame.cpp can be built and checked on any host. Only on
+ * 	the include path of the `*_neon` test targets; real AArch64 builds use
+ * 	the compiler's header.
+ *
+ *
+ *	 license (see license.txt)
+ */
+
+#ifndef _SCD30_TEST_ARM_NEON_H
+#define _SCD30_TEST_ARM_NEON_H
+
+#include <stdint.h>
+
+/** 16 unsigned bytes */
+typedef struct {
+  uint8_t lane[16]; ///< Lanes, lane 0 first in memory
+} uint8x16_t;
+
+/** 8 unsigned bytes */
+typedef struct {
+  uint8_t lane[8]; ///< Lanes, lane 0 first in memory
+} uint8x8_t;
+
+/** Two 16 byte vectors */
+typedef struct {
+  uint8x16_t val[2]; ///< The vectors
+} uint8x16x2_t;
+
+/** Three 16 byte vectors */
+typedef struct {
+  uint8x16_t val[3]; ///< The vectors
+} uint8x16x3_t;
+
+/** @brief LD1: load 16 bytes
+    @param ptr The bytes
+    @return The vector */
+static inline uint8x16_t vld1q_u8(const uint8_t *ptr) {
+  uint8x16_t r;
+  for (int i = 0; i < 16; i++) {
+    r.lane[i] = ptr[i];
+  }
+  return r;
+}
+
+/** @brief LD3: load 48 bytes, deinterleaving every third byte into a vector
+    @param ptr The bytes
+    @return Vector k holds bytes k, k + 3, k + 6, ... */
+static inline uint8x16x3_t vld3q_u8(const uint8_t *ptr) {
+  uint8x16x3_t r;
+  for (int i = 0; i < 16; i++) {
+    for (int k = 0; k < 3; k++) {
+      r.val[k].lane[i] = ptr[3 * i + k];
+    }
+  }
+  return r;
+}
+
+/** @brief ST2: store two vectors, interleaving their bytes
+    @param ptr Where to store 32 bytes
+    @param v The vectors, lane i of vector k going to byte 2i + k */
+static inline void vst2q_u8(uint8_t *ptr, uint8x16x2_t v) {
+  for (int i = 0; i < 16; i++) {
+    for (int k = 0; k < 2; k++) {
+      ptr[2 * i + k] = v.val[k].lane[i];
+    }
+  }
+}
+
+/** @brief DUP: the same byte in every lane
+    @param value The byte
+    @return The vector */
+static inline uint8x16_t vdupq_n_u8(uint8_t value) {
+  uint8x16_t r;
+  for (int i = 0; i < 16; i++) {
+    r.lane[i] = value;
+  }
+  return r;
+}
+
+/** @brief AND of two vectors
+    @param a First vector
+    @param b Second vector
+    @return a & b */
+static inline uint8x16_t vandq_u8(uint8x16_t a, uint8x16_t b) {
+  for (int i = 0; i < 16; i++) {
+    a.lane[i] &= b.lane[i];
+  }
+  return a;
+}
+
+/** @brief EOR of two vectors
+    @param a First vector
+    @param b Second vector
+    @return a ^ b */
+static inline uint8x16_t veorq_u8(uint8x16_t a, uint8x16_t b) {
+  for (int i = 0; i < 16; i++) {
+    a.lane[i] ^= b.lane[i];
+  }
+  return a;
+}
+
+/** @brief USHR: shift every lane right, shifting in zeros
+    @param a The vector
+    @param n The shift, 1 to 8
+    @return a >> n */
+static inline uint8x16_t vshrq_n_u8(uint8x16_t a, int n) {
+  for (int i = 0; i < 16; i++) {
+    a.lane[i] = (n >= 8) ? 0 : (uint8_t)(a.lane[i] >> n);
+  }
+  return a;
+}
+
+/** @brief CMEQ: compare lanes for equality
+    @param a First vector
+    @param b Second vector
+    @return 0xFF in lanes that are equal, 0 elsewhere */
+static inline uint8x16_t vceqq_u8(uint8x16_t a, uint8x16_t b) {
+  for (int i = 0; i < 16; i++) {
+    a.lane[i] = (a.lane[i] == b.lane[i]) ? 0xFF : 0;
+  }
+  return a;
+}
+
+/** @brief TBL: look every lane of `index` up in `table`
+    @param table 16 byte table
+    @param index Indices
+    @return table[index], 0 for indices past the table */
+static inline uint8x16_t vqtbl1q_u8(uint8x16_t table, uint8x16_t index) {
+  uint8x16_t r;
+  for (int i = 0; i < 16; i++) {
+    r.lane[i] = (index.lane[i] < 16) ? table.lane[index.lane[i]] : 0;
+  }
+  return r;
+}
+
+/** @brief The lower half of a vector
+    @param a The vector
+    @return Lanes 0 to 7 */
+static inline uint8x8_t vget_low_u8(uint8x16_t a) {
+  uint8x8_t r;
+  for (int i = 0; i < 8; i++) {
+    r.lane[i] = a.lane[i];
+  }
+  return r;
+}
+
+/** @brief The upper half of a vector
+    @param a The vector
+    @return Lanes 8 to 15 */
+static inline uint8x8_t vget_high_u8(uint8x16_t a) {
+  uint8x8_t r;
+  for (int i = 0; i < 8; i++) {
+    r.lane[i] = a.lane[8 + i];
+  }
+  return r;
+}
+
+/** @brief ADDV: add across the lanes, wrapping at 8 bits
+    @param a The vector
+    @return The sum */
+static inline uint8_t vaddv_u8(uint8x8_t a) {
+  uint8_t sum = 0;
+  for (int i = 0; i < 8; i++) {
+    sum += a.lane[i];
+  }
+  return sum;
+}
+
+#endif
@@ -0,0 +1,245 @@
+/*!
+ *  @file sim_bus.cpp
+ *
+ * 	Simulated I2C bus for host tests of the Adafruit SCD30 library, and the
+ * 	host `Adafruit_I2CDevice` that talks over it
+ *
+ *
+ *	 BSD (see license.txt)
+ */
+
+#include "sim_bus.h"
+#include <Adafruit_I2CDevice.h>
+
+#define SIM_MAX_TARGETS 16 ///< Most targets attached at once
+
+/** A target and where it sits on the buses */
+typedef struct {
+  SimI2CTarget *target; ///< The target
+  TwoWire *wire;        ///< The bus it is on
+  uint8_t address;      ///< Its 7 bit address
+  SimMux *mux;          ///< The multiplexer in front of it, if any
+  uint8_t channel;      ///< The multiplexer channel
+} attachment_t;
+
+sim_bus_stats_t sim_bus_stats;
+
+static attachment_t attachments[SIM_MAX_TARGETS];
+static uint8_t attachment_count = 0;
+
+/**
+ * @brief Take the channel mask written to the multiplexer
+ *
+ * @param buffer The bytes written
+ * @param len The number of bytes
+ * @return true: acknowledged false: not acknowledged
+ */
+bool SimMux::write(const uint8_t *buffer, size_t len) {
+  if (len != 1) {
+    return len == 0;
+  }
+  if (channels != buffer[0]) {
+    selects++;
+  }
+  channels = buffer[0];
+  return true;
+}
+
+/**
+ * @brief Read back the channel mask
+ *
+ * @param buffer Where to put the mask
+ * @param len The number of bytes to read
+ * @return true: acknowledged false: not acknowledged
+ */
+bool SimMux::read(uint8_t *buffer, size_t len) {
+  memset(buffer, channels, len);
+  return true;
+}
+
+/**
+ * @brief Put a target on a simulated bus
+ *
+ * @param target The target
+ * @param address Its 7 bit address
+ * @param wire The bus it is on
+ * @param mux The multiplexer in front of it, NULL if directly attached
+ * @param channel The multiplexer channel
+ * @return true: attached false: too many targets
+ */
+bool sim_attach(SimI2CTarget *target, uint8_t address, TwoWire *wire,
+                SimMux *mux, uint8_t channel) {
+  if (attachment_count >= SIM_MAX_TARGETS) {
+    return false;
+  }
+  attachment_t *attachment = &attachments[attachment_count++];
+  attachment->target = target;
+  attachment->wire = wire;
+  attachment->address = address;
+  attachment->mux = mux;
+  attachment->channel = channel;
+  return true;
+}
+
+/**
+ * @brief Detach every target, zero the bus totals and restart the clock
+ */
+void sim_reset(void) {
+  attachment_count = 0;
+  memset(&sim_bus_stats, 0, sizeof(sim_bus_stats));
+  host_set_time_us(0);
+}
+
+/**
+ * @brief Find the target answering an address, behind any open mux channel
+ *
+ * @param wire The bus
+ * @param address The 7 bit address
+ * @return SimI2CTarget* The target, NULL if nothing answers
+ */
+static SimI2CTarget *find(TwoWire *wire, uint8_t address) {
+  for (uint8_t i = 0; i < attachment_count; i++) {
+    attachment_t *attachment = &attachments[i];
+    if ((attachment->wire != wire) || (attachment->address != address)) {
+      continue;
+    }
+    if (!attachment->mux ||
+        (attachment->mux->channels & (1 << attachment->channel))) {
+      return attachment->target;
+    }
+  }
+  return NULL;
+}
+
+/**
+ * @brief Move the clock by the time a transfer takes on the wire: START, nine
+ * clocks per byte including the address, and STOP. A transfer the target
+ * does not answer stops after the address.
+ *
+ * @param wire The bus
+ * @param len The number of bytes after the address
+ * @param addressed Whether a target answered the address
+ */
+static void clock_out(TwoWire *wire, size_t len, bool addressed) {
+  uint64_t bits = 2 + 9 * (addressed ? len + 1 : 1);
+  uint64_t us = (bits * 1000000 + wire->clock - 1) / wire->clock;
+
+  sim_bus_stats.busy_us += us;
+  host_advance_us(us);
+}
+
+/**
+ * @brief Count a transfer
+ *
+ * @param len The number of bytes after the address
+ * @param acked Whether the target acknowledged
+ */
+static void count(size_t len, bool acked) {
+  sim_bus_stats.transactions++;
+  if (acked) {
+    sim_bus_stats.bytes += len;
+  } else {
+    sim_bus_stats.nacks++;
+  }
+}
+
+/**
+ * @brief Create a device on a simulated bus
+ *
+ * @param addr The 7 bit address
+ * @param theWire The bus
+ */
+Adafruit_I2CDevice::Adafruit_I2CDevice(uint8_t addr, TwoWire *theWire) {
+  _addr = addr;
+  _wire = theWire;
+  _begun = false;
+}
+
+/**
+ * @brief Set up the device, checking something answers
+ *
+ * @param addr_detect Whether to check
+ * @return true: found, or not checked false: nothing answered
+ */
+bool Adafruit_I2CDevice::begin(bool addr_detect) {
+  _begun = true;
+  return !addr_detect || detected();
+}
+
+/**
+ * @brief Check something answers at the device's address
+ *
+ * @return true: acknowledged false: not acknowledged
+ */
+bool Adafruit_I2CDevice::detected(void) {
+  bool acked = (find(_wire, _addr) != NULL);
+  clock_out(_wire, 0, acked);
+  count(0, acked);
+  return acked;
+}
+
+/**
+ * @brief Read from the device
+ *
+ * @param buffer Where to put the bytes
+ * @param len The number of bytes
+ * @param stop Unused, every transfer ends with a STOP
+ * @return true: acknowledged false: not acknowledged
+ */
+bool Adafruit_I2CDevice::read(uint8_t *buffer, size_t len, bool stop) {
+  (void)stop;
+  // the target sees the read at its START
+  SimI2CTarget *target = find(_wire, _addr);
+  bool acked = target && target->read(buffer, len);
+  clock_out(_wire, len, target != NULL);
+  count(len, acked);
+  return acked;
+}
+
+/**
+ * @brief Write to the device
+ *
+ * @param buffer The bytes to write
+ * @param len The number of bytes
+ * @param stop Unused, every transfer ends with a STOP
+ * @param prefix_buffer Bytes to write first, if any
+ * @param prefix_len The number of prefix bytes
+ * @return true: acknowledged false: not acknowledged
+ */
+bool Adafruit_I2CDevice::write(const uint8_t *buffer, size_t len, bool stop,
+                               const uint8_t *prefix_buffer,
+                               size_t prefix_len) {
+  (void)stop;
+  uint8_t frame[64];
+  if (prefix_len + len > sizeof(frame)) {
+    return false;
+  }
+  if (prefix_len) {
+    memcpy(frame, prefix_buffer, prefix_len);
+  }
+  memcpy(frame + prefix_len, buffer, len);
+
+  // the target sees the write at its STOP
+  SimI2CTarget *target = find(_wire, _addr);
+  clock_out(_wire, prefix_len + len, target != NULL);
+  bool acked = target && target->write(frame, prefix_len + len);
+  count(prefix_len + len, acked);
+  return acked;
+}
+
+/**
+ * @brief Write to the device, then read from it
+ *
+ * @param write_buffer The bytes to write
+ * @param write_len The number of bytes to write
+ * @param read_buffer Where to put the bytes read
+ * @param read_len The number of bytes to read
+ * @param stop Unused, every transfer ends with a STOP
+ * @return true: both acknowledged false: not acknowledged
+ */
+bool Adafruit_I2CDevice::write_then_read(const uint8_t *write_buffer,
+                                         size_t write_len, uint8_t *read_buffer,
+                                         size_t read_len, bool stop) {
+  return write(write_buffer, write_len, stop) &&
+         read(read_buffer, read_len, stop);
+}
@@ -0,0 +1,64 @@
+/*!
+ *  @file sim_bus.h
+ *
+ * 	Simulated I2C bus for host tests of the Adafruit SCD30 library. Targets
+ * 	attached to a `TwoWire`, directly or behind a simulated TCA9548A, answer
+ * 	the transfers made through `Adafruit_I2CDevice`, and every transfer moves
+ * 	the virtual clock by the time it would take on the wire.
+ *
+ *
+ *	 license (see license.txt)
+ */
+
+#ifndef _SCD30_SIM_BUS_H
+#define _SCD30_SIM_BUS_H
+
+#include <Wire.h>
+
+/*!
+ *    @brief  Something that answers on the simulated bus
+ */
+class SimI2CTarget {
+public:
+  virtual ~SimI2CTarget() {}
+
+  /** @brief Take a write addressed to the target
+      @param buffer The bytes written
+      @param len The number of bytes
+      @return true: acknowledged false: not acknowledged */
+  virtual bool write(const uint8_t *buffer, size_t len) = 0;
+
+  /** @brief Answer a read addressed to the target
+      @param buffer Where to put the bytes read
+      @param len The number of bytes to read
+      @return true: acknowledged false: not acknowledged */
+  virtual bool read(uint8_t *buffer, size_t len) = 0;
+};
+
+/*!
+ *    @brief  TCA9548A style multiplexer: one byte selects the open channels
+ */
+class SimMux : public SimI2CTarget {
+public:
+  bool write(const uint8_t *buffer, size_t len);
+  bool read(uint8_t *buffer, size_t len);
+
+  uint8_t channels = 0; ///< Bit mask of the open channels
+  uint32_t selects = 0; ///< Number of channel changes written
+};
+
+/** Totals for every transfer made on the simulated buses */
+typedef struct {
+  uint32_t transactions; ///< Reads and writes, each one START to STOP
+  uint32_t bytes;        ///< Bytes moved, not counting addresses
+  uint32_t nacks;        ///< Transfers not acknowledged
+  uint64_t busy_us;      ///< Time the transfers took on the wire
+} sim_bus_stats_t;
+
+extern sim_bus_stats_t sim_bus_stats; ///< Totals since the last `sim_reset`
+
+bool sim_attach(SimI2CTarget *target, uint8_t address, TwoWire *wire = &Wire,
+                SimMux *mux = NULL, uint8_t channel = 0);
+void sim_reset(void);
+
+#endif
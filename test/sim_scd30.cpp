@@ -0,0 +1,387 @@
+/*!
+ *  @file sim_scd30.cpp
+ *
+ * 	Simulated SCD30 for host tests of the Adafruit SCD30 library
+ *
+ *
+ *	 BSD (see license.txt)
+ */
+
+#include "sim_scd30.h"
+
+/** The commands the sensor accepts, in the order of `_counts` */
+static const uint16_t commands[SIM_SCD30_COMMANDS] = {
+    0x0010, 0x0104, 0x4600, 0x0202, 0x0300, 0x5306,
+    0x5204, 0x5403, 0x5102, 0xD304, 0xD100,
+};
+
+/**
+ * @brief Find a command in `commands`
+ *
+ * @param command The command
+ * @return int The index of the command, -1 if the sensor does not know it
+ */
+static int command_index(uint16_t command) {
+  for (int i = 0; i < SIM_SCD30_COMMANDS; i++) {
+    if (commands[i] == command) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+/**
+ * @brief Check whether a command can be read back
+ *
+ * @param command The command
+ * @return true: it is followed by a read false: it only takes a write
+ */
+static bool readable(uint16_t command) {
+  return (command != 0x0104) && (command != 0xD304);
+}
+
+/**
+ * @brief CRC-8 as the datasheet gives it, bit by bit so it does not share
+ * any code with the library's table driven version
+ *
+ * @param data The bytes to check
+ * @param len The number of bytes
+ * @return uint8_t The CRC
+ */
+static uint8_t crc8(const uint8_t *data, size_t len) {
+  uint8_t crc = 0xFF;
+  while (len--) {
+    crc ^= *data++;
+    for (uint8_t bit = 0; bit < 8; bit++) {
+      crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x31) : (uint8_t)(crc << 1);
+    }
+  }
+  return crc;
+}
+
+/**
+ * @brief Split a float into the two words the sensor sends it as
+ *
+ * @param value The float
+ * @param words Where to put the words, most significant first
+ */
+static void pack_float(float value, uint16_t *words) {
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  words[0] = bits >> 16;
+  words[1] = bits & 0xFFFF;
+}
+
+/**
+ * @brief Create a sensor with its factory settings, not measuring
+ */
+SimSCD30::SimSCD30() { memset(_counts, 0, sizeof(_counts)); }
+
+/**
+ * @brief Get the number of measurements made so far
+ *
+ * @return uint32_t The number of the newest measurement, 0 for none
+ */
+uint32_t SimSCD30::frame(void) {
+  uint64_t now = host_time_us();
+  if (!running || (now < _anchor_us)) {
+    return _anchor_frame;
+  }
+  uint64_t period =
+      (uint64_t)interval * 1000000 * (1000000 + drift_ppm) / 1000000;
+  return _anchor_frame + (uint32_t)((now - _anchor_us) / period);
+}
+
+/**
+ * @brief Check whether a measurement is waiting to be read
+ *
+ * @return true: data ready false: no new measurement
+ */
+bool SimSCD30::ready(void) { return frame() > _read_frame; }
+
+/**
+ * @brief Check whether a reset is still in progress, during which the sensor
+ * does not answer
+ *
+ * @return true: resetting false: answering
+ */
+bool SimSCD30::booting(void) { return host_time_us() < _busy_until; }
+
+/**
+ * @brief Get the number of times a command was carried out or answered
+ *
+ * @param command The command
+ * @return uint32_t The count
+ */
+uint32_t SimSCD30::count(uint16_t command) const {
+  int index = command_index(command);
+  return (index < 0) ? 0 : _counts[index];
+}
+
+/**
+ * @brief Drive the RDY pin, if there is one, from the data ready state. Call
+ * as time passes to see it rise.
+ */
+void SimSCD30::updatePin(void) {
+  if (ready_pin >= 0) {
+    host_set_pin(ready_pin, ready() ? HIGH : LOW);
+  }
+}
+
+/**
+ * @brief Restart the measurement cadence, keeping the measurements made
+ *
+ * @param now_us The time of the restart
+ */
+void SimSCD30::rebase(uint64_t now_us) {
+  _anchor_frame = frame();
+  _anchor_us = now_us;
+}
+
+/**
+ * @brief Run a command that does not read anything back
+ *
+ * @param command The command
+ * @param has_argument Whether an argument came with it
+ * @param argument The argument
+ * @return true: accepted false: unknown command or bad argument
+ */
+bool SimSCD30::execute(uint16_t command, bool has_argument,
+                       uint16_t argument) {
+  if (!apply(command, has_argument, argument)) {
+    return false;
+  }
+  _counts[command_index(command)]++;
+  return true;
+}
+
+/**
+ * @brief Carry out a command for `execute`
+ *
+ * @param command The command
+ * @param has_argument Whether an argument came with it
+ * @param argument The argument
+ * @return true: accepted false: unknown command or bad argument
+ */
+bool SimSCD30::apply(uint16_t command, bool has_argument, uint16_t argument) {
+  uint64_t now = host_time_us();
+
+  if (!has_argument) {
+    switch (command) {
+    case 0x0104:
+      rebase(now);
+      running = false;
+      return true;
+    case 0xD304:
+      // settings and the measuring state live in non-volatile memory
+      rebase(now);
+      _anchor_us = now + boot_us;
+      _busy_until = now + boot_us;
+      _drop_next = nack_after_reset;
+      _has_pending = false;
+      return true;
+    default:
+      return false;
+    }
+  }
+
+  switch (command) {
+  case 0x0010:
+    if (argument && ((argument < 700) || (argument > 1400))) {
+      return false;
+    }
+    rebase(now);
+    running = true;
+    pressure = argument;
+    return true;
+  case 0x4600:
+    if ((argument < 2) || (argument > 1800)) {
+      return false;
+    }
+    rebase(now);
+    interval = argument;
+    return true;
+  case 0x5306:
+    if (argument > 1) {
+      return false;
+    }
+    self_calibration = argument;
+    return true;
+  case 0x5204:
+    if ((argument < 400) || (argument > 2000)) {
+      return false;
+    }
+    forced_reference = argument;
+    return true;
+  case 0x5403:
+    temperature_offset = argument;
+    return true;
+  case 0x5102:
+    altitude = argument;
+    return true;
+  default:
+    return false;
+  }
+}
+
+/**
+ * @brief Get the response to a read command
+ *
+ * @param command The command
+ * @param words Where to put the response, room for 6 words
+ * @return uint8_t The number of words in the response, 0 if the command does
+ * not read anything back
+ */
+uint8_t SimSCD30::respond(uint16_t command, uint16_t *words) {
+  int index = command_index(command);
+  if ((index >= 0) && readable(command)) {
+    _counts[index]++;
+  }
+
+  switch (command) {
+  case 0x0300: {
+    uint32_t newest = frame();
+    measure(newest);
+    _read_frame = newest;
+    frames_read++;
+    pack_float(co2, words);
+    pack_float(temperature, words + 2);
+    pack_float(humidity, words + 4);
+    return 6;
+  }
+  case 0x0202:
+    words[0] = ready() ? 1 : 0;
+    return 1;
+  case 0x0010:
+    words[0] = pressure;
+    return 1;
+  case 0x4600:
+    words[0] = interval;
+    return 1;
+  case 0x5306:
+    words[0] = self_calibration;
+    return 1;
+  case 0x5204:
+    words[0] = forced_reference;
+    return 1;
+  case 0x5403:
+    words[0] = temperature_offset;
+    return 1;
+  case 0x5102:
+    words[0] = altitude;
+    return 1;
+  case 0xD100:
+    words[0] = revision;
+    return 1;
+  default:
+    return 0;
+  }
+}
+
+/**
+ * @brief Take a command written over I2C: the command, then for commands
+ * with an argument the argument and its CRC
+ *
+ * @param buffer The bytes written
+ * @param len The number of bytes
+ * @return true: acknowledged false: not acknowledged
+ */
+bool SimSCD30::write(const uint8_t *buffer, size_t len) {
+  uint64_t now = host_time_us();
+  if (booting()) {
+    return false;
+  }
+  if (_drop_next) {
+    _drop_next = false;
+    return false;
+  }
+  if (nack_writes) {
+    nack_writes--;
+    return false;
+  }
+  if (len < 2) {
+    // address probe
+    return len == 0;
+  }
+
+  uint16_t command = (uint16_t)buffer[0] << 8 | buffer[1];
+  int index = command_index(command);
+  if (index < 0) {
+    return false;
+  }
+
+  _has_pending = false;
+  if (len == 2) {
+    if (readable(command)) {
+      _pending = command;
+      _has_pending = true;
+      _pending_us = now;
+    } else if (!execute(command, false, 0)) {
+      return false;
+    }
+  } else if (len == 5) {
+    if (crc8(buffer + 2, 2) != buffer[4]) {
+      crc_rejects++;
+      return false;
+    }
+    if (!execute(command, true, (uint16_t)buffer[2] << 8 | buffer[3])) {
+      return false;
+    }
+  } else {
+    return false;
+  }
+
+  writes++;
+  updatePin();
+  return true;
+}
+
+/**
+ * @brief Answer a read over I2C with the response to the last command, each
+ * word followed by its CRC. Reads past the response get 0xFF.
+ *
+ * @param buffer Where to put the bytes read
+ * @param len The number of bytes to read
+ * @return true: acknowledged false: not acknowledged
+ */
+bool SimSCD30::read(uint8_t *buffer, size_t len) {
+  uint64_t now = host_time_us();
+  if (booting()) {
+    return false;
+  }
+  if (nack_reads) {
+    nack_reads--;
+    return false;
+  }
+  if (!_has_pending) {
+    return false;
+  }
+  _has_pending = false;
+  if (now - _pending_us < read_gap_us) {
+    gap_violations++;
+    return false;
+  }
+
+  uint16_t words[6];
+  uint8_t count = respond(_pending, words);
+  for (size_t i = 0; i < len; i++) {
+    size_t word = i / 3;
+    if (word >= count) {
+      buffer[i] = 0xFF;
+    } else if (i % 3 == 0) {
+      buffer[i] = words[word] >> 8;
+    } else if (i % 3 == 1) {
+      buffer[i] = words[word] & 0xFF;
+    } else {
+      buffer[i] = crc8(buffer + i - 2, 2);
+    }
+  }
+  if (corrupt_reads && (corrupt_word * 3 < len)) {
+    corrupt_reads--;
+    buffer[corrupt_word * 3] ^= 0x01;
+  }
+
+  reads++;
+  updatePin();
+  return true;
+}
@@ -0,0 +1,93 @@
+/*!
+ *  @file sim_scd30.h
+ *
+ * 	Simulated SCD30 for host tests of the Adafruit SCD30 library. Implements
+ * 	the I2C command set with CRC framing, the write/read gap, measurements
+ * 	on the configured cadence from the virtual clock, and fault injection.
+ *
+ *
+ *	 license (see license.txt)
+ */
+
+#ifndef _SCD30_SIM_SCD30_H
+#define _SCD30_SIM_SCD30_H
+
+#include "sim_bus.h"
+
+#define SIM_SCD30_COMMANDS 11 ///< Number of commands the sensor knows
+
+/*!
+ *    @brief  A simulated SCD30. The command level (`execute`, `respond`) is
+ *            shared by the I2C framing here and the Modbus framing of the
+ *            Modbus tests.
+ */
+class SimSCD30 : public SimI2CTarget {
+public:
+  SimSCD30();
+  virtual ~SimSCD30() {}
+
+  bool write(const uint8_t *buffer, size_t len);
+  bool read(uint8_t *buffer, size_t len);
+
+  bool execute(uint16_t command, bool has_argument, uint16_t argument);
+  uint8_t respond(uint16_t command, uint16_t *words);
+
+  uint32_t frame(void);
+  bool ready(void);
+  bool booting(void);
+  uint32_t count(uint16_t command) const;
+  void updatePin(void);
+
+  /** @brief Set the readings for a measurement, called as each one is read.
+      The default keeps `co2`, `temperature` and `humidity` as they are.
+      @param frame The number of the measurement, 1 for the first */
+  virtual void measure(uint32_t frame) { (void)frame; }
+
+  // settings, kept over resets like the sensor's non-volatile memory
+  uint16_t interval = 2;           ///< Seconds between measurements
+  uint16_t pressure = 0;           ///< Pressure compensation in mBar
+  uint16_t altitude = 0;           ///< Altitude offset in meters
+  uint16_t temperature_offset = 0; ///< Temp offset in 0.01 degrees C
+  uint16_t forced_reference = 400; ///< Forced recalibration ref in ppm
+  uint16_t self_calibration = 0;   ///< 1: self calibration enabled
+  uint16_t revision = 0x0342;      ///< Firmware revision
+  bool running = false;            ///< Measuring continuously
+  int32_t drift_ppm = 0;           ///< How slow the sensor's clock runs
+  uint32_t read_gap_us = 4000;     ///< Write/read gap the sensor needs
+  uint32_t boot_us = 20000;        ///< Time a reset takes
+  int8_t ready_pin = -1;           ///< Host pin driven as RDY, -1: none
+
+  float co2 = 600;        ///< CO2 reading in ppm
+  float temperature = 22; ///< Temperature reading in degrees C
+  float humidity = 45;    ///< Relative humidity reading in percent
+
+  // faults, each counting down as it is injected
+  uint16_t nack_writes = 0;      ///< Writes to not acknowledge
+  uint16_t nack_reads = 0;       ///< Reads to not acknowledge
+  uint16_t corrupt_reads = 0;    ///< Reads to send with a bad CRC
+  uint8_t corrupt_word = 0;      ///< Word of the response to corrupt
+  bool nack_after_reset = false; ///< Drop the first write after each reset
+
+  // what the sensor has seen
+  uint32_t writes = 0;         ///< Writes acknowledged
+  uint32_t reads = 0;          ///< Reads acknowledged
+  uint32_t gap_violations = 0; ///< Reads sent too soon after their command
+  uint32_t crc_rejects = 0;    ///< Writes refused for a bad argument CRC
+  uint32_t frames_read = 0;    ///< Measurements read out
+
+private:
+  bool apply(uint16_t command, bool has_argument, uint16_t argument);
+  void rebase(uint64_t now_us);
+
+  uint64_t _anchor_us = 0;              ///< Time the current cadence started
+  uint32_t _anchor_frame = 0;           ///< Measurements before `_anchor_us`
+  uint32_t _read_frame = 0;             ///< Last measurement read out
+  uint64_t _busy_until = 0;             ///< End of the reset in progress
+  bool _drop_next = false;              ///< Drop the next write, after a reset
+  uint16_t _pending = 0;                ///< Command waiting to be read
+  bool _has_pending = false;            ///< True while a read is expected
+  uint64_t _pending_us = 0;             ///< Time the read command was written
+  uint32_t _counts[SIM_SCD30_COMMANDS]; ///< Times each command was run
+};
+
+#endif
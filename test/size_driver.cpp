@@ -0,0 +1,37 @@
+/*!
+ *  @file size_driver.cpp
+ *
+ * 	Smallest program that starts an SCD30 on I2C and reads it, built with
+ * 	Adafruit_SCD30 and, with SCD30_SIZE_TEMPLATE defined, with
+ * 	Adafruit_SCD30_I2CDriver. Only built to compare their sizes.
+ *
+ *
+ *	 BSD (see license.txt)
+ */
+
+#include <Adafruit_SCD30.h>
+#include <stdio.h>
+
+#ifdef SCD30_SIZE_TEMPLATE
+static Adafruit_SCD30_I2CDriver scd30;
+static Adafruit_I2CDevice device(SCD30_I2CADDR_DEFAULT);
+#else
+static Adafruit_SCD30 scd30;
+#endif
+
+int main(void) {
+#ifdef SCD30_SIZE_TEMPLATE
+  scd30.transport().setDevice(&device);
+#endif
+  if (!scd30.begin()) {
+    return 1;
+  }
+  while (!scd30.dataReady()) {
+    delay(100);
+  }
+  if (!scd30.read()) {
+    return 1;
+  }
+  printf("%f\n", scd30.CO2);
+  return 0;
+}
@@ -0,0 +1,83 @@
+/*!
+ *  @file test.h
+ *
+ * 	Minimal assertions for the host tests of the Adafruit SCD30 library.
+ * 	Each test is a `void (void)` function run with `RUN_TEST`; `main`
+ * 	returns `test_report()`.
+ *
+ *
+ *	 license (see license.txt)
+ */
+
+#ifndef _SCD30_TEST_H
+#define _SCD30_TEST_H
+
+#include <math.h>
+#include <stdio.h>
+
+static int test_failures = 0; ///< Tests failed so far
+static bool test_failed;      ///< True once the running test has failed
+
+/** Fail the running test unless `cond` holds */
+#define TEST_ASSERT(cond)                                                      \
+  do {                                                                         \
+    if (!(cond)) {                                                             \
+      printf("%s:%d: %s\n", __FILE__, __LINE__, #cond);                        \
+      test_failed = true;                                                      \
+      return;                                                                  \
+    }                                                                          \
+  } while (0)
+
+/** Fail the running test unless two integers are equal */
+#define TEST_EQUAL(expected, actual)                                           \
+  do {                                                                         \
+    long long e = (long long)(expected), a = (long long)(actual);              \
+    if (e != a) {                                                              \
+      printf("%s:%d: %s is %lld, expected %lld\n", __FILE__, __LINE__,         \
+             #actual, a, e);                                                   \
+      test_failed = true;                                                      \
+      return;                                                                  \
+    }                                                                          \
+  } while (0)
+
+/** Fail the running test unless two floats are within `tolerance` */
+#define TEST_CLOSE(expected, actual, tolerance)                                \
+  do {                                                                         \
+    double e = (expected), a = (actual);                                       \
+    if (!(fabs(e - a) <= (tolerance))) {                                       \
+      printf("%s:%d: %s is %g, expected %g\n", __FILE__, __LINE__, #actual,    \
+             a, e);                                                            \
+      test_failed = true;                                                      \
+      return;                                                                  \
+    }                                                                          \
+  } while (0)
+
+/** Run a test function and report it */
+#define RUN_TEST(test) test_run(#test, test)
+
+/**
+ * @brief Run a test and print whether it passed
+ *
+ * @param name The name of the test
+ * @param test The test
+ */
+static inline void test_run(const char *name, void (*test)(void)) {
+  test_failed = false;
+  test();
+  printf("%s %s\n", test_failed ? "FAIL" : "ok  ", name);
+  if (test_failed) {
+    test_failures++;
+  }
+}
+
+/**
+ * @brief Print the totals
+ *
+ * @return int The exit code for `main`, 0 if every test passed
+ */
+static inline int test_report(void) {
+  printf("%d failed\n", test_failures);
+  return test_failures ? 1 : 0;
+}
+
+#endif
@@ -0,0 +1,111 @@
+/*!
+ *  @file test_adaptive.cpp
+ *
+ * 	Host tests of the adaptive measurement interval and its write budget,
+ * 	against the simulated sensor
+ *
+ *
+ *	 BSD (see license.txt)
+ */
+
+#include "sim_scd30.h"
+#include "test.h"
+#include <Adafruit_SCD30_Adaptive.h>
+
+#define HOUR_MS 3600000UL ///< An hour in ms
+
+static SimSCD30 sensor;
+static Adafruit_SCD30 scd30;
+
+/**
+ * @brief Start a sensor and the adaptive interval with a budget of 4 writes
+ *
+ * @param adaptive The adaptive interval
+ * @param max_interval The longest interval
+ * @return true: success false: the driver could not start the sensor
+ */
+static bool setup_adaptive(Adafruit_SCD30_AdaptiveInterval *adaptive,
+                           uint16_t max_interval) {
+  sim_reset();
+  sensor = SimSCD30();
+  sim_attach(&sensor, SCD30_I2CADDR_DEFAULT);
+  if (!scd30.begin()) {
+    return false;
+  }
+  scd30_adaptive_policy_t policy = {2, max_interval, 15, 5, 1, 0, 4};
+  adaptive->setPolicy(&policy);
+  return adaptive->begin(2, max_interval);
+}
+
+/**
+ * @brief Read every sample for a while, with CO2 changing at a steady rate
+ *
+ * @param adaptive The adaptive interval
+ * @param duration_ms How long to run
+ * @param slope The rate of change of CO2 in ppm/minute
+ */
+static void run(Adafruit_SCD30_AdaptiveInterval *adaptive,
+                uint32_t duration_ms, float slope) {
+  uint32_t start = millis();
+  float co2 = sensor.co2;
+  while ((uint32_t)(millis() - start) < duration_ms) {
+    sensor.co2 = co2 + slope * (millis() - start) / 60000.0f;
+    if (scd30.dataReady() && scd30.read()) {
+      adaptive->update();
+    }
+    delay(500);
+  }
+}
+
+static void test_steady_lengthens_interval(void) {
+  Adafruit_SCD30_AdaptiveInterval adaptive(&scd30);
+  TEST_ASSERT(setup_adaptive(&adaptive, 16));
+  run(&adaptive, 600000, 0);
+  TEST_EQUAL(16, sensor.interval);
+  TEST_EQUAL(3, adaptive.getWrites());
+
+  // a fast rise goes straight back to the shortest interval
+  run(&adaptive, 300000, 60);
+  TEST_EQUAL(2, sensor.interval);
+  TEST_EQUAL(4, adaptive.getWrites());
+}
+
+static void test_budget_earned_back(void) {
+  Adafruit_SCD30_AdaptiveInterval adaptive(&scd30);
+  TEST_ASSERT(setup_adaptive(&adaptive, 1800));
+
+  // 2 -> 4 -> 8 -> 16 -> 32 spends the budget of 4
+  run(&adaptive, HOUR_MS, 0);
+  TEST_EQUAL(4, adaptive.getWrites());
+  TEST_EQUAL(32, sensor.interval);
+
+  // one write is earned back every 6 hours, not all four after a day
+  run(&adaptive, 4 * HOUR_MS, 0);
+  TEST_EQUAL(4, adaptive.getWrites());
+  run(&adaptive, 2 * HOUR_MS, 0);
+  TEST_EQUAL(5, adaptive.getWrites());
+  TEST_EQUAL(64, sensor.interval);
+}
+
+static void test_budget_capped(void) {
+  Adafruit_SCD30_AdaptiveInterval adaptive(&scd30);
+  TEST_ASSERT(setup_adaptive(&adaptive, 4));
+  run(&adaptive, 600000, 0);
+  TEST_EQUAL(1, adaptive.getWrites());
+
+  // three idle days don't earn more than a full budget
+  delay(72 * HOUR_MS);
+  for (int i = 0; i < 6; i++) {
+    run(&adaptive, 300000, 60);
+    run(&adaptive, 300000, 0);
+  }
+  TEST_EQUAL(5, adaptive.getWrites());
+  TEST_EQUAL(0, sensor.gap_violations);
+}
+
+int main(void) {
+  RUN_TEST(test_steady_lengthens_interval);
+  RUN_TEST(test_budget_earned_back);
+  RUN_TEST(test_budget_capped);
+  return test_report();
+}
@@ -0,0 +1,173 @@
+/*!
+ *  @file test_alloc.cpp
+ *
+ * 	Checks that Adafruit_SCD30 never touches the heap, however often it is
+ * 	started and reset. `new` is replaced here; where the linker supports it
+ * 	(`SCD30_WRAP_MALLOC`) `malloc` and friends are wrapped too.
+ *
+ *
+ *	 BSD (see license.txt)
+ */
+
+#include "sim_scd30.h"
+#include "test.h"
+#include <Adafruit_SCD30.h>
+#include <Adafruit_SCD30_Manager.h>
+#include <new>
+
+static bool counting = false; ///< Count allocations while true
+static uint32_t allocations;  ///< Allocations counted
+
+#ifdef SCD30_WRAP_MALLOC
+extern "C" {
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *pointer, size_t size);
+
+/** @brief Count `malloc`
+    @param size The size to allocate
+    @return The allocation */
+void *__wrap_malloc(size_t size) {
+  allocations += counting;
+  return __real_malloc(size);
+}
+/** @brief Count `calloc`
+    @param count The number of elements
+    @param size The size of an element
+    @return The allocation */
+void *__wrap_calloc(size_t count, size_t size) {
+  allocations += counting;
+  return __real_calloc(count, size);
+}
+/** @brief Count `realloc`
+    @param pointer The allocation to resize
+    @param size The new size
+    @return The allocation */
+void *__wrap_realloc(void *pointer, size_t size) {
+  allocations += counting;
+  return __real_realloc(pointer, size);
+}
+}
+#define RAW_MALLOC __real_malloc ///< `malloc` without counting
+#else
+#define RAW_MALLOC malloc ///< `malloc`, not counted
+#endif
+
+/** @brief Count `new`
+    @param size The size to allocate
+    @return The allocation */
+void *operator new(size_t size) {
+  allocations += counting;
+  void *pointer = RAW_MALLOC(size ? size : 1);
+  if (!pointer) {
+    throw std::bad_alloc();
+  }
+  return pointer;
+}
+/** @brief Count `new[]`
+    @param size The size to allocate
+    @return The allocation */
+void *operator new[](size_t size) { return operator new(size); }
+/** @brief Release an allocation from `new`
+    @param pointer The allocation */
+void operator delete(void *pointer) noexcept { free(pointer); }
+/** @brief Release an allocation from `new[]`
+    @param pointer The allocation */
+void operator delete[](void *pointer) noexcept { free(pointer); }
+
+static SimSCD30 sensor;
+
+/**
+ * @brief Put a freshly powered sensor on the bus
+ */
+static void setup_sim(void) {
+  sim_reset();
+  sensor = SimSCD30();
+  sim_attach(&sensor, SCD30_I2CADDR_DEFAULT);
+}
+
+static void test_counter_works(void) {
+  allocations = 0;
+  counting = true;
+  int *on_heap = new int(1);
+  // volatile so the compiler cannot drop the malloc/free pair
+  void *volatile block = malloc(16);
+  counting = false;
+  delete on_heap;
+  free(block);
+
+#ifdef SCD30_WRAP_MALLOC
+  TEST_EQUAL(2, allocations);
+#else
+  TEST_EQUAL(1, allocations);
+#endif
+}
+
+static void test_begin_and_reset(void) {
+  setup_sim();
+  allocations = 0;
+  counting = true;
+  {
+    Adafruit_SCD30 scd30;
+    for (int i = 0; i < 100; i++) {
+      if (!scd30.begin() || !scd30.begin(SCD30_I2CADDR_DEFAULT, &Wire, i)) {
+        counting = false;
+        TEST_ASSERT(false);
+      }
+      scd30.reset();
+    }
+  }
+  counting = false;
+  TEST_EQUAL(0, allocations);
+}
+
+static void test_read_path(void) {
+  setup_sim();
+  Adafruit_SCD30 scd30;
+  TEST_ASSERT(scd30.begin());
+
+  scd30_config_t config;
+  scd30_snapshot_t snapshot;
+  sensors_event_t temp, humidity;
+  allocations = 0;
+  counting = true;
+  for (int i = 0; i < 20; i++) {
+    delay(2000);
+    scd30.dataReady();
+    scd30.read();
+    scd30.getEvent(&humidity, &temp);
+    scd30.getSnapshot(&snapshot);
+    scd30.refreshConfig();
+    scd30.getConfig(&config);
+  }
+  counting = false;
+  TEST_EQUAL(0, allocations);
+}
+
+static void test_manager(void) {
+  setup_sim();
+  allocations = 0;
+  counting = true;
+  {
+    Adafruit_SCD30 scd30;
+    Adafruit_SCD30_Manager manager;
+    bool ok = scd30.begin() && (manager.addSensor(&scd30) == 0);
+    for (int i = 0; ok && (i < 100); i++) {
+      manager.poll();
+      delay(100);
+    }
+    counting = false;
+    TEST_ASSERT(ok);
+    TEST_ASSERT(manager.getSampleCount() > 0);
+  }
+  counting = false;
+  TEST_EQUAL(0, allocations);
+}
+
+int main(void) {
+  RUN_TEST(test_counter_works);
+  RUN_TEST(test_begin_and_reset);
+  RUN_TEST(test_read_path);
+  RUN_TEST(test_manager);
+  return test_report();
+}
@@ -0,0 +1,209 @@
+/*!
+ *  @file test_compact.cpp
+ *
+ * 	Host tests of the compact fixed point sample format: rounding of the
+ * 	integer-only payload conversion against a double precision reference,
+ * 	negative temperatures, clamping at the limits, and packing
+ *
+ *
+ *	 BSD (see license.txt)
+ */
+
+#include "test.h"
+#include <Adafruit_SCD30_Compact.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Build a measurement payload as the sensor sends it
+ *
+ * @param co2 CO2 concentration in ppm
+ * @param temperature Temperature in degrees C
+ * @param humidity Relative humidity in %
+ * @param payload Where to write the `SCD30_RAW_PAYLOAD_SIZE` bytes
+ */
+static void make_payload(float co2, float temperature, float humidity,
+                         uint8_t *payload) {
+  float values[3] = {co2, temperature, humidity};
+  for (uint8_t i = 0; i < 3; i++) {
+    uint32_t bits;
+    memcpy(&bits, &values[i], sizeof(bits));
+    payload[4 * i] = bits >> 24;
+    payload[4 * i + 1] = bits >> 16;
+    payload[4 * i + 2] = bits >> 8;
+    payload[4 * i + 3] = bits;
+  }
+}
+
+/**
+ * @brief The fixed point value a reading should become, worked out in double
+ * precision, where a float times 100 is exact
+ *
+ * @param value The reading
+ * @param scale Fixed point units per unit
+ * @param min The smallest allowed result
+ * @param max The largest allowed result
+ * @return int32_t The value times `scale`, rounded half away from zero and
+ * clamped
+ */
+static int32_t reference(float value, int scale, int32_t min, int32_t max) {
+  double scaled = round((double)value * scale);
+  if (scaled < min) {
+    return min;
+  }
+  if (scaled > max) {
+    return max;
+  }
+  return (int32_t)scaled;
+}
+
+/**
+ * @brief Convert readings through a payload and check each against the
+ * reference
+ *
+ * @param co2 CO2 concentration in ppm
+ * @param temperature Temperature in degrees C
+ * @param humidity Relative humidity in %
+ * @return true: all three match
+ */
+static bool matches_reference(float co2, float temperature, float humidity) {
+  uint8_t payload[SCD30_RAW_PAYLOAD_SIZE];
+  scd30_compact_sample_t sample;
+  make_payload(co2, temperature, humidity, payload);
+  scd30_compact_from_payload(payload, &sample);
+  return (sample.co2 == (uint32_t)reference(co2, 10, 0,
+                                            SCD30_COMPACT_CO2_MAX)) &&
+         (sample.temperature ==
+          reference(temperature, 100, INT16_MIN, INT16_MAX)) &&
+         (sample.humidity ==
+          reference(humidity, 100, 0, SCD30_COMPACT_HUMIDITY_MAX));
+}
+
+static void test_rounding(void) {
+  // exact halves round away from zero, either side of it
+  TEST_ASSERT(matches_reference(0.05f, 0.125f, 0.375f));
+  TEST_ASSERT(matches_reference(400.25f, -0.125f, 99.995f));
+  scd30_compact_sample_t sample;
+  uint8_t payload[SCD30_RAW_PAYLOAD_SIZE];
+  make_payload(400.25f, -0.125f, 0.375f, payload);
+  TEST_ASSERT(scd30_compact_from_payload(payload, &sample));
+  TEST_EQUAL(4003, sample.co2);
+  TEST_EQUAL(-13, sample.temperature);
+  TEST_EQUAL(38, sample.humidity);
+
+  // and everything else to the nearest, over the sensor's whole range
+  srand(14);
+  for (int i = 0; i < 100000; i++) {
+    float co2 = rand() / (float)RAND_MAX * 40000;
+    float temperature = rand() / (float)RAND_MAX * 135 - 30;
+    float humidity = rand() / (float)RAND_MAX * 100;
+    TEST_ASSERT(matches_reference(co2, temperature, humidity));
+  }
+
+  // the float conversion, with float math, is never more than one unit off
+  for (int i = 0; i < 10000; i++) {
+    float co2 = rand() / (float)RAND_MAX * 40000;
+    float temperature = rand() / (float)RAND_MAX * 135 - 30;
+    float humidity = rand() / (float)RAND_MAX * 100;
+    scd30_compact_sample_t fixed;
+    make_payload(co2, temperature, humidity, payload);
+    scd30_compact_from_payload(payload, &fixed);
+    TEST_ASSERT(scd30_compact_from_floats(co2, temperature, humidity,
+                                          &sample));
+    TEST_ASSERT(labs((long)sample.co2 - (long)fixed.co2) <= 1);
+    TEST_ASSERT(abs(sample.temperature - fixed.temperature) <= 1);
+    TEST_ASSERT(abs(sample.humidity - fixed.humidity) <= 1);
+  }
+}
+
+static void test_negative_temperature(void) {
+  static const struct {
+    float temperature;
+    int16_t expected;
+  } cases[] = {
+      {-0.0f, 0},     {-0.004f, 0},     {-0.006f, -1},      {-5.5f, -550},
+      {-40.0f, -4000}, {-40.004f, -4000}, {-273.15f, -27315},
+      {-327.68f, INT16_MIN},
+  };
+  for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+    uint8_t payload[SCD30_RAW_PAYLOAD_SIZE];
+    scd30_compact_sample_t sample;
+    make_payload(400, cases[i].temperature, 50, payload);
+    TEST_ASSERT(scd30_compact_from_payload(payload, &sample));
+    TEST_EQUAL(cases[i].expected, sample.temperature);
+    TEST_ASSERT(scd30_compact_from_floats(400, cases[i].temperature, 50,
+                                          &sample));
+    TEST_EQUAL(cases[i].expected, sample.temperature);
+  }
+}
+
+static void test_clamping(void) {
+  static const struct {
+    float co2, temperature, humidity;
+    bool in_range;
+    uint32_t co2_expected;
+    int16_t temperature_expected;
+    uint16_t humidity_expected;
+  } cases[] = {
+      // at the limits
+      {1677721.5f, 327.67f, 100.0f, true, SCD30_COMPACT_CO2_MAX, INT16_MAX,
+       SCD30_COMPACT_HUMIDITY_MAX},
+      {0.0f, -327.68f, 0.0f, true, 0, INT16_MIN, 0},
+      // just past them
+      {1677721.6f, 20, 50, false, SCD30_COMPACT_CO2_MAX, 2000, 5000},
+      {400, 327.68f, 50, false, 4000, INT16_MAX, 5000},
+      {400, -327.69f, 50, false, 4000, INT16_MIN, 5000},
+      {400, 20, 100.01f, false, 4000, 2000, SCD30_COMPACT_HUMIDITY_MAX},
+      {-0.1f, 20, -0.01f, false, 0, 2000, 0},
+      // far past them
+      {1e30f, -1e30f, 1e30f, false, SCD30_COMPACT_CO2_MAX, INT16_MIN,
+       SCD30_COMPACT_HUMIDITY_MAX},
+      {-1e30f, 1e30f, -1e30f, false, 0, INT16_MAX, 0},
+      // not numbers at all
+      {INFINITY, -INFINITY, NAN, false, 0, 0, 0},
+      // too small to matter
+      {1e-40f, -1e-40f, 1e-30f, true, 0, 0, 0},
+  };
+  for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+    uint8_t payload[SCD30_RAW_PAYLOAD_SIZE];
+    scd30_compact_sample_t sample;
+    make_payload(cases[i].co2, cases[i].temperature, cases[i].humidity,
+                 payload);
+    TEST_EQUAL(cases[i].in_range,
+               scd30_compact_from_payload(payload, &sample));
+    TEST_EQUAL(cases[i].co2_expected, sample.co2);
+    TEST_EQUAL(cases[i].temperature_expected, sample.temperature);
+    TEST_EQUAL(cases[i].humidity_expected, sample.humidity);
+  }
+}
+
+static void test_pack(void) {
+  scd30_compact_sample_t sample = {SCD30_COMPACT_CO2_MAX, -27315, 4150};
+  uint8_t buffer[SCD30_COMPACT_SIZE + 1];
+  memset(buffer, 0xAA, sizeof(buffer));
+  scd30_compact_pack(&sample, buffer);
+  static const uint8_t expected[] = {0xFF, 0xFF, 0xFF, 0x95, 0x4D, 0x10, 0x36};
+  TEST_ASSERT(!memcmp(expected, buffer, SCD30_COMPACT_SIZE));
+  TEST_EQUAL(0xAA, buffer[SCD30_COMPACT_SIZE]);
+
+  scd30_compact_sample_t unpacked;
+  scd30_compact_unpack(buffer, &unpacked);
+  TEST_EQUAL(sample.co2, unpacked.co2);
+  TEST_EQUAL(sample.temperature, unpacked.temperature);
+  TEST_EQUAL(sample.humidity, unpacked.humidity);
+
+  float co2, temperature, humidity;
+  scd30_compact_to_floats(&unpacked, &co2, &temperature, &humidity);
+  TEST_CLOSE(1677721.5, co2, 0.1);
+  TEST_CLOSE(-273.15, temperature, 0.001);
+  TEST_CLOSE(41.5, humidity, 0.001);
+}
+
+int main(void) {
+  RUN_TEST(test_rounding);
+  RUN_TEST(test_negative_temperature);
+  RUN_TEST(test_clamping);
+  RUN_TEST(test_pack);
+  return test_report();
+}
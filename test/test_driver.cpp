@@ -0,0 +1,464 @@
+/*!
+ *  @file test_driver.cpp
+ *
+ * 	Host tests of Adafruit_SCD30 and the template driver against the
+ * 	simulated sensor
+ *
+ *
+ *	 BSD (see license.txt)
+ */
+
+#include "sim_scd30.h"
+#include "test.h"
+#include <Adafruit_SCD30.h>
+
+static SimSCD30 sensor;
+
+/**
+ * @brief Put a freshly powered sensor on the bus and restart the clock
+ */
+static void setup_sim(void) {
+  sim_reset();
+  sensor = SimSCD30();
+  sim_attach(&sensor, SCD30_I2CADDR_DEFAULT);
+}
+
+/**
+ * @brief Wait until the sensor has a measurement waiting
+ *
+ * @param scd30 The driver
+ * @return true: ready false: nothing within 10 seconds
+ */
+static bool wait_ready(Adafruit_SCD30 *scd30) {
+  for (int i = 0; i < 100; i++) {
+    if (scd30->dataReady()) {
+      return true;
+    }
+    delay(100);
+  }
+  return false;
+}
+
+static void test_begin_starts_measuring(void) {
+  setup_sim();
+  Adafruit_SCD30 scd30;
+  TEST_ASSERT(scd30.begin());
+  TEST_ASSERT(sensor.running);
+  TEST_EQUAL(2, sensor.interval);
+  TEST_EQUAL(0, sensor.gap_violations);
+}
+
+static void test_begin_without_sensor(void) {
+  sim_reset();
+  Adafruit_SCD30 scd30;
+  TEST_ASSERT(!scd30.begin());
+}
+
+static void test_read_measurement(void) {
+  setup_sim();
+  Adafruit_SCD30 scd30;
+  TEST_ASSERT(scd30.begin());
+
+  sensor.co2 = 812.5f;
+  sensor.temperature = 23.25f;
+  sensor.humidity = 41.0f;
+  TEST_ASSERT(wait_ready(&scd30));
+  TEST_ASSERT(scd30.read());
+  TEST_CLOSE(812.5, scd30.CO2, 0);
+  TEST_CLOSE(23.25, scd30.temperature, 0);
+  TEST_CLOSE(41.0, scd30.relative_humidity, 0);
+  TEST_ASSERT(!scd30.dataReady());
+  TEST_EQUAL(0, sensor.gap_violations);
+}
+
+static void test_nonblocking_read(void) {
+  setup_sim();
+  Adafruit_SCD30 scd30;
+  TEST_ASSERT(scd30.begin());
+  TEST_ASSERT(wait_ready(&scd30));
+
+  TEST_ASSERT(scd30.beginRead());
+  TEST_EQUAL(SCD30_READ_PENDING, scd30.pollRead());
+  delay(4);
+  TEST_EQUAL(SCD30_READ_READY, scd30.pollRead());
+  TEST_EQUAL(SCD30_READ_IDLE, scd30.pollRead());
+  TEST_EQUAL(1, sensor.frames_read);
+  TEST_EQUAL(0, sensor.gap_violations);
+}
+
+static void test_settings_round_trip(void) {
+  setup_sim();
+  Adafruit_SCD30 scd30;
+  TEST_ASSERT(scd30.begin());
+
+  TEST_ASSERT(scd30.setMeasurementInterval(7));
+  TEST_ASSERT(scd30.setAltitudeOffset(120));
+  TEST_ASSERT(scd30.setTemperatureOffset(150));
+  TEST_ASSERT(scd30.forceRecalibrationWithReference(800));
+  TEST_ASSERT(scd30.selfCalibrationEnabled(true));
+  TEST_ASSERT(scd30.startContinuousMeasurement(1013));
+  TEST_EQUAL(7, sensor.interval);
+  TEST_EQUAL(120, sensor.altitude);
+  TEST_EQUAL(150, sensor.temperature_offset);
+  TEST_EQUAL(800, sensor.forced_reference);
+  TEST_EQUAL(1, sensor.self_calibration);
+  TEST_EQUAL(1013, sensor.pressure);
+
+  TEST_ASSERT(scd30.refreshConfig());
+  TEST_EQUAL(7, scd30.getMeasurementInterval());
+  TEST_EQUAL(120, scd30.getAltitudeOffset());
+  TEST_EQUAL(150, scd30.getTemperatureOffset());
+  TEST_EQUAL(800, scd30.getForcedCalibrationReference());
+  TEST_ASSERT(scd30.selfCalibrationEnabled());
+  TEST_EQUAL(1013, scd30.getAmbientPressureOffset());
+  TEST_EQUAL(0x0342, scd30.getFirmwareRevision());
+
+  // out of range values never reach the sensor
+  TEST_ASSERT(!scd30.setMeasurementInterval(1));
+  TEST_EQUAL(7, sensor.interval);
+}
+
+static void test_config_cached(void) {
+  setup_sim();
+  Adafruit_SCD30 scd30;
+  TEST_ASSERT(scd30.begin());
+  scd30_config_t config;
+  TEST_ASSERT(scd30.getConfig(&config));
+
+  // every getter is served from the driver's copy, over and over
+  uint32_t transactions = sim_bus_stats.transactions;
+  for (int i = 0; i < 3; i++) {
+    TEST_EQUAL(2, scd30.getMeasurementInterval());
+    TEST_EQUAL(0, scd30.getAltitudeOffset());
+    TEST_EQUAL(0, scd30.getTemperatureOffset());
+    TEST_EQUAL(400, scd30.getForcedCalibrationReference());
+    TEST_ASSERT(!scd30.selfCalibrationEnabled());
+    TEST_EQUAL(0, scd30.getAmbientPressureOffset());
+    TEST_ASSERT(scd30.getConfig(&config));
+  }
+  TEST_EQUAL(transactions, sim_bus_stats.transactions);
+
+  // a setter writes once and keeps the copy current
+  TEST_ASSERT(scd30.setAltitudeOffset(120));
+  TEST_EQUAL(transactions + 1, sim_bus_stats.transactions);
+  TEST_EQUAL(120, scd30.getAltitudeOffset());
+  TEST_EQUAL(transactions + 1, sim_bus_stats.transactions);
+
+  // reset() forgets the copy, so a change the driver didn't make is seen
+  sensor.altitude = 50;
+  TEST_EQUAL(120, scd30.getAltitudeOffset());
+  scd30.reset();
+  uint32_t reads = sensor.count(0x5102);
+  TEST_EQUAL(50, scd30.getAltitudeOffset());
+  TEST_EQUAL(reads + 1, sensor.count(0x5102));
+  TEST_EQUAL(50, scd30.getAltitudeOffset());
+  TEST_EQUAL(reads + 1, sensor.count(0x5102));
+
+  // and so does begin(), cold or warm
+  sensor.altitude = 60;
+  TEST_ASSERT(scd30.begin());
+  TEST_EQUAL(60, scd30.getAltitudeOffset());
+  sensor.temperature_offset = 99;
+  TEST_ASSERT(scd30.begin(SCD30_I2CADDR_DEFAULT, &Wire, 0, -1, true));
+  reads = sensor.count(0x5403);
+  TEST_EQUAL(99, scd30.getTemperatureOffset());
+  TEST_EQUAL(reads + 1, sensor.count(0x5403));
+}
+
+static void test_stop_and_reset(void) {
+  setup_sim();
+  Adafruit_SCD30 scd30;
+  TEST_ASSERT(scd30.begin());
+
+  TEST_ASSERT(scd30.stopContinuousMeasurement());
+  TEST_ASSERT(!sensor.running);
+  uint32_t resets = sensor.count(0xD304);
+  scd30.reset();
+  TEST_EQUAL(resets + 1, sensor.count(0xD304));
+  TEST_ASSERT(scd30.startContinuousMeasurement());
+  TEST_ASSERT(sensor.running);
+}
+
+static void test_measurement_cadence(void) {
+  setup_sim();
+  Adafruit_SCD30 scd30;
+  TEST_ASSERT(scd30.begin());
+  TEST_ASSERT(scd30.setMeasurementInterval(5));
+
+  // poll for a minute: one sample per interval, none missed or repeated
+  uint32_t start = millis();
+  uint32_t samples = 0;
+  while ((uint32_t)(millis() - start) < 61000) {
+    if (scd30.dataReady() && scd30.read()) {
+      samples++;
+    }
+    delay(250);
+  }
+  TEST_EQUAL(12, samples);
+  TEST_EQUAL(12, sensor.frames_read);
+  TEST_EQUAL(0, sensor.gap_violations);
+}
+
+static void test_corrupt_response(void) {
+  setup_sim();
+  Adafruit_SCD30 scd30;
+  TEST_ASSERT(scd30.begin());
+  TEST_ASSERT(wait_ready(&scd30));
+
+  scd30_retry_policy_t none = {1, 0, 0, 0};
+  scd30.setRetryPolicy(&none);
+  sensor.corrupt_reads = 1;
+  sensor.corrupt_word = 3;
+  TEST_ASSERT(!scd30.read());
+  TEST_ASSERT(scd30.read());
+}
+
+static void test_crc_checked_by_sensor(void) {
+  setup_sim();
+  Adafruit_I2CDevice device(SCD30_I2CADDR_DEFAULT);
+  TEST_ASSERT(device.begin());
+
+  // set interval to 10 with a bad CRC, then a good one
+  uint8_t bad[5] = {0x46, 0x00, 0x00, 0x0A, 0x00};
+  TEST_ASSERT(!device.write(bad, sizeof(bad)));
+  TEST_EQUAL(1, sensor.crc_rejects);
+  uint8_t good[5] = {0x46, 0x00, 0x00, 0x0A,
+                     Adafruit_SCD30::crc8(bad + 2, 2)};
+  TEST_ASSERT(device.write(good, sizeof(good)));
+  TEST_EQUAL(10, sensor.interval);
+}
+
+static void test_read_gap_enforced(void) {
+  setup_sim();
+  Adafruit_I2CDevice device(SCD30_I2CADDR_DEFAULT);
+  TEST_ASSERT(device.begin());
+
+  uint8_t command[2] = {0xD1, 0x00};
+  uint8_t response[3];
+  TEST_ASSERT(device.write(command, sizeof(command)));
+  TEST_ASSERT(!device.read(response, sizeof(response)));
+  TEST_EQUAL(1, sensor.gap_violations);
+
+  TEST_ASSERT(device.write(command, sizeof(command)));
+  delay(4);
+  TEST_ASSERT(device.read(response, sizeof(response)));
+  TEST_EQUAL(0x03, response[0]);
+  TEST_EQUAL(0x42, response[1]);
+  TEST_EQUAL(Adafruit_SCD30::crc8(response, 2), response[2]);
+}
+
+/**
+ * @brief Leave the sensor measuring every 10 s with its last sample read, as
+ * a microcontroller reset would find it
+ *
+ * @param pressure The pressure compensation it was started with
+ */
+static void setup_running_sensor(uint16_t pressure) {
+  setup_sim();
+  sensor.execute(0x0010, true, pressure);
+  sensor.execute(0x4600, true, 10);
+  host_advance_us(13000000);
+  uint16_t words[6];
+  sensor.respond(0x0300, words);
+}
+
+static void test_warm_start_mid_interval(void) {
+  setup_running_sensor(1013);
+  uint32_t starts = sensor.count(0x0010);
+
+  // no sample waiting, and the next one is due in 7 s: begin() doesn't wait
+  Adafruit_SCD30 scd30;
+  uint64_t start = host_time_us();
+  TEST_ASSERT(scd30.begin(SCD30_I2CADDR_DEFAULT, &Wire, 0, -1, true));
+  TEST_ASSERT(host_time_us() - start < 100000);
+  TEST_EQUAL(0, sensor.count(0xD304));
+  TEST_EQUAL(10, sensor.interval);
+
+  // the sample comes on time, so it is never restarted
+  TEST_ASSERT(wait_ready(&scd30));
+  TEST_ASSERT(host_time_us() - start < 7200000);
+  TEST_ASSERT(scd30.read());
+  for (int i = 0; i < 150; i++) {
+    scd30.dataReady();
+    delay(100);
+  }
+  // the pressure read back only
+  TEST_EQUAL(starts + 1, sensor.count(0x0010));
+  TEST_EQUAL(0, sensor.gap_violations);
+}
+
+static void test_warm_start_sample_waiting(void) {
+  setup_running_sensor(0);
+  uint32_t starts = sensor.count(0x0010);
+  host_advance_us(7000000);
+
+  Adafruit_SCD30 scd30;
+  uint64_t start = host_time_us();
+  TEST_ASSERT(scd30.begin(SCD30_I2CADDR_DEFAULT, &Wire, 0, -1, true));
+  TEST_ASSERT(host_time_us() - start < 100000);
+  TEST_ASSERT(scd30.dataReady());
+  TEST_EQUAL(starts + 1, sensor.count(0x0010));
+}
+
+static void test_warm_start_idle_sensor(void) {
+  setup_running_sensor(1013);
+  sensor.execute(0x0104, false, 0);
+  uint32_t starts = sensor.count(0x0010);
+
+  Adafruit_SCD30 scd30;
+  uint64_t start = host_time_us();
+  TEST_ASSERT(scd30.begin(SCD30_I2CADDR_DEFAULT, &Wire, 0, -1, true));
+  TEST_ASSERT(host_time_us() - start < 100000);
+  // the pressure read back, but no start yet
+  TEST_EQUAL(starts + 1, sensor.count(0x0010));
+  TEST_ASSERT(!sensor.running);
+
+  // stopped: nothing comes within the interval, so the data ready checks
+  // start it again with the pressure it had
+  while (host_time_us() - start < 10000000) {
+    TEST_ASSERT(!scd30.dataReady());
+    delay(100);
+  }
+  TEST_EQUAL(starts + 1, sensor.count(0x0010));
+  while (host_time_us() - start < 10700000) {
+    scd30.dataReady();
+    delay(100);
+  }
+  TEST_EQUAL(starts + 2, sensor.count(0x0010));
+  TEST_ASSERT(sensor.running);
+  TEST_EQUAL(1013, sensor.pressure);
+  TEST_EQUAL(10, sensor.interval);
+  TEST_ASSERT(wait_ready(&scd30));
+  TEST_ASSERT(scd30.read());
+}
+
+/**
+ * @brief Get an event from each of the Unified Sensors
+ *
+ * @param scd30 The driver
+ * @param events Where to store the CO2, temperature and humidity events
+ * @return uint32_t The bus transfers they took, or 0xFFFFFFFF if one failed or
+ * they don't share a timestamp
+ */
+static uint32_t get_events(Adafruit_SCD30 *scd30, sensors_event_t *events) {
+  uint32_t transactions = sim_bus_stats.transactions;
+  if (!scd30->getCO2Sensor()->getEvent(&events[0]) ||
+      !scd30->getTemperatureSensor()->getEvent(&events[1]) ||
+      !scd30->getHumiditySensor()->getEvent(&events[2]) ||
+      (events[0].timestamp != events[1].timestamp) ||
+      (events[0].timestamp != events[2].timestamp)) {
+    return 0xFFFFFFFF;
+  }
+  return sim_bus_stats.transactions - transactions;
+}
+
+static void test_unified_events_share_frame(void) {
+  setup_sim();
+  Adafruit_SCD30 scd30;
+  TEST_ASSERT(scd30.begin());
+  sensor.co2 = 812.5f;
+  sensor.temperature = 23.25f;
+  sensor.humidity = 41.0f;
+  delay(2100);
+
+  // the first event reads a frame, one command and response, and the other
+  // two reuse it
+  sensors_event_t events[3];
+  uint32_t frames = sensor.frames_read;
+  TEST_EQUAL(2, get_events(&scd30, events));
+  TEST_EQUAL(frames + 1, sensor.frames_read);
+  TEST_CLOSE(812.5, events[0].data[0], 0);
+  TEST_CLOSE(23.25, events[1].temperature, 0);
+  TEST_CLOSE(41.0, events[2].relative_humidity, 0);
+
+  // within the interval nothing new can be ready, so the bus is left alone
+  sensor.co2 = 900.0f;
+  sensor.temperature = 24.5f;
+  delay(500);
+  TEST_EQUAL(0, get_events(&scd30, events));
+  TEST_CLOSE(812.5, events[0].data[0], 0);
+  TEST_CLOSE(23.25, events[1].temperature, 0);
+
+  // once it may be, data ready is checked and the new frame read, once
+  delay(2000);
+  TEST_EQUAL(4, get_events(&scd30, events));
+  TEST_EQUAL(frames + 2, sensor.frames_read);
+  TEST_CLOSE(900.0, events[0].data[0], 0);
+  TEST_CLOSE(24.5, events[1].temperature, 0);
+  TEST_CLOSE(41.0, events[2].relative_humidity, 0);
+  TEST_EQUAL(0, get_events(&scd30, events));
+  TEST_EQUAL(0, sensor.gap_violations);
+}
+
+static uint32_t observed; ///< Observer calls
+
+/**
+ * @brief Count observer calls
+ *
+ * @param sample Unused
+ * @param reasons Unused
+ * @param context Unused
+ */
+static void count_observed(const scd30_snapshot_t *sample, uint8_t reasons,
+                           void *context) {
+  (void)sample;
+  (void)reasons;
+  (void)context;
+  observed++;
+}
+
+static void test_observer_without_deadband(void) {
+  setup_sim();
+  Adafruit_SCD30 scd30;
+  TEST_ASSERT(scd30.begin());
+  scd30_observer_t observer;
+  TEST_ASSERT(scd30.addObserver(&observer, count_observed, NULL, NULL));
+  observed = 0;
+
+  // with no deadband, every change is reported and nothing else
+  TEST_ASSERT(wait_ready(&scd30) && scd30.read());
+  TEST_EQUAL(1, observed);
+  TEST_ASSERT(wait_ready(&scd30) && scd30.read());
+  TEST_EQUAL(1, observed);
+  sensor.humidity += 0.5f;
+  TEST_ASSERT(wait_ready(&scd30) && scd30.read());
+  TEST_EQUAL(2, observed);
+  TEST_ASSERT(scd30.removeObserver(&observer));
+}
+
+static void test_template_driver(void) {
+  setup_sim();
+  Adafruit_I2CDevice device(SCD30_I2CADDR_DEFAULT);
+  Adafruit_SCD30_I2CDriver scd30;
+  scd30.transport().setDevice(&device);
+  TEST_ASSERT(scd30.begin());
+  TEST_ASSERT(sensor.running);
+
+  sensor.co2 = 1234.5f;
+  delay(2000);
+  TEST_ASSERT(scd30.dataReady());
+  TEST_ASSERT(scd30.read());
+  TEST_CLOSE(1234.5, scd30.CO2, 0);
+  TEST_EQUAL(0, sensor.gap_violations);
+}
+
+int main(void) {
+  RUN_TEST(test_begin_starts_measuring);
+  RUN_TEST(test_begin_without_sensor);
+  RUN_TEST(test_read_measurement);
+  RUN_TEST(test_nonblocking_read);
+  RUN_TEST(test_settings_round_trip);
+  RUN_TEST(test_config_cached);
+  RUN_TEST(test_stop_and_reset);
+  RUN_TEST(test_measurement_cadence);
+  RUN_TEST(test_corrupt_response);
+  RUN_TEST(test_crc_checked_by_sensor);
+  RUN_TEST(test_read_gap_enforced);
+  RUN_TEST(test_warm_start_mid_interval);
+  RUN_TEST(test_warm_start_sample_waiting);
+  RUN_TEST(test_warm_start_idle_sensor);
+  RUN_TEST(test_unified_events_share_frame);
+  RUN_TEST(test_observer_without_deadband);
+  RUN_TEST(test_template_driver);
+  return test_report();
+}
@@ -0,0 +1,129 @@
+/*!
+ *  @file test_duty.cpp
+ *
+ * 	Host tests of duty cycled acquisition against the simulated sensor:
+ * 	the sample cadence, the warm-up frame being dropped, and the bus left
+ * 	alone while the sensor is stopped
+ *
+ *
+ *	 BSD (see license.txt)
+ */
+
+#include "sim_scd30.h"
+#include "test.h"
+#include <Adafruit_SCD30_DutyCycle.h>
+
+#define MINUTE_MS 60000UL ///< A minute in ms
+
+static SimSCD30 sensor;
+static Adafruit_SCD30 scd30;
+static Adafruit_SCD30_History<16> history;
+
+/**
+ * @brief Start a freshly powered sensor measuring every 2 s, with a history
+ *
+ * @return true: success false: the driver could not start the sensor
+ */
+static bool setup_sensor(void) {
+  sim_reset();
+  sensor = SimSCD30();
+  sim_attach(&sensor, SCD30_I2CADDR_DEFAULT);
+  history.clear();
+  scd30.setHistory(&history);
+  return scd30.begin();
+}
+
+/**
+ * @brief Poll the duty cycle every 10 ms for a while
+ *
+ * @param duty The duty cycle
+ * @param duration_ms How long to run
+ * @param times Where to store `millis()` of each sample, or NULL
+ * @param max_times The room in `times`
+ * @return uint32_t The number of samples collected
+ */
+static uint32_t run(Adafruit_SCD30_DutyCycle *duty, uint32_t duration_ms,
+                    uint32_t *times, uint32_t max_times) {
+  uint32_t start = millis(), samples = 0;
+  while ((uint32_t)(millis() - start) < duration_ms) {
+    if (duty->poll()) {
+      if (times && (samples < max_times)) {
+        times[samples] = millis();
+      }
+      samples++;
+    }
+    delay(10);
+  }
+  return samples;
+}
+
+static void test_sample_every_period(void) {
+  TEST_ASSERT(setup_sensor());
+  Adafruit_SCD30_DutyCycle duty(&scd30);
+  uint32_t start = millis();
+  TEST_ASSERT(duty.begin(MINUTE_MS));
+  TEST_ASSERT(!sensor.running);
+
+  uint32_t times[8];
+  TEST_EQUAL(5, run(&duty, 5 * MINUTE_MS + 5000, times, 8));
+  // each sample is the first frame after its warm-up, a minute apart
+  TEST_ASSERT(times[0] - start >= MINUTE_MS);
+  TEST_ASSERT(times[0] - start < MINUTE_MS + 2500);
+  for (int i = 1; i < 5; i++) {
+    TEST_CLOSE(MINUTE_MS, times[i] - times[i - 1], 2100);
+  }
+
+  // the frame waiting after each warm-up was dropped, not recorded
+  TEST_EQUAL(5, history.size());
+  scd30_duty_budget_t budget;
+  duty.getBudget(&budget);
+  TEST_EQUAL(5, budget.samples);
+  TEST_ASSERT(budget.idle_ms > budget.active_ms * 3 / 2);
+  TEST_ASSERT(budget.average_ua < SCD30_DUTY_ACTIVE_UA);
+  TEST_EQUAL(0, sensor.gap_violations);
+  scd30.setHistory(NULL);
+}
+
+static void test_idle_leaves_bus_alone(void) {
+  TEST_ASSERT(setup_sensor());
+  Adafruit_SCD30_DutyCycle duty(&scd30);
+  TEST_ASSERT(duty.begin(MINUTE_MS));
+  uint32_t times[1];
+  TEST_EQUAL(1, run(&duty, MINUTE_MS + 3000, times, 1));
+  // let it stop, then nothing until the next warm-up
+  run(&duty, 1000, NULL, 0);
+  TEST_ASSERT(!sensor.running);
+  uint32_t transactions = sim_bus_stats.transactions;
+  run(&duty, 40000, NULL, 0);
+  TEST_EQUAL(transactions, sim_bus_stats.transactions);
+  TEST_ASSERT(!sensor.running);
+  scd30.setHistory(NULL);
+}
+
+static void test_short_period_stops_anyway(void) {
+  TEST_ASSERT(setup_sensor());
+  Adafruit_SCD30_DutyCycle duty(&scd30);
+  uint32_t stops = sensor.count(0x0104);
+  TEST_ASSERT(duty.begin(5000));
+
+  // shorter than the warm-up plus a frame: stopped after every sample, and
+  // each comes a warm-up and a frame after the last
+  uint32_t times[8];
+  uint32_t samples = run(&duty, MINUTE_MS, times, 8);
+  TEST_ASSERT(samples >= 4);
+  TEST_ASSERT(samples <= 5);
+  for (uint32_t i = 1; i < samples; i++) {
+    TEST_ASSERT(times[i] - times[i - 1] >= SCD30_DUTY_WARMUP_MS);
+    TEST_ASSERT(times[i] - times[i - 1] < SCD30_DUTY_WARMUP_MS + 2500);
+  }
+  TEST_ASSERT(sensor.count(0x0104) >= stops + samples);
+  TEST_EQUAL(samples, history.size());
+  scd30.setHistory(NULL);
+}
+
+int main(void) {
+  RUN_TEST(test_sample_every_period);
+  RUN_TEST(test_idle_leaves_bus_alone);
+  RUN_TEST(test_short_period_stops_anyway);
+  return test_report();
+}
@@ -0,0 +1,260 @@
+/*!
+ *  @file test_filter.cpp
+ *
+ * 	Host tests of the fixed point filter stages and the pipeline that chains
+ * 	them: the median against a sorted copy of its window, the rounding of
+ * 	the average and the Kalman estimate, and each channel's chain
+ *
+ *
+ *	 BSD (see license.txt)
+ */
+
+#include "test.h"
+#include <Adafruit_SCD30_Filter.h>
+#include <algorithm>
+#include <stdlib.h>
+
+/**
+ * @brief Halve a value, rounding halves away from zero like the filters do
+ *
+ * @param value The value
+ * @return int32_t The rounded half
+ */
+static int32_t halve(int64_t value) {
+  return (value + ((value < 0) ? -1 : 1)) / 2;
+}
+
+/**
+ * @brief Feed random values to a median and compare each result with the
+ * median of a sorted copy of the last `size` values
+ *
+ * @param median The median, empty or reset
+ * @param size Its window size
+ * @param range Values are drawn from -`range` to `range`
+ * @return int The number of results that disagree
+ */
+static int check_median(Adafruit_SCD30_MedianBase *median, uint8_t size,
+                        int32_t range) {
+  int32_t values[400];
+  int mismatches = 0;
+  for (int i = 0; i < 400; i++) {
+    values[i] = (int32_t)(rand() % (2 * range + 1)) - range;
+    int count = (i + 1 < size) ? i + 1 : size;
+    int32_t window[32];
+    std::copy(values + i + 1 - count, values + i + 1, window);
+    std::sort(window, window + count);
+    int32_t expected = window[count / 2];
+    if (!(count & 1)) {
+      expected = halve((int64_t)window[count / 2 - 1] + window[count / 2]);
+    }
+    mismatches += (median->update(values[i]) != expected);
+  }
+  return mismatches;
+}
+
+static void test_median_matches_sort(void) {
+  srand(21);
+  Adafruit_SCD30_Median<1> one;
+  Adafruit_SCD30_Median<4> four;
+  Adafruit_SCD30_Median<5> five;
+  Adafruit_SCD30_Median<31> large;
+  TEST_EQUAL(0, check_median(&one, 1, 1000));
+  TEST_EQUAL(0, check_median(&four, 4, 1000));
+  TEST_EQUAL(0, check_median(&five, 5, 1000));
+  TEST_EQUAL(0, check_median(&large, 31, 1000));
+  // few distinct values, so the window holds many repeats
+  five.reset();
+  four.reset();
+  TEST_EQUAL(0, check_median(&five, 5, 2));
+  TEST_EQUAL(0, check_median(&four, 4, 2));
+  // the whole input range
+  large.reset();
+  TEST_EQUAL(0, check_median(&large, 31, SCD30_FILTER_INPUT_MAX));
+
+  // after a reset the window starts empty again
+  five.reset();
+  TEST_EQUAL(7, five.update(7));
+  TEST_EQUAL(9, five.update(11));
+}
+
+static void test_median_rejects_spike(void) {
+  Adafruit_SCD30_Median<3> median;
+  TEST_EQUAL(4000, median.update(4000));
+  TEST_EQUAL(4005, median.update(4010));
+  TEST_EQUAL(4010, median.update(60000));
+  TEST_EQUAL(4020, median.update(4020));
+}
+
+static void test_ema_rounding(void) {
+  Adafruit_SCD30_EMA pass(0);
+  TEST_EQUAL(-1234, pass.update(-1234));
+  TEST_EQUAL(5678, pass.update(5678));
+
+  // a quarter of each step: 2.5 rounds to 3, 4.375 to 4
+  Adafruit_SCD30_EMA up(2), down(2);
+  TEST_EQUAL(0, up.update(0));
+  TEST_EQUAL(3, up.update(10));
+  TEST_EQUAL(4, up.update(10));
+  TEST_EQUAL(0, down.update(0));
+  TEST_EQUAL(-3, down.update(-10));
+  TEST_EQUAL(-4, down.update(-10));
+
+  // steps are cut toward zero, but the fraction bits still carry the
+  // average to within rounding of a steady input from either side
+  Adafruit_SCD30_EMA slow(3), slow_negative(3);
+  slow.update(0);
+  slow_negative.update(0);
+  int32_t last = 0, last_negative = 0;
+  for (int i = 0; i < 1000; i++) {
+    last = slow.update(1);
+    last_negative = slow_negative.update(-1);
+  }
+  TEST_EQUAL(1, last);
+  TEST_EQUAL(-1, last_negative);
+
+  // the first value after a reset is taken as is
+  slow.reset();
+  TEST_EQUAL(-500, slow.update(-500));
+
+  // the largest inputs don't overflow the state
+  Adafruit_SCD30_EMA wide(15);
+  TEST_EQUAL(-SCD30_FILTER_INPUT_MAX, wide.update(-SCD30_FILTER_INPUT_MAX));
+  TEST_ASSERT(wide.update(SCD30_FILTER_INPUT_MAX) > -SCD30_FILTER_INPUT_MAX);
+}
+
+static void test_kalman_rounding(void) {
+  // equal variances: the second reading is weighed the same as the first,
+  // and 2.5 rounds away from zero either way
+  Adafruit_SCD30_Kalman up(0, 300), down(0, 300);
+  TEST_EQUAL(0, up.update(0));
+  TEST_EQUAL(3, up.update(5));
+  TEST_EQUAL(0, down.update(0));
+  TEST_EQUAL(-3, down.update(-5));
+  // then the estimate is trusted twice as much: 2.5 + (5 - 2.5) / 3
+  TEST_EQUAL(3, up.update(5));
+  TEST_EQUAL(-3, down.update(-5));
+
+  // no measurement noise: every reading is taken as is
+  Adafruit_SCD30_Kalman exact(100, 0);
+  TEST_EQUAL(-700, exact.update(-700));
+  TEST_EQUAL(1234, exact.update(1234));
+  TEST_EQUAL(-1, exact.update(-1));
+
+  // a steady input is held exactly
+  Adafruit_SCD30_Kalman steady(4, 90000);
+  for (int i = 0; i < 200; i++) {
+    TEST_EQUAL(-2150, steady.update(-2150));
+  }
+
+  // and noise around it is pulled in once the gain settles
+  Adafruit_SCD30_Kalman noisy(4, 90000);
+  noisy.update(4000);
+  int32_t estimate = 0;
+  for (int i = 0; i < 200; i++) {
+    estimate = noisy.update((i & 1) ? 4300 : 3700);
+  }
+  TEST_CLOSE(4000, estimate, 40);
+  noisy.reset();
+  TEST_EQUAL(100, noisy.update(100));
+}
+
+static void test_stage_chain(void) {
+  Adafruit_SCD30_Filter filter;
+  Adafruit_SCD30_Median<3> median, median_check;
+  Adafruit_SCD30_EMA ema(2), ema_check(2);
+  Adafruit_SCD30_Kalman kalman(100, 0);
+  TEST_ASSERT(filter.addStage(SCD30_CHANNEL_CO2, &median));
+  TEST_ASSERT(filter.addStage(SCD30_CHANNEL_CO2, &ema));
+  TEST_ASSERT(filter.addStage(SCD30_CHANNEL_TEMPERATURE, &kalman));
+  TEST_ASSERT(!filter.addStage(SCD30_CHANNEL_COUNT, &ema_check));
+  TEST_ASSERT(!filter.addStage(SCD30_CHANNEL_HUMIDITY, NULL));
+  // a stage already in a chain is refused, leaving the chains as they were
+  TEST_ASSERT(!filter.addStage(SCD30_CHANNEL_CO2, &median));
+  TEST_ASSERT(!filter.addStage(SCD30_CHANNEL_CO2, &ema));
+  TEST_ASSERT(!filter.addStage(SCD30_CHANNEL_HUMIDITY, &ema));
+  TEST_ASSERT(!filter.addStage(SCD30_CHANNEL_CO2, &kalman));
+
+  scd30_compact_sample_t sample;
+  TEST_ASSERT(!filter.getFiltered(&sample));
+
+  // CO2 runs through the median and then the average, in that order
+  srand(3);
+  for (int i = 0; i < 50; i++) {
+    scd30_compact_sample_t raw = {(uint32_t)(4000 + rand() % 2000),
+                                  (int16_t)(rand() % 4000 - 1000),
+                                  (uint16_t)(rand() % 10000)};
+    if (i % 7 == 3) {
+      raw.co2 = 200000;
+    }
+    filter.update(&raw);
+    int32_t expected = ema_check.update(median_check.update(raw.co2));
+
+    TEST_ASSERT(filter.getFiltered(&sample));
+    TEST_EQUAL(expected, sample.co2);
+    // a Kalman stage with no measurement noise takes each reading
+    TEST_EQUAL(raw.temperature, sample.temperature);
+    // no stages: passed through
+    TEST_EQUAL(raw.humidity, sample.humidity);
+    scd30_compact_sample_t kept;
+    TEST_ASSERT(filter.getRaw(&kept));
+    TEST_EQUAL(raw.co2, kept.co2);
+  }
+
+  float co2, temperature, humidity;
+  TEST_ASSERT(filter.getFiltered(&co2, &temperature, &humidity));
+  TEST_CLOSE(sample.co2 / 10.0, co2, 0.01);
+
+  // every stage starts afresh after a reset
+  filter.reset();
+  TEST_ASSERT(!filter.getFiltered(&sample));
+  scd30_compact_sample_t raw = {8000, 2500, 5000};
+  filter.update(&raw);
+  TEST_ASSERT(filter.getFiltered(&sample));
+  TEST_EQUAL(8000, sample.co2);
+}
+
+/*!
+ *    @brief  Stage that adds a fixed amount
+ */
+class Offset : public Adafruit_SCD30_FilterStage {
+public:
+  /** @brief Construct it
+      @param offset The amount to add */
+  Offset(int32_t offset) : _offset(offset) {}
+  /** @brief Add the offset
+      @param value The value
+      @return The value plus the offset */
+  int32_t update(int32_t value) { return value + _offset; }
+  /** @brief Nothing to forget */
+  void reset(void) {}
+
+private:
+  int32_t _offset; ///< The amount added
+};
+
+static void test_chain_clamps(void) {
+  Adafruit_SCD30_Filter filter;
+  Offset up(SCD30_FILTER_INPUT_MAX), down(-40000), check(0);
+  TEST_ASSERT(filter.addStage(SCD30_CHANNEL_CO2, &up));
+  TEST_ASSERT(filter.addStage(SCD30_CHANNEL_CO2, &check));
+  TEST_ASSERT(filter.addStage(SCD30_CHANNEL_TEMPERATURE, &down));
+
+  // each stage sees its input clamped, and the output is clamped to the
+  // compact sample's range
+  scd30_compact_sample_t raw = {SCD30_COMPACT_CO2_MAX, -100, 0};
+  filter.update(&raw);
+  scd30_compact_sample_t sample;
+  TEST_ASSERT(filter.getFiltered(&sample));
+  TEST_EQUAL(SCD30_FILTER_INPUT_MAX, sample.co2);
+  TEST_EQUAL(INT16_MIN, sample.temperature);
+}
+
+int main(void) {
+  RUN_TEST(test_median_matches_sort);
+  RUN_TEST(test_median_rejects_spike);
+  RUN_TEST(test_ema_rounding);
+  RUN_TEST(test_kalman_rounding);
+  RUN_TEST(test_stage_chain);
+  RUN_TEST(test_chain_clamps);
+  return test_report();
+}
@@ -0,0 +1,187 @@
+/*!
+ *  @file test_frame.cpp
+ *
+ * 	Host tests of the bulk frame decoder. Built once per code path, scalar,
+ * 	SSSE3 and NEON, each checked against an independent decode and against
+ * 	`scd30_decode_frames_scalar`, bit for bit.
+ *
+ *
+ *	 BSD (see license.txt)
+ */
+
+#include "test.h"
+#include <Adafruit_SCD30_Frame.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_FRAMES 1000 ///< Largest batch decoded
+
+#if defined(SCD30_FRAME_SSSE3)
+#define FRAME_PATH "SSSE3" ///< Code path under test
+#elif defined(SCD30_FRAME_NEON)
+#define FRAME_PATH "NEON" ///< Code path under test
+#else
+#define FRAME_PATH "scalar" ///< Code path under test
+#endif
+
+static uint8_t frames[MAX_FRAMES * SCD30_FRAME_SIZE];
+static float expected[3][MAX_FRAMES];
+static uint8_t expected_valid[MAX_FRAMES];
+static float readings[2][3][MAX_FRAMES];
+static uint8_t valid[2][MAX_FRAMES];
+
+/**
+ * @brief CRC-8 as the datasheet gives it, bit by bit
+ *
+ * @param data The bytes to check
+ * @param len The number of bytes
+ * @return uint8_t The CRC
+ */
+static uint8_t crc8(const uint8_t *data, size_t len) {
+  uint8_t crc = 0xFF;
+  while (len--) {
+    crc ^= *data++;
+    for (uint8_t bit = 0; bit < 8; bit++) {
+      crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x31) : (uint8_t)(crc << 1);
+    }
+  }
+  return crc;
+}
+
+/**
+ * @brief Fill `frames` with random readings and their CRCs, noting what each
+ * frame should decode to
+ *
+ * @param count The number of frames
+ */
+static void make_frames(size_t count) {
+  for (size_t f = 0; f < count; f++) {
+    uint8_t *frame = frames + f * SCD30_FRAME_SIZE;
+    for (int r = 0; r < 3; r++) {
+      // any bit pattern, NaNs and denormals included, must pass unchanged
+      uint32_t bits = (uint32_t)rand() << 16 ^ (uint32_t)rand();
+      memcpy(&expected[r][f], &bits, sizeof(float));
+      for (int w = 0; w < 2; w++) {
+        uint8_t *word = frame + 6 * r + 3 * w;
+        word[0] = bits >> (24 - 16 * w);
+        word[1] = bits >> (16 - 16 * w);
+        word[2] = crc8(word, 2);
+      }
+    }
+    expected_valid[f] = 1;
+  }
+}
+
+/**
+ * @brief Flip one bit of a frame, which then decodes to zeros
+ *
+ * @param f The frame
+ * @param byte The byte in the frame
+ * @param bit The bit in the byte
+ */
+static void corrupt(size_t f, int byte, int bit) {
+  frames[f * SCD30_FRAME_SIZE + byte] ^= 1 << bit;
+  for (int r = 0; r < 3; r++) {
+    expected[r][f] = 0;
+  }
+  expected_valid[f] = 0;
+}
+
+/**
+ * @brief Decode `count` frames both ways and compare with what was encoded
+ *
+ * @param count The number of frames
+ * @param with_valid Whether to ask for the validity flags
+ * @return size_t The number of mismatched frames
+ */
+static size_t check(size_t count, bool with_valid) {
+  size_t good = 0;
+  for (size_t f = 0; f < count; f++) {
+    good += expected_valid[f];
+  }
+
+  memset(readings, 0xA5, sizeof(readings));
+  memset(valid, 0xA5, sizeof(valid));
+  size_t fast =
+      scd30_decode_frames(frames, count, readings[0][0], readings[0][1],
+                          readings[0][2], with_valid ? valid[0] : NULL);
+  size_t scalar =
+      scd30_decode_frames_scalar(frames, count, readings[1][0], readings[1][1],
+                                 readings[1][2], with_valid ? valid[1] : NULL);
+
+  size_t mismatches = (fast != good) + (scalar != good);
+  for (size_t f = 0; f < count; f++) {
+    for (int path = 0; path < 2; path++) {
+      bool same = true;
+      for (int r = 0; r < 3; r++) {
+        same &= !memcmp(&readings[path][r][f], &expected[r][f], sizeof(float));
+      }
+      if (with_valid) {
+        same &= valid[path][f] == expected_valid[f];
+      } else {
+        same &= valid[path][f] == 0xA5;
+      }
+      mismatches += !same;
+    }
+  }
+  return mismatches;
+}
+
+static void test_batch_sizes(void) {
+  static const size_t sizes[] = {0, 1, 7, 8, 9, 15, 16, 17, 63, 64, 65, 1000};
+  for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+    make_frames(sizes[i]);
+    TEST_EQUAL(0, check(sizes[i], true));
+    TEST_EQUAL(0, check(sizes[i], false));
+  }
+}
+
+static void test_every_corrupted_bit(void) {
+  // a single bad bit anywhere in a frame, at every position in a SIMD step
+  for (int byte = 0; byte < SCD30_FRAME_SIZE; byte++) {
+    for (int bit = 0; bit < 8; bit++) {
+      make_frames(24);
+      corrupt((byte * 8 + bit) % 24, byte, bit);
+      TEST_EQUAL(0, check(24, true));
+    }
+  }
+}
+
+static void test_random_corruption(void) {
+  make_frames(MAX_FRAMES);
+  for (size_t f = 0; f < MAX_FRAMES; f++) {
+    if (rand() % 4 == 0) {
+      corrupt(f, rand() % SCD30_FRAME_SIZE, rand() % 8);
+    }
+  }
+  TEST_EQUAL(0, check(MAX_FRAMES, true));
+}
+
+static void test_all_corrupted(void) {
+  make_frames(64);
+  for (size_t f = 0; f < 64; f++) {
+    corrupt(f, 17, 0);
+  }
+  TEST_EQUAL(0, check(64, true));
+}
+
+static void test_unaligned_input(void) {
+  make_frames(33);
+  memmove(frames + 1, frames, 33 * SCD30_FRAME_SIZE);
+  float co2[33], temperature[33], humidity[33];
+  TEST_EQUAL(33, scd30_decode_frames(frames + 1, 33, co2, temperature,
+                                     humidity, NULL));
+  TEST_ASSERT(!memcmp(co2, expected[0], sizeof(co2)));
+  TEST_ASSERT(!memcmp(humidity, expected[2], sizeof(humidity)));
+}
+
+int main(void) {
+  printf("frame decoder: %s\n", FRAME_PATH);
+  srand(30);
+  RUN_TEST(test_batch_sizes);
+  RUN_TEST(test_every_corrupted_bit);
+  RUN_TEST(test_random_corruption);
+  RUN_TEST(test_all_corrupted);
+  RUN_TEST(test_unaligned_input);
+  return test_report();
+}
@@ -0,0 +1,168 @@
+/*!
+ *  @file test_history.cpp
+ *
+ * 	Host tests of the sample history and its rolling statistics, checked
+ * 	against sums over the samples it holds
+ *
+ *
+ *	 BSD (see license.txt)
+ */
+
+#include "test.h"
+#include <Adafruit_SCD30_History.h>
+#include <math.h>
+#include <stdlib.h>
+
+static Adafruit_SCD30_History<16> small;
+static Adafruit_SCD30_History<SCD30_HISTORY_MAX_SIZE> large;
+
+/**
+ * @brief Work out a channel's statistics from the stored samples
+ *
+ * @param history The history
+ * @param channel The channel
+ * @param stats Where to store the statistics
+ */
+static void brute_force(const Adafruit_SCD30_HistoryBase *history,
+                        scd30_channel_t channel, scd30_history_stats_t *stats) {
+  double scale = (channel == SCD30_CHANNEL_CO2) ? 0.1 : 0.01;
+  double sum = 0, squares = 0, min = INFINITY, max = -INFINITY;
+  for (uint16_t i = 0; i < history->size(); i++) {
+    scd30_history_sample_t sample;
+    history->get(i, &sample);
+    double v = sample.humidity * scale;
+    if (channel == SCD30_CHANNEL_CO2) {
+      v = sample.co2 * scale;
+    } else if (channel == SCD30_CHANNEL_TEMPERATURE) {
+      v = sample.temperature * scale;
+    }
+    sum += v;
+    squares += v * v;
+    min = fmin(min, v);
+    max = fmax(max, v);
+  }
+  double mean = sum / history->size();
+  stats->mean = mean;
+  stats->variance = squares / history->size() - mean * mean;
+  stats->min = min;
+  stats->max = max;
+}
+
+/**
+ * @brief Check a statistic to float precision
+ *
+ * @param actual The history's value
+ * @param expected The brute force value
+ * @return true: they agree
+ */
+static bool close(float actual, double expected) {
+  return fabs(actual - expected) <= 1e-5 * fabs(expected) + 1e-3;
+}
+
+/**
+ * @brief Compare the history's statistics for every channel with the brute
+ * force ones
+ *
+ * @param history The history
+ * @return int The number of channels that disagree
+ */
+static int check_stats(const Adafruit_SCD30_HistoryBase *history) {
+  int mismatches = 0;
+  for (uint8_t ch = 0; ch < SCD30_CHANNEL_COUNT; ch++) {
+    scd30_history_stats_t stats, expected;
+    if (!history->getStats((scd30_channel_t)ch, &stats)) {
+      return SCD30_CHANNEL_COUNT;
+    }
+    brute_force(history, (scd30_channel_t)ch, &expected);
+    // float has 24 bits, and the readings are scaled in float
+    mismatches += !close(stats.mean, expected.mean) ||
+                  !close(stats.variance, expected.variance) ||
+                  !close(stats.min, expected.min) ||
+                  !close(stats.max, expected.max);
+  }
+  return mismatches;
+}
+
+static void test_sample_size(void) {
+  TEST_EQUAL(12, sizeof(scd30_history_sample_t));
+}
+
+static void test_co2_tenths(void) {
+  small.clear();
+  small.add(812.5f, 23.25f, 41.0f, 1000);
+  small.add(812.6f, -5.5f, 41.5f, 3000);
+
+  scd30_history_sample_t sample;
+  TEST_ASSERT(small.get(0, &sample));
+  TEST_EQUAL(8125, sample.co2);
+  TEST_EQUAL(2325, sample.temperature);
+  TEST_EQUAL(4100, sample.humidity);
+  TEST_EQUAL(1000, sample.timestamp);
+
+  scd30_history_stats_t stats;
+  TEST_ASSERT(small.getStats(SCD30_CHANNEL_CO2, &stats));
+  TEST_CLOSE(812.55, stats.mean, 0.001);
+  TEST_CLOSE(0.0025, stats.variance, 0.0001);
+  TEST_CLOSE(812.5, stats.min, 0.001);
+  TEST_CLOSE(812.6, stats.max, 0.001);
+}
+
+static void test_nan_and_range(void) {
+  small.clear();
+  small.add(NAN, NAN, NAN, 0);
+  small.add(INFINITY, -INFINITY, 150, 0);
+  small.add(-10, 400, -1, 0);
+
+  scd30_history_sample_t sample;
+  TEST_ASSERT(small.get(0, &sample));
+  TEST_EQUAL(0, sample.co2);
+  TEST_EQUAL(0, sample.temperature);
+  TEST_EQUAL(0, sample.humidity);
+  TEST_ASSERT(small.get(1, &sample));
+  TEST_EQUAL(SCD30_COMPACT_CO2_MAX, sample.co2);
+  TEST_EQUAL(INT16_MIN, sample.temperature);
+  TEST_EQUAL(10000, sample.humidity);
+  TEST_ASSERT(small.get(2, &sample));
+  TEST_EQUAL(0, sample.co2);
+  TEST_EQUAL(INT16_MAX, sample.temperature);
+  TEST_EQUAL(0, sample.humidity);
+  TEST_EQUAL(0, check_stats(&small));
+}
+
+static void test_rolling_window(void) {
+  small.clear();
+  srand(8);
+  for (int i = 0; i < 200; i++) {
+    small.add(400 + rand() % 4000 + (rand() % 10) / 10.0f,
+              (rand() % 8000 - 2000) / 100.0f, (rand() % 10000) / 100.0f, i);
+    TEST_EQUAL(0, check_stats(&small));
+  }
+  TEST_EQUAL(16, small.size());
+}
+
+static void test_full_scale_sums(void) {
+  // every sample at the top of each range, in the largest history
+  large.clear();
+  for (uint16_t i = 0; i < SCD30_HISTORY_MAX_SIZE; i++) {
+    large.add(2e6f, 327.67f, 100, i);
+  }
+  scd30_history_stats_t stats;
+  TEST_ASSERT(large.getStats(SCD30_CHANNEL_CO2, &stats));
+  TEST_CLOSE(SCD30_COMPACT_CO2_MAX / 10.0, stats.mean, 1);
+  TEST_CLOSE(0, stats.variance, 0);
+
+  // and half of them at the bottom
+  for (uint16_t i = 0; i < SCD30_HISTORY_MAX_SIZE / 2; i++) {
+    large.add(0, -327.68f, 0, i);
+  }
+  TEST_EQUAL(0, check_stats(&large));
+}
+
+int main(void) {
+  RUN_TEST(test_sample_size);
+  RUN_TEST(test_co2_tenths);
+  RUN_TEST(test_nan_and_range);
+  RUN_TEST(test_rolling_window);
+  RUN_TEST(test_full_scale_sums);
+  return test_report();
+}
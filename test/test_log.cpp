@@ -0,0 +1,288 @@
+/*!
+ *  @file test_log.cpp
+ *
+ * 	Host tests of the binary log format: logs written by the encoder and
+ * 	read back by the decoder in chunks of every size, resynchronization
+ * 	after corrupted data, and the largest record
+ *
+ *
+ *	 BSD (see license.txt)
+ */
+
+#include "test.h"
+#include <Adafruit_SCD30_Log.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define LOG_SAMPLES 300 ///< Samples in the test log
+#define LOG_SIZE 8192   ///< Room for the test log
+
+/** A sample as written, to compare with what is read back */
+typedef struct {
+  scd30_compact_sample_t sample; ///< The readings
+  uint32_t timestamp;            ///< When they were read
+  int32_t sensor_id;             ///< Sensor ID of the segment
+} logged_t;
+
+static uint8_t log_data[LOG_SIZE];
+static size_t log_size;
+static logged_t written[LOG_SAMPLES];
+static uint32_t written_count;
+
+/**
+ * @brief Write a log of two segments, the second appended as after a
+ * restart, with noisy readings, late samples and the clock going backwards
+ *
+ * @param keyframe_interval Records between keyframes
+ */
+static void write_log(uint16_t keyframe_interval) {
+  Adafruit_SCD30_LogEncoder encoder(keyframe_interval);
+  srand(16);
+  log_size = 0;
+  written_count = 0;
+
+  scd30_compact_sample_t sample = {8000, 2150, 4500};
+  uint32_t timestamp = 5000;
+  int32_t sensor_id = 12345;
+  log_size += encoder.begin(sensor_id, 2, log_data);
+  for (uint32_t i = 0; i < LOG_SAMPLES; i++) {
+    if (i == LOG_SAMPLES / 2) {
+      // a restart: new segment, new sensor, millis() from zero
+      sensor_id = -7;
+      timestamp = 1000;
+      log_size += encoder.begin(sensor_id, 5, log_data + log_size);
+    }
+    uint32_t interval_ms = (i < LOG_SAMPLES / 2) ? 2000 : 5000;
+    timestamp += interval_ms + rand() % 40 - 20;
+    if (i % 37 == 36) {
+      // a missed sample
+      timestamp += interval_ms;
+    }
+    sample.co2 += rand() % 200 - 100;
+    sample.temperature += rand() % 20 - 10;
+    sample.humidity += rand() % 10 - 5;
+
+    written[i].sample = sample;
+    written[i].timestamp = timestamp;
+    written[i].sensor_id = sensor_id;
+    uint8_t len = encoder.add(&sample, timestamp, log_data + log_size);
+    TEST_ASSERT(len <= SCD30_LOG_MAX_RECORD_SIZE);
+    log_size += len;
+    written_count++;
+  }
+}
+
+/**
+ * @brief Check a decoded sample against the one written
+ *
+ * @param decoder The decoder
+ * @param index The number of the sample
+ * @return true: they match
+ */
+static bool matches(const Adafruit_SCD30_LogDecoder *decoder,
+                    uint32_t index) {
+  const logged_t *expected = &written[index];
+  const scd30_compact_sample_t &sample = decoder->sample();
+  return (sample.co2 == expected->sample.co2) &&
+         (sample.temperature == expected->sample.temperature) &&
+         (sample.humidity == expected->sample.humidity) &&
+         (decoder->timestamp() == expected->timestamp) &&
+         (decoder->sensorId() == expected->sensor_id);
+}
+
+/**
+ * @brief Read the log back as a stream arriving `chunk` bytes at a time,
+ * decoding whatever has arrived
+ *
+ * @param data The log
+ * @param size The size of the log
+ * @param chunk The bytes that arrive at a time
+ * @param lost Set to the number of samples skipped after corrupt data
+ * @param corrupt Set to the number of corrupt results
+ * @return uint32_t The number of samples that matched the ones written, in
+ * order. Decoding stops at the first that doesn't.
+ */
+static uint32_t read_log(const uint8_t *data, size_t size, size_t chunk,
+                         uint32_t *lost, uint32_t *corrupt) {
+  Adafruit_SCD30_LogDecoder decoder;
+  uint8_t pending[2 * SCD30_LOG_MAX_RECORD_SIZE + LOG_SIZE];
+  size_t buffered = 0, offset = 0;
+  uint32_t matched = 0, next = 0;
+  bool resyncing = true;
+  *lost = 0;
+  *corrupt = 0;
+
+  while (offset < size) {
+    size_t arriving = (size - offset < chunk) ? size - offset : chunk;
+    memcpy(pending + buffered, data + offset, arriving);
+    buffered += arriving;
+    offset += arriving;
+
+    size_t start = 0, used;
+    for (;;) {
+      scd30_log_result_t result =
+          decoder.decode(pending + start, buffered - start, &used);
+      start += used;
+      if (result == SCD30_LOG_NEED_MORE) {
+        break;
+      }
+      if (result == SCD30_LOG_CORRUPT) {
+        (*corrupt)++;
+        resyncing = true;
+      } else if (result == SCD30_LOG_SAMPLE) {
+        if (resyncing) {
+          // samples may have been lost, but never reordered
+          uint32_t found = next;
+          while ((found < written_count) && !matches(&decoder, found)) {
+            found++;
+          }
+          *lost += found - next;
+          next = found;
+          resyncing = false;
+        }
+        if ((next >= written_count) || !matches(&decoder, next)) {
+          return matched;
+        }
+        next++;
+        matched++;
+      }
+    }
+    memmove(pending, pending + start, buffered - start);
+    buffered -= start;
+  }
+  *lost += written_count - next;
+  return matched;
+}
+
+static void test_round_trip(void) {
+  write_log(SCD30_LOG_KEYFRAME_INTERVAL);
+  uint32_t lost, corrupt;
+  TEST_EQUAL(LOG_SAMPLES, read_log(log_data, log_size, log_size, &lost,
+                                   &corrupt));
+  TEST_EQUAL(0, lost);
+  TEST_EQUAL(0, corrupt);
+  // mostly differences, which are a few bytes each
+  TEST_ASSERT(log_size < LOG_SAMPLES * 7);
+}
+
+static void test_chunked(void) {
+  write_log(10);
+  // every chunk size up to a few records, so records split at every byte
+  for (size_t chunk = 1; chunk <= 3 * SCD30_LOG_MAX_RECORD_SIZE; chunk++) {
+    uint32_t lost, corrupt;
+    TEST_EQUAL(LOG_SAMPLES, read_log(log_data, log_size, chunk, &lost,
+                                     &corrupt));
+    TEST_EQUAL(0, corrupt);
+  }
+}
+
+static void test_resync_after_corruption(void) {
+  write_log(10);
+  static uint8_t damaged[LOG_SIZE];
+
+  // damage a byte well into the first segment, then in turn every byte of
+  // a stretch of it
+  for (size_t at = 400; at < 440; at++) {
+    memcpy(damaged, log_data, log_size);
+    damaged[at] ^= 0x5A;
+    uint32_t lost, corrupt;
+    uint32_t matched = read_log(damaged, log_size, 7, &lost, &corrupt);
+    TEST_ASSERT(corrupt > 0);
+    // reading carries on from the next keyframe, and every sample after it
+    // is right: at most the damaged record and the differences up to the
+    // keyframe are lost
+    TEST_ASSERT(lost > 0);
+    TEST_ASSERT(lost <= 11);
+    TEST_EQUAL(LOG_SAMPLES - lost, matched);
+  }
+
+  // garbage between segments
+  memcpy(damaged, log_data, log_size);
+  size_t half = 0;
+  Adafruit_SCD30_LogDecoder decoder;
+  size_t used;
+  while (decoder.decode(log_data + half, log_size - half, &used) !=
+         SCD30_LOG_HEADER) {
+    half += used;
+  }
+  half += used;
+  while (decoder.decode(log_data + half, log_size - half, &used) !=
+         SCD30_LOG_HEADER) {
+    half += used;
+  }
+  memset(damaged + half, 0xC2, 20);
+  memcpy(damaged + half + 20, log_data + half, log_size - half);
+  uint32_t lost, corrupt;
+  TEST_EQUAL(LOG_SAMPLES, read_log(damaged, log_size + 20, 5, &lost,
+                                   &corrupt));
+  TEST_ASSERT(corrupt >= 20);
+}
+
+static void test_largest_record(void) {
+  Adafruit_SCD30_LogEncoder encoder;
+  Adafruit_SCD30_LogDecoder decoder;
+  uint8_t buffer[SCD30_LOG_MAX_RECORD_SIZE + 8];
+  size_t used;
+
+  uint8_t len = encoder.begin(INT32_MIN, 0xFFFF, buffer);
+  TEST_ASSERT(len <= SCD30_LOG_MAX_RECORD_SIZE);
+  TEST_EQUAL(SCD30_LOG_HEADER, decoder.decode(buffer, len, &used));
+  TEST_EQUAL(len, used);
+  TEST_EQUAL(INT32_MIN, decoder.sensorId());
+  TEST_EQUAL(0xFFFF, decoder.interval());
+
+  // the start of the range as a keyframe...
+  encoder.begin(1, 2, buffer);
+  decoder.decode(buffer, sizeof(buffer), &used);
+  scd30_compact_sample_t low = {0, INT16_MIN, 0};
+  len = encoder.add(&low, 0, buffer);
+  TEST_ASSERT(len <= SCD30_LOG_MAX_RECORD_SIZE);
+  TEST_EQUAL(SCD30_LOG_SAMPLE, decoder.decode(buffer, len, &used));
+
+  // ...then a difference across all of it, with the time as far off the
+  // interval as it can be: every field at its longest
+  scd30_compact_sample_t high = {SCD30_COMPACT_CO2_MAX, INT16_MAX,
+                                 SCD30_COMPACT_HUMIDITY_MAX};
+  memset(buffer, 0xEE, sizeof(buffer));
+  len = encoder.add(&high, 0x7FFFFFFF, buffer);
+  TEST_EQUAL(SCD30_LOG_MAX_RECORD_SIZE, len);
+  TEST_EQUAL(0xEE, buffer[SCD30_LOG_MAX_RECORD_SIZE]);
+  TEST_EQUAL(SCD30_LOG_RECORD_DELTA, buffer[0]);
+  TEST_EQUAL(SCD30_LOG_SAMPLE, decoder.decode(buffer, len, &used));
+  TEST_EQUAL(len, used);
+  TEST_EQUAL(SCD30_COMPACT_CO2_MAX, decoder.sample().co2);
+  TEST_EQUAL(INT16_MAX, decoder.sample().temperature);
+  TEST_EQUAL(SCD30_COMPACT_HUMIDITY_MAX, decoder.sample().humidity);
+  TEST_EQUAL(0x7FFFFFFF, decoder.timestamp());
+
+  // and back down again
+  len = encoder.add(&low, 0xFFFFFFFE, buffer);
+  TEST_EQUAL(SCD30_LOG_MAX_RECORD_SIZE, len);
+  TEST_EQUAL(SCD30_LOG_SAMPLE, decoder.decode(buffer, len, &used));
+  TEST_EQUAL(0, decoder.sample().co2);
+  TEST_EQUAL(INT16_MIN, decoder.sample().temperature);
+  TEST_EQUAL(0xFFFFFFFE, decoder.timestamp());
+
+  // values out of the compact ranges are clamped, so they still fit
+  scd30_compact_sample_t over = {0xFFFFFFFF, INT16_MAX, 0xFFFF};
+  len = encoder.add(&over, 0xFFFFFFFF, buffer);
+  TEST_ASSERT(len <= SCD30_LOG_MAX_RECORD_SIZE);
+  TEST_EQUAL(SCD30_LOG_SAMPLE, decoder.decode(buffer, len, &used));
+  TEST_EQUAL(SCD30_COMPACT_CO2_MAX, decoder.sample().co2);
+  TEST_EQUAL(SCD30_COMPACT_HUMIDITY_MAX, decoder.sample().humidity);
+
+  // cut short anywhere, it waits for the rest
+  len = encoder.add(&high, 0xFFFFFFFF, buffer);
+  for (uint8_t i = 0; i < len; i++) {
+    TEST_EQUAL(SCD30_LOG_NEED_MORE, decoder.decode(buffer, i, &used));
+    TEST_EQUAL(0, used);
+  }
+}
+
+int main(void) {
+  RUN_TEST(test_round_trip);
+  RUN_TEST(test_chunked);
+  RUN_TEST(test_resync_after_corruption);
+  RUN_TEST(test_largest_record);
+  return test_report();
+}
@@ -0,0 +1,463 @@
+/*!
+ *  @file test_modbus.cpp
+ *
+ * 	Round trip tests of Adafruit_SCD30_Modbus over a pseudo terminal, with a
+ * 	thread on the far end answering as a Modbus RTU SCD30
+ *
+ *
+ *	 BSD (see license.txt)
+ */
+
+#include "sim_scd30.h"
+#include "test.h"
+#include <Adafruit_SCD30.h>
+#include <Adafruit_SCD30_Modbus.h>
+#include <atomic>
+#include <fcntl.h>
+#include <mutex>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <termios.h>
+#include <thread>
+#include <unistd.h>
+
+#define SKIPPED 77      ///< Exit code ctest counts as a skipped test
+#define MAX_REQUESTS 64 ///< Requests logged by the slave
+
+/** A request the slave received */
+typedef struct {
+  uint8_t function; ///< Function code
+  uint16_t reg;     ///< First register
+  uint16_t value;   ///< Register count for reads, value for writes
+} request_t;
+
+/*!
+ *    @brief  Stream over the master side of the pseudo terminal. Waiting for
+ *            input sleeps for real and moves the virtual clock by as much, so
+ *            the transport's timeouts match the time the slave has.
+ */
+class PtyStream : public Stream {
+public:
+  /** @brief Send a byte
+      @param byte The byte
+      @return The number of bytes sent */
+  size_t write(uint8_t byte) { return write(&byte, 1); }
+  /** @brief Send several bytes
+      @param buffer The bytes
+      @param len The number of bytes
+      @return The number of bytes sent */
+  size_t write(const uint8_t *buffer, size_t len) {
+    ssize_t sent = ::write(fd, buffer, len);
+    return (sent < 0) ? 0 : sent;
+  }
+  /** @brief Get the number of bytes waiting, waiting up to a millisecond for
+      some to arrive
+      @return The number of bytes */
+  int available(void) {
+    int waiting = 0;
+    ioctl(fd, FIONREAD, &waiting);
+    if (!waiting) {
+      struct pollfd input = {fd, POLLIN, 0};
+      ::poll(&input, 1, 1);
+      host_advance_us(1000);
+      ioctl(fd, FIONREAD, &waiting);
+    }
+    return waiting;
+  }
+  /** @brief Read a byte
+      @return The byte, or -1 if there is none */
+  int read(void) {
+    uint8_t byte;
+    return (::read(fd, &byte, 1) == 1) ? byte : -1;
+  }
+
+  int fd = -1; ///< The pseudo terminal master
+};
+
+static SimSCD30 sensor;
+static PtyStream serial;
+static int slave_fd = -1;
+static std::atomic<bool> serving;
+static std::mutex log_lock;
+static request_t requests[MAX_REQUESTS];
+static uint8_t request_count;
+
+/**
+ * @brief Modbus CRC, written out here so the test doesn't lean on the
+ * library's
+ *
+ * @param data The bytes
+ * @param len The number of bytes
+ * @return uint16_t The CRC, sent LSB first
+ */
+static uint16_t crc16(const uint8_t *data, size_t len) {
+  uint16_t crc = 0xFFFF;
+  while (len--) {
+    crc ^= *data++;
+    for (uint8_t bit = 0; bit < 8; bit++) {
+      crc = (crc & 1) ? (crc >> 1) ^ 0xA001 : (crc >> 1);
+    }
+  }
+  return crc;
+}
+
+/**
+ * @brief Get the I2C command behind a Modbus register
+ *
+ * @param reg The register
+ * @return uint16_t The command, 0 if the register is not one
+ */
+static uint16_t register_command(uint16_t reg) {
+  switch (reg) {
+  case 0x20:
+    return 0xD100;
+  case 0x25:
+    return 0x4600;
+  case 0x27:
+    return 0x0202;
+  case 0x28:
+    return 0x0300;
+  case 0x34:
+    return 0xD304;
+  case 0x36:
+    return 0x0010;
+  case 0x37:
+    return 0x0104;
+  case 0x38:
+    return 0x5102;
+  case 0x39:
+    return 0x5204;
+  case 0x3A:
+    return 0x5306;
+  case 0x3B:
+    return 0x5403;
+  default:
+    return 0;
+  }
+}
+
+/**
+ * @brief Add the CRC to a response and send it
+ *
+ * @param response The response, with room for the CRC
+ * @param len The length without the CRC
+ */
+static void reply(uint8_t *response, size_t len) {
+  uint16_t crc = crc16(response, len);
+  response[len] = crc & 0xFF;
+  response[len + 1] = crc >> 8;
+  if (sensor.corrupt_reads) {
+    sensor.corrupt_reads--;
+    response[3] ^= 0x01;
+  }
+  ssize_t sent = ::write(slave_fd, response, len + 2);
+  (void)sent;
+}
+
+/**
+ * @brief Answer a read of holding registers. The measurement registers can
+ * only be read as a whole; a read touching a command register is refused.
+ *
+ * @param reg The first register
+ * @param count The number of registers
+ * @param response Where to build the response
+ * @return size_t The length of the response without its CRC
+ */
+static size_t read_registers(uint16_t reg, uint16_t count, uint8_t *response) {
+  uint16_t words[8];
+  uint8_t filled = 0;
+
+  if ((reg == 0x28) && (count == 6)) {
+    filled = sensor.respond(0x0300, words);
+  } else {
+    for (; (filled < count) && (count <= 8); filled++) {
+      uint16_t command = register_command(reg + filled);
+      if (!command || (command == 0x0300) ||
+          !sensor.respond(command, &words[filled])) {
+        break;
+      }
+    }
+  }
+
+  if (!count || (filled != count)) {
+    response[1] = 0x83;
+    response[2] = 0x02;
+    return 3;
+  }
+  response[2] = 2 * count;
+  for (uint8_t i = 0; i < count; i++) {
+    response[3 + 2 * i] = words[i] >> 8;
+    response[4 + 2 * i] = words[i] & 0xFF;
+  }
+  return 3 + 2 * count;
+}
+
+/**
+ * @brief Carry out a write of a single register
+ *
+ * @param request The request, which a success echoes
+ * @param reg The register
+ * @param value The value
+ * @param response Where to build the response
+ * @return size_t The length of the response without its CRC
+ */
+static size_t write_register(const uint8_t *request, uint16_t reg,
+                             uint16_t value, uint8_t *response) {
+  uint16_t command = register_command(reg);
+  bool command_only = (command == 0xD304) || (command == 0x0104);
+  bool ok = command && (command != 0x0300) && (command != 0x0202) &&
+            (command != 0xD100) && (!command_only || (value == 1)) &&
+            sensor.execute(command, !command_only, value);
+
+  if (!ok) {
+    response[1] = 0x86;
+    response[2] = 0x03;
+    return 3;
+  }
+  memcpy(response, request, 6);
+  return 6;
+}
+
+/**
+ * @brief Answer one request frame
+ *
+ * @param request The 8 byte request
+ */
+static void handle(const uint8_t *request) {
+  if ((request[0] != SCD30_MODBUS_ADDR_DEFAULT) ||
+      (crc16(request, 6) != (request[6] | request[7] << 8))) {
+    return;
+  }
+  if (sensor.booting()) {
+    return;
+  }
+  if (sensor.nack_reads) {
+    sensor.nack_reads--;
+    return;
+  }
+
+  uint16_t reg = request[2] << 8 | request[3];
+  uint16_t value = request[4] << 8 | request[5];
+  {
+    std::lock_guard<std::mutex> guard(log_lock);
+    if (request_count < MAX_REQUESTS) {
+      requests[request_count++] = {request[1], reg, value};
+    }
+  }
+
+  uint8_t response[32];
+  size_t len;
+  response[0] = request[0];
+  response[1] = request[1];
+  if (request[1] == 0x03) {
+    len = read_registers(reg, value, response);
+  } else if (request[1] == 0x06) {
+    len = write_register(request, reg, value, response);
+  } else {
+    response[1] |= 0x80;
+    response[2] = 0x01;
+    len = 3;
+  }
+  reply(response, len);
+}
+
+/**
+ * @brief Answer requests arriving on the slave side until told to stop
+ */
+static void slave(void) {
+  uint8_t frame[8];
+  size_t have = 0;
+
+  while (serving.load()) {
+    struct pollfd input = {slave_fd, POLLIN, 0};
+    if (::poll(&input, 1, 5) <= 0) {
+      continue;
+    }
+    ssize_t got = ::read(slave_fd, frame + have, sizeof(frame) - have);
+    if (got <= 0) {
+      continue;
+    }
+    have += got;
+    if (have == sizeof(frame)) {
+      handle(frame);
+      have = 0;
+    }
+  }
+}
+
+/**
+ * @brief Open a pseudo terminal in raw mode for the transport and the slave
+ *
+ * @return true: success false: pseudo terminals are not available
+ */
+static bool open_pty(void) {
+  int master = posix_openpt(O_RDWR | O_NOCTTY);
+  if ((master < 0) || grantpt(master) || unlockpt(master)) {
+    return false;
+  }
+  int slave = open(ptsname(master), O_RDWR | O_NOCTTY);
+  if (slave < 0) {
+    return false;
+  }
+
+  struct termios mode;
+  tcgetattr(slave, &mode);
+  cfmakeraw(&mode);
+  tcsetattr(slave, TCSANOW, &mode);
+
+  serial.fd = master;
+  slave_fd = slave;
+  return true;
+}
+
+/**
+ * @brief Forget the requests seen so far
+ */
+static void clear_log(void) {
+  std::lock_guard<std::mutex> guard(log_lock);
+  request_count = 0;
+}
+
+static Adafruit_SCD30_Modbus modbus(&serial);
+static Adafruit_SCD30 scd30;
+static scd30_stats_t stats;
+
+/**
+ * @brief Start a fresh sensor over Modbus
+ *
+ * @return true: success false: the driver could not start the sensor
+ */
+static bool setup_sensor(void) {
+  host_set_time_us(0);
+  sensor = SimSCD30();
+  if (!scd30.begin(&modbus)) {
+    return false;
+  }
+  scd30.setStats(&stats);
+  scd30.resetStats();
+  clear_log();
+  return true;
+}
+
+static void test_read_measurement(void) {
+  TEST_ASSERT(setup_sensor());
+  TEST_ASSERT(sensor.running);
+  sensor.co2 = 950.5f;
+  sensor.temperature = 21.5f;
+  sensor.humidity = 38.25f;
+
+  delay(2000);
+  TEST_ASSERT(scd30.dataReady());
+  TEST_ASSERT(scd30.read());
+  TEST_CLOSE(950.5, scd30.CO2, 0);
+  TEST_CLOSE(21.5, scd30.temperature, 0);
+  TEST_CLOSE(38.25, scd30.relative_humidity, 0);
+  TEST_ASSERT(!scd30.dataReady());
+}
+
+static void test_commands(void) {
+  TEST_ASSERT(setup_sensor());
+  TEST_ASSERT(scd30.setMeasurementInterval(10));
+  TEST_ASSERT(scd30.setAltitudeOffset(250));
+  TEST_ASSERT(scd30.setTemperatureOffset(120));
+  TEST_ASSERT(scd30.selfCalibrationEnabled(true));
+  TEST_ASSERT(scd30.stopContinuousMeasurement());
+  TEST_EQUAL(10, sensor.interval);
+  TEST_EQUAL(250, sensor.altitude);
+  TEST_EQUAL(120, sensor.temperature_offset);
+  TEST_EQUAL(1, sensor.self_calibration);
+  TEST_ASSERT(!sensor.running);
+
+  uint32_t resets = sensor.count(0xD304);
+  scd30.reset();
+  TEST_EQUAL(resets + 1, sensor.count(0xD304));
+  TEST_ASSERT(scd30.startContinuousMeasurement(900));
+  TEST_EQUAL(900, sensor.pressure);
+}
+
+static void test_settings_read_together(void) {
+  TEST_ASSERT(setup_sensor());
+  sensor.altitude = 300;
+  sensor.forced_reference = 700;
+  TEST_ASSERT(scd30.refreshConfig());
+
+  scd30_config_t config;
+  TEST_ASSERT(scd30.getConfig(&config));
+  TEST_EQUAL(2, config.measurement_interval);
+  TEST_EQUAL(300, config.altitude_offset);
+  TEST_EQUAL(700, config.forced_calibration_reference);
+
+  // the four settings registers in one request, the other two on their own
+  std::lock_guard<std::mutex> guard(log_lock);
+  TEST_EQUAL(3, request_count);
+  uint8_t blocks = 0;
+  for (uint8_t i = 0; i < request_count; i++) {
+    TEST_EQUAL(0x03, requests[i].function);
+    if (requests[i].value > 1) {
+      TEST_EQUAL(0x38, requests[i].reg);
+      TEST_EQUAL(4, requests[i].value);
+      blocks++;
+    } else {
+      TEST_ASSERT((requests[i].reg == 0x25) || (requests[i].reg == 0x36));
+    }
+  }
+  TEST_EQUAL(1, blocks);
+}
+
+static void test_request_does_not_wait(void) {
+  TEST_ASSERT(setup_sensor());
+  delay(2000);
+
+  // right after a command the bus needs its inter-frame gap
+  TEST_ASSERT(scd30.setAltitudeOffset(10));
+  uint64_t start = host_time_us();
+  TEST_ASSERT(scd30.beginRead());
+  TEST_ASSERT(host_time_us() - start < 100);
+
+  scd30_read_status_t status;
+  do {
+    status = scd30.pollRead();
+  } while (status == SCD30_READ_PENDING);
+  TEST_EQUAL(SCD30_READ_READY, status);
+  TEST_CLOSE(600, scd30.CO2, 0);
+}
+
+static void test_corrupt_frame_retried(void) {
+  TEST_ASSERT(setup_sensor());
+  delay(2000);
+
+  sensor.corrupt_reads = 1;
+  TEST_ASSERT(scd30.read());
+  TEST_EQUAL(1, stats.crc_errors[0]);
+  TEST_EQUAL(1, stats.retries);
+}
+
+static void test_timeout_retried(void) {
+  TEST_ASSERT(setup_sensor());
+  delay(2000);
+
+  sensor.nack_reads = 1;
+  TEST_ASSERT(scd30.read());
+  TEST_EQUAL(1, stats.nacks);
+  TEST_EQUAL(1, stats.retries);
+}
+
+int main(void) {
+  if (!open_pty()) {
+    printf("no pseudo terminals, skipping\n");
+    return SKIPPED;
+  }
+  serving.store(true);
+  std::thread server(slave);
+
+  RUN_TEST(test_read_measurement);
+  RUN_TEST(test_commands);
+  RUN_TEST(test_settings_read_together);
+  RUN_TEST(test_request_does_not_wait);
+  RUN_TEST(test_corrupt_frame_retried);
+  RUN_TEST(test_timeout_retried);
+
+  serving.store(false);
+  server.join();
+  return test_report();
+}
@@ -0,0 +1,179 @@
+/*!
+ *  @file test_ready.cpp
+ *
+ * 	Host tests of data ready signalled by the RDY pin, through its interrupt
+ * 	and through a pin reader, against the simulated sensor
+ *
+ *
+ *	 BSD (see license.txt)
+ */
+
+#include "sim_scd30.h"
+#include "test.h"
+#include <Adafruit_SCD30.h>
+
+#define READY_PIN 5 ///< Host pin wired to RDY
+
+/*!
+ *    @brief  Simulated sensor whose CO2 reading is the number of the
+ *            measurement, so a read shows which one it got
+ */
+class CountingSCD30 : public SimSCD30 {
+public:
+  /** @brief Set the CO2 reading to the measurement number
+      @param frame The number of the measurement */
+  void measure(uint32_t frame) { co2 = 400 + frame; }
+};
+
+static CountingSCD30 sensor;
+static Adafruit_SCD30 scd30;
+static bool last_level; ///< RDY level seen by the pin reader's poll
+
+/**
+ * @brief Put a freshly powered sensor on the bus with RDY on `READY_PIN`
+ */
+static void setup_sim(void) {
+  sim_reset();
+  sensor = CountingSCD30();
+  sensor.ready_pin = READY_PIN;
+  sim_attach(&sensor, SCD30_I2CADDR_DEFAULT);
+  host_set_pin(READY_PIN, LOW);
+  last_level = false;
+}
+
+/**
+ * @brief Read RDY straight from the simulated sensor, as a port expander
+ * would
+ *
+ * @param context Unused
+ * @return true: RDY is high
+ */
+static bool read_ready_pin(void *context) {
+  (void)context;
+  return sensor.ready();
+}
+
+/**
+ * @brief Let time pass, with the RDY pin following the sensor. With a pin
+ * reader, also play the part of the user's edge detection.
+ *
+ * @param ms How long to wait
+ * @param edges Call `dataReadyISR` on each rising edge
+ */
+static void wait(uint32_t ms, bool edges) {
+  for (uint32_t i = 0; i < ms / 10; i++) {
+    delay(10);
+    sensor.updatePin();
+    bool level = sensor.ready();
+    if (edges && level && !last_level) {
+      scd30.dataReadyISR();
+    }
+    last_level = level;
+  }
+}
+
+/**
+ * @brief Check data ready every 50 ms and read each new sample
+ *
+ * @param duration_ms How long to run
+ * @param edges Call `dataReadyISR` on each rising edge
+ * @return uint32_t The number of samples read
+ */
+static uint32_t read_samples(uint32_t duration_ms, bool edges) {
+  uint32_t samples = 0;
+  for (uint32_t t = 0; t < duration_ms; t += 50) {
+    wait(50, edges);
+    if (scd30.dataReady() && scd30.read()) {
+      samples++;
+    }
+  }
+  return samples;
+}
+
+/**
+ * @brief Read samples for 30 s and check that only the reads went over the
+ * bus, one command and response each
+ *
+ * @param edges Call `dataReadyISR` on each rising edge
+ */
+static void check_one_transaction_per_sample(bool edges) {
+  uint32_t checks = sensor.count(0x0202);
+  uint32_t frames_read = sensor.frames_read;
+  uint32_t transactions = sim_bus_stats.transactions;
+  uint32_t samples = read_samples(30000, edges);
+  TEST_ASSERT(samples >= 14);
+  TEST_ASSERT(samples <= 15);
+  TEST_EQUAL(checks, sensor.count(0x0202));
+  TEST_EQUAL(samples, sensor.frames_read - frames_read);
+  TEST_EQUAL(2 * samples, sim_bus_stats.transactions - transactions);
+
+  scd30_timing_t timing;
+  scd30.getTiming(&timing);
+  TEST_EQUAL(0, timing.missed);
+  TEST_EQUAL(0, timing.duplicates);
+  TEST_EQUAL(0, sensor.gap_violations);
+}
+
+static void test_interrupt(void) {
+  setup_sim();
+  TEST_ASSERT(scd30.begin(SCD30_I2CADDR_DEFAULT, &Wire, 0, READY_PIN));
+  check_one_transaction_per_sample(false);
+}
+
+static void test_pin_reader(void) {
+  setup_sim();
+  TEST_ASSERT(scd30.begin(SCD30_I2CADDR_DEFAULT, &Wire, 0, -1));
+  scd30.setReadyPinReader(read_ready_pin);
+  // the level alone
+  check_one_transaction_per_sample(false);
+  // and with the edges passed on
+  check_one_transaction_per_sample(true);
+  scd30.setReadyPinReader(NULL);
+}
+
+static void test_pin_stays_high(void) {
+  setup_sim();
+  TEST_ASSERT(scd30.begin(SCD30_I2CADDR_DEFAULT, &Wire, 0, READY_PIN));
+  uint32_t checks = sensor.count(0x0202);
+  TEST_EQUAL(1, read_samples(2500, false));
+  TEST_EQUAL(401, scd30.CO2);
+
+  // nothing read for three measurements: RDY rises once and stays high, so
+  // there are no more edges
+  wait(6000, false);
+  TEST_ASSERT(digitalRead(READY_PIN) == HIGH);
+  TEST_ASSERT(scd30.dataReady());
+  TEST_ASSERT(scd30.read());
+  // the newest measurement, with the ones skipped counted
+  TEST_EQUAL(404, scd30.CO2);
+  scd30_timing_t timing;
+  scd30.getTiming(&timing);
+  TEST_EQUAL(4, timing.frame);
+  TEST_EQUAL(2, timing.missed);
+
+  // the read takes RDY low, and the next edge is seen as before
+  wait(10, false);
+  TEST_ASSERT(digitalRead(READY_PIN) == LOW);
+  TEST_ASSERT(!scd30.dataReady());
+  TEST_EQUAL(2, read_samples(4000, false));
+  TEST_EQUAL(406, scd30.CO2);
+  TEST_EQUAL(checks, sensor.count(0x0202));
+
+  // the same with a pin reader: high until read, then low
+  scd30.setReadyPinReader(read_ready_pin);
+  wait(5000, false);
+  TEST_ASSERT(scd30.dataReady());
+  TEST_ASSERT(scd30.dataReady());
+  TEST_ASSERT(scd30.read());
+  TEST_EQUAL(408, scd30.CO2);
+  TEST_ASSERT(!scd30.dataReady());
+  scd30.setReadyPinReader(NULL);
+  TEST_EQUAL(checks, sensor.count(0x0202));
+}
+
+int main(void) {
+  RUN_TEST(test_interrupt);
+  RUN_TEST(test_pin_reader);
+  RUN_TEST(test_pin_stays_high);
+  return test_report();
+}
@@ -0,0 +1,238 @@
+/*!
+ *  @file test_retry.cpp
+ *
+ * 	Host tests of the Adafruit SCD30 retry policy, with faults injected by
+ * 	the simulated sensor
+ *
+ *
+ *	 BSD (see license.txt)
+ */
+
+#include "sim_scd30.h"
+#include "test.h"
+#include <Adafruit_SCD30.h>
+
+static SimSCD30 sensor;
+static Adafruit_SCD30 scd30;
+static scd30_stats_t stats;
+
+/**
+ * @brief Start a sensor with a measurement waiting, counting bus activity
+ *
+ * @return true: success false: the driver could not start the sensor
+ */
+static bool setup_sensor(void) {
+  sim_reset();
+  sensor = SimSCD30();
+  sim_attach(&sensor, SCD30_I2CADDR_DEFAULT);
+  if (!scd30.begin()) {
+    return false;
+  }
+  scd30_retry_policy_t policy = {2, 1, 50, SCD30_RETRY_BUS | SCD30_RETRY_CRC};
+  scd30.setRetryPolicy(&policy);
+  scd30.setStats(&stats);
+  scd30.resetStats();
+  delay(2000);
+  return true;
+}
+
+static void test_default_policy(void) {
+  TEST_ASSERT(setup_sensor());
+  scd30_retry_policy_t policy;
+  scd30.getRetryPolicy(&policy);
+  TEST_EQUAL(2, policy.attempts);
+  TEST_EQUAL(SCD30_RETRY_BUS | SCD30_RETRY_CRC, policy.retry_on);
+}
+
+static void test_read_nack_retried(void) {
+  TEST_ASSERT(setup_sensor());
+  sensor.nack_reads = 1;
+  TEST_ASSERT(scd30.read());
+  TEST_EQUAL(1, stats.retries);
+  TEST_EQUAL(1, stats.nacks);
+  TEST_EQUAL(1, sensor.frames_read);
+}
+
+static void test_command_nack_retried(void) {
+  TEST_ASSERT(setup_sensor());
+  sensor.nack_writes = 1;
+  TEST_ASSERT(scd30.setMeasurementInterval(10));
+  TEST_EQUAL(10, sensor.interval);
+  TEST_EQUAL(1, stats.retries);
+}
+
+static void test_crc_error_retried(void) {
+  TEST_ASSERT(setup_sensor());
+  sensor.corrupt_reads = 1;
+  sensor.corrupt_word = 4;
+  TEST_ASSERT(scd30.read());
+  TEST_EQUAL(1, stats.retries);
+  TEST_EQUAL(1, stats.crc_errors[4]);
+}
+
+static void test_gives_up_after_attempts(void) {
+  TEST_ASSERT(setup_sensor());
+  sensor.nack_reads = 2;
+  TEST_ASSERT(!scd30.read());
+  TEST_EQUAL(1, stats.retries);
+
+  // the sensor is fine again afterwards
+  TEST_ASSERT(scd30.read());
+}
+
+static void test_only_listed_errors_retried(void) {
+  TEST_ASSERT(setup_sensor());
+  scd30_retry_policy_t policy = {3, 1, 50, SCD30_RETRY_BUS};
+  scd30.setRetryPolicy(&policy);
+
+  sensor.corrupt_reads = 1;
+  TEST_ASSERT(!scd30.read());
+  TEST_EQUAL(0, stats.retries);
+
+  sensor.nack_reads = 2;
+  TEST_ASSERT(scd30.read());
+  TEST_EQUAL(2, stats.retries);
+}
+
+static void test_no_retries(void) {
+  TEST_ASSERT(setup_sensor());
+  scd30_retry_policy_t policy = {0, 0, 0, SCD30_RETRY_BUS};
+  scd30.setRetryPolicy(&policy);
+  scd30.getRetryPolicy(&policy);
+  TEST_EQUAL(1, policy.attempts);
+
+  sensor.nack_writes = 1;
+  TEST_ASSERT(!scd30.setAltitudeOffset(100));
+  TEST_EQUAL(0, sensor.altitude);
+  TEST_EQUAL(0, stats.retries);
+}
+
+static void test_backoff_doubles_to_limit(void) {
+  TEST_ASSERT(setup_sensor());
+  scd30_retry_policy_t policy = {4, 10, 25, SCD30_RETRY_BUS};
+  scd30.setRetryPolicy(&policy);
+
+  // waits of 10, 20 and 25 ms before the fourth attempt goes through
+  sensor.nack_writes = 3;
+  uint64_t start = host_time_us();
+  TEST_ASSERT(scd30.setTemperatureOffset(200));
+  uint64_t elapsed = host_time_us() - start;
+  TEST_EQUAL(3, stats.retries);
+  TEST_ASSERT(elapsed >= 55000);
+  TEST_ASSERT(elapsed < 60000);
+}
+
+static void test_register_read_retried(void) {
+  TEST_ASSERT(setup_sensor());
+  sensor.corrupt_reads = 1;
+  TEST_EQUAL(0x0342, scd30.getFirmwareRevision());
+  TEST_EQUAL(1, stats.retries);
+}
+
+static void test_config_read_retried(void) {
+  TEST_ASSERT(setup_sensor());
+  sensor.nack_reads = 1;
+  TEST_ASSERT(scd30.refreshConfig());
+  TEST_EQUAL(1, stats.retries);
+
+  // each setting read is timed, like any other transaction
+  static const uint8_t settings[] = {
+      SCD30_STATS_INTERVAL,
+      SCD30_STATS_START_MEASUREMENT,
+      SCD30_STATS_ALTITUDE,
+      SCD30_STATS_TEMPERATURE_OFFSET,
+      SCD30_STATS_FORCED_RECALIBRATION,
+      SCD30_STATS_SELF_CALIBRATION,
+  };
+  for (uint8_t i = 0; i < sizeof(settings); i++) {
+    scd30_latency_stats_t *latency = &stats.latency[settings[i]];
+    TEST_EQUAL(1, latency->count);
+    TEST_ASSERT(latency->min_us >= SCD30_READ_DELAY_US);
+  }
+}
+
+static void test_first_command_after_reset(void) {
+  sim_reset();
+  sensor = SimSCD30();
+  sensor.nack_after_reset = true;
+  sim_attach(&sensor, SCD30_I2CADDR_DEFAULT);
+
+  // the command dropped after the reset is sent again, once
+  TEST_ASSERT(scd30.begin());
+  TEST_ASSERT(sensor.running);
+  TEST_EQUAL(1, sensor.count(0x0010));
+}
+
+static void test_template_first_command_after_reset(void) {
+  sim_reset();
+  sensor = SimSCD30();
+  sensor.nack_after_reset = true;
+  sim_attach(&sensor, SCD30_I2CADDR_DEFAULT);
+  Adafruit_I2CDevice device(SCD30_I2CADDR_DEFAULT);
+  Adafruit_SCD30_I2CDriver driver;
+  driver.transport().setDevice(&device);
+  driver.setStats(&stats);
+  scd30_stats_clear(&stats);
+
+  // retried by the policy, not by sending the start command twice
+  TEST_ASSERT(driver.begin());
+  TEST_ASSERT(sensor.running);
+  TEST_EQUAL(1, sensor.count(0x0010));
+  TEST_EQUAL(1, stats.retries);
+}
+
+static void test_template_policy(void) {
+  TEST_ASSERT(setup_sensor());
+  Adafruit_I2CDevice device(SCD30_I2CADDR_DEFAULT);
+  Adafruit_SCD30_I2CDriver driver;
+  driver.transport().setDevice(&device);
+  driver.setStats(&stats);
+  driver.transport().setStats(&stats);
+  scd30_retry_policy_t policy = {3, 1, 50, SCD30_RETRY_BUS};
+  driver.setRetryPolicy(&policy);
+
+  sensor.nack_reads = 2;
+  TEST_ASSERT(driver.read());
+  TEST_EQUAL(2, stats.retries);
+  TEST_EQUAL(2, stats.nacks);
+
+  // CRC errors are not in this policy
+  sensor.corrupt_reads = 1;
+  TEST_ASSERT(!driver.read());
+  TEST_EQUAL(2, stats.retries);
+  TEST_ASSERT(stats.latency[SCD30_STATS_READ_MEASUREMENT].count > 0);
+}
+
+static void test_zeroed_stats(void) {
+  TEST_ASSERT(setup_sensor());
+  // attached as they are, without `resetStats`
+  scd30_stats_t zeroed = {};
+  scd30.setStats(&zeroed);
+  TEST_ASSERT(scd30.read());
+  TEST_ASSERT(scd30.read());
+
+  scd30_latency_stats_t *latency =
+      &zeroed.latency[SCD30_STATS_READ_MEASUREMENT];
+  TEST_EQUAL(2, latency->count);
+  TEST_ASSERT(latency->min_us >= SCD30_READ_DELAY_US);
+  TEST_ASSERT(latency->min_us <= latency->max_us);
+  scd30.setStats(&stats);
+}
+
+int main(void) {
+  RUN_TEST(test_default_policy);
+  RUN_TEST(test_read_nack_retried);
+  RUN_TEST(test_command_nack_retried);
+  RUN_TEST(test_crc_error_retried);
+  RUN_TEST(test_gives_up_after_attempts);
+  RUN_TEST(test_only_listed_errors_retried);
+  RUN_TEST(test_no_retries);
+  RUN_TEST(test_backoff_doubles_to_limit);
+  RUN_TEST(test_register_read_retried);
+  RUN_TEST(test_config_read_retried);
+  RUN_TEST(test_first_command_after_reset);
+  RUN_TEST(test_template_first_command_after_reset);
+  RUN_TEST(test_template_policy);
+  RUN_TEST(test_zeroed_stats);
+  return test_report();
+}
@@ -0,0 +1,252 @@
+/*!
+ *  @file test_serialize.cpp
+ *
+ * 	Host tests of the line protocol, JSON and CBOR serializers against
+ * 	known good output, at their largest records and with buffers too short
+ * 	to hold them
+ *
+ *
+ *	 BSD (see license.txt)
+ */
+
+#include "test.h"
+#include <Adafruit_SCD30_Serialize.h>
+#include <string.h>
+
+static const scd30_config_t config = {2, 1013, 0, 150, 400, 1};
+static scd30_stats_t stats;
+
+/**
+ * @brief Fill in a typical record
+ *
+ * @param record The record to fill in
+ * @param with_config Include the settings
+ * @param with_stats Include the bus counters
+ */
+static void setup_record(scd30_record_t *record, bool with_config,
+                         bool with_stats) {
+  memset(&stats, 0, sizeof(stats));
+  stats.transactions = 42;
+  stats.bytes_written = 100;
+  stats.bytes_read = 300;
+  stats.nacks = 1;
+  stats.retries = 2;
+  stats.crc_errors[0] = 1;
+  stats.crc_errors[2] = 2;
+
+  record->sample.co2 = 8125;
+  record->sample.temperature = -550;
+  record->sample.humidity = 4150;
+  record->timestamp = 123456;
+  record->sequence = 7;
+  record->frame = 9;
+  record->config = with_config ? &config : NULL;
+  record->stats = with_stats ? &stats : NULL;
+}
+
+/**
+ * @brief Fill in a record with every field at its longest
+ *
+ * @param record The record to fill in
+ */
+static void setup_largest(scd30_record_t *record) {
+  static scd30_config_t largest_config;
+  memset(&largest_config, 0xFF, sizeof(largest_config));
+  memset(&stats, 0xFF, sizeof(stats));
+  // the CRC errors are summed, so keep the sum to 10 digits
+  memset(stats.crc_errors, 0, sizeof(stats.crc_errors));
+  stats.crc_errors[0] = 0xFFFFFFFF;
+
+  record->sample.co2 = SCD30_COMPACT_CO2_MAX;
+  record->sample.temperature = INT16_MIN;
+  record->sample.humidity = SCD30_COMPACT_HUMIDITY_MAX;
+  record->timestamp = 0xFFFFFFFF;
+  record->sequence = 0xFFFFFFFF;
+  record->frame = 0xFFFFFFFF;
+  record->config = &largest_config;
+  record->stats = &stats;
+}
+
+static void test_json_golden(void) {
+  scd30_record_t record;
+  char buffer[SCD30_JSON_MAX_SIZE];
+  setup_record(&record, false, false);
+  const char *expected = "{\"co2\":812.5,\"temperature\":-5.50,"
+                         "\"humidity\":41.50,\"timestamp\":123456,"
+                         "\"sequence\":7,\"frame\":9}";
+  TEST_EQUAL(strlen(expected),
+             scd30_format_json(&record, buffer, sizeof(buffer)));
+  TEST_ASSERT(!strcmp(expected, buffer));
+
+  setup_record(&record, true, true);
+  expected = "{\"co2\":812.5,\"temperature\":-5.50,\"humidity\":41.50,"
+             "\"timestamp\":123456,\"sequence\":7,\"frame\":9,"
+             "\"config\":{\"measurement_interval\":2,"
+             "\"ambient_pressure\":1013,\"altitude_offset\":0,"
+             "\"temperature_offset\":1.50,"
+             "\"forced_calibration_reference\":400,"
+             "\"self_calibration\":true},"
+             "\"stats\":{\"transactions\":42,\"bytes_written\":100,"
+             "\"bytes_read\":300,\"nacks\":1,\"retries\":2,"
+             "\"crc_errors\":3}}";
+  TEST_EQUAL(strlen(expected),
+             scd30_format_json(&record, buffer, sizeof(buffer)));
+  TEST_ASSERT(!strcmp(expected, buffer));
+}
+
+static void test_fixed_point_digits(void) {
+  scd30_record_t record;
+  char buffer[SCD30_JSON_MAX_SIZE];
+  setup_record(&record, false, false);
+
+  // leading zeros after the point, and below one in magnitude
+  record.sample.co2 = 0;
+  record.sample.temperature = -5;
+  record.sample.humidity = 7;
+  TEST_ASSERT(scd30_format_json(&record, buffer, sizeof(buffer)));
+  TEST_ASSERT(!strncmp("{\"co2\":0.0,\"temperature\":-0.05,"
+                       "\"humidity\":0.07,",
+                       buffer, 47));
+
+  record.sample.co2 = 9;
+  record.sample.temperature = INT16_MIN;
+  record.sample.humidity = SCD30_COMPACT_HUMIDITY_MAX;
+  TEST_ASSERT(scd30_format_json(&record, buffer, sizeof(buffer)));
+  TEST_ASSERT(!strncmp("{\"co2\":0.9,\"temperature\":-327.68,"
+                       "\"humidity\":100.00,",
+                       buffer, 51));
+}
+
+static void test_line_golden(void) {
+  scd30_record_t record;
+  char buffer[SCD30_LINE_MAX_SIZE + 32];
+  setup_record(&record, false, false);
+  const char *expected = "scd30,room=lab co2=812.5,temperature=-5.50,"
+                         "humidity=41.50,timestamp=123456i,sequence=7i,"
+                         "frame=9i 1700000000000000000";
+  TEST_EQUAL(strlen(expected),
+             scd30_format_line(&record, "scd30", "room=lab", 1700000000,
+                               buffer, sizeof(buffer)));
+  TEST_ASSERT(!strcmp(expected, buffer));
+
+  // no tags, no time, and the settings and counters as more fields
+  setup_record(&record, true, true);
+  expected = "scd30 co2=812.5,temperature=-5.50,humidity=41.50,"
+             "timestamp=123456i,sequence=7i,frame=9i,"
+             "measurement_interval=2i,ambient_pressure=1013i,"
+             "altitude_offset=0i,temperature_offset=1.50,"
+             "forced_calibration_reference=400i,self_calibration=true,"
+             "transactions=42i,bytes_written=100i,bytes_read=300i,nacks=1i,"
+             "retries=2i,crc_errors=3i";
+  TEST_EQUAL(strlen(expected), scd30_format_line(&record, "scd30", NULL, 0,
+                                                 buffer, sizeof(buffer)));
+  TEST_ASSERT(!strcmp(expected, buffer));
+}
+
+static void test_cbor_golden(void) {
+  scd30_record_t record;
+  uint8_t buffer[SCD30_CBOR_MAX_SIZE];
+  setup_record(&record, false, false);
+  static const uint8_t expected[] = {
+      0xA6,                                     // map of 6
+      0x63, 'c', 'o', '2',                      // "co2"
+      0xC4, 0x82, 0x20, 0x19, 0x1F, 0xBD,       // 4([-1, 8125])
+      0x6B, 't', 'e', 'm', 'p', 'e', 'r', 'a',  // "temperature"
+      't', 'u', 'r', 'e',                       //
+      0xC4, 0x82, 0x21, 0x39, 0x02, 0x25,       // 4([-2, -550])
+      0x68, 'h', 'u', 'm', 'i', 'd', 'i', 't',  // "humidity"
+      'y',                                      //
+      0xC4, 0x82, 0x21, 0x19, 0x10, 0x36,       // 4([-2, 4150])
+      0x69, 't', 'i', 'm', 'e', 's', 't', 'a',  // "timestamp"
+      'm', 'p',                                 //
+      0x1A, 0x00, 0x01, 0xE2, 0x40,             // 123456
+      0x68, 's', 'e', 'q', 'u', 'e', 'n', 'c',  // "sequence"
+      'e',                                      //
+      0x07,                                     // 7
+      0x65, 'f', 'r', 'a', 'm', 'e',            // "frame"
+      0x09,                                     // 9
+  };
+  TEST_EQUAL(sizeof(expected),
+             scd30_format_cbor(&record, buffer, sizeof(buffer)));
+  TEST_ASSERT(!memcmp(expected, buffer, sizeof(expected)));
+
+  // the settings as a nested map, ending with a true
+  setup_record(&record, true, false);
+  size_t length = scd30_format_cbor(&record, buffer, sizeof(buffer));
+  TEST_ASSERT(length > sizeof(expected));
+  TEST_EQUAL(0xA7, buffer[0]);
+  TEST_ASSERT(!memcmp(&expected[1], &buffer[1], sizeof(expected) - 1));
+  static const uint8_t config_head[] = {0x66, 'c', 'o', 'n', 'f', 'i', 'g',
+                                        0xA6};
+  TEST_ASSERT(!memcmp(config_head, &buffer[sizeof(expected)],
+                      sizeof(config_head)));
+  TEST_EQUAL(0xF5, buffer[length - 1]);
+}
+
+static void test_largest_records_fit(void) {
+  scd30_record_t record;
+  setup_largest(&record);
+
+  char text[SCD30_JSON_MAX_SIZE + 16];
+  TEST_EQUAL(SCD30_JSON_MAX_SIZE - 1,
+             scd30_format_json(&record, text, sizeof(text)));
+  TEST_EQUAL(SCD30_JSON_MAX_SIZE - 1,
+             scd30_format_json(&record, text, SCD30_JSON_MAX_SIZE));
+
+  // with tags, whose comma is counted in the size, and the measurement and
+  // tags themselves on top
+  char line[SCD30_LINE_MAX_SIZE + 16];
+  TEST_EQUAL(SCD30_LINE_MAX_SIZE - 1 + 8,
+             scd30_format_line(&record, "scd30", "a=b", 0xFFFFFFFF, line,
+                               SCD30_LINE_MAX_SIZE + 8));
+
+  uint8_t cbor[SCD30_CBOR_MAX_SIZE];
+  TEST_EQUAL(SCD30_CBOR_MAX_SIZE,
+             scd30_format_cbor(&record, cbor, SCD30_CBOR_MAX_SIZE));
+}
+
+static void test_short_buffer(void) {
+  scd30_record_t record;
+  setup_record(&record, true, true);
+
+  // every size short of the record fails cleanly, leaving an empty string
+  char text[SCD30_JSON_MAX_SIZE];
+  size_t json = scd30_format_json(&record, text, sizeof(text));
+  for (size_t size = 0; size <= json; size++) {
+    memset(text, 'x', sizeof(text));
+    TEST_EQUAL(0, scd30_format_json(&record, text, size));
+    if (size) {
+      TEST_EQUAL('\0', text[0]);
+    }
+    TEST_EQUAL('x', text[size]);
+  }
+  TEST_EQUAL(json, scd30_format_json(&record, text, json + 1));
+
+  char line[SCD30_LINE_MAX_SIZE];
+  size_t length = scd30_format_line(&record, "scd30", NULL, 1, line,
+                                    sizeof(line));
+  for (size_t size = 0; size <= length; size++) {
+    TEST_EQUAL(0, scd30_format_line(&record, "scd30", NULL, 1, line, size));
+  }
+  TEST_EQUAL(length,
+             scd30_format_line(&record, "scd30", NULL, 1, line, length + 1));
+
+  uint8_t cbor[SCD30_CBOR_MAX_SIZE + 1];
+  size_t bytes = scd30_format_cbor(&record, cbor, sizeof(cbor));
+  for (size_t size = 0; size < bytes; size++) {
+    memset(cbor, 0xAA, sizeof(cbor));
+    TEST_EQUAL(0, scd30_format_cbor(&record, cbor, size));
+    TEST_EQUAL(0xAA, cbor[size]);
+  }
+  TEST_EQUAL(bytes, scd30_format_cbor(&record, cbor, bytes));
+}
+
+int main(void) {
+  RUN_TEST(test_json_golden);
+  RUN_TEST(test_fixed_point_digits);
+  RUN_TEST(test_line_golden);
+  RUN_TEST(test_cbor_golden);
+  RUN_TEST(test_largest_records_fit);
+  RUN_TEST(test_short_buffer);
+  return test_report();
+}
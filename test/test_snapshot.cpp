@@ -0,0 +1,173 @@
+/*!
+ *  @file test_snapshot.cpp
+ *
+ * 	Stress test of Adafruit_SCD30::getSnapshot: one thread reads samples
+ * 	while others take snapshots, checking that no snapshot mixes fields of
+ * 	two samples
+ *
+ *
+ *	 BSD (see license.txt)
+ */
+
+#include "test.h"
+#include <Adafruit_SCD30.h>
+#include <atomic>
+#include <thread>
+
+#define WRITES 1000000 ///< Samples published by the writer
+#define READERS 3      ///< Threads taking snapshots
+
+/*!
+ *    @brief  Transport answering every read at once with the next sample,
+ *            whose readings all encode the sample number so a snapshot can
+ *            tell if its fields came from different samples. Keeps the
+ *            writer publishing as fast as it can.
+ */
+class CountingTransport : public Adafruit_SCD30_Transport {
+public:
+  /** @brief Nothing to set up
+      @return true */
+  bool begin(void) { return true; }
+  /** @brief Accept a command
+      @param command Unused
+      @return true */
+  bool write(uint16_t command) {
+    (void)command;
+    return true;
+  }
+  /** @brief Accept a command
+      @param command Unused
+      @param argument Unused
+      @return true */
+  bool write(uint16_t command, uint16_t argument) {
+    (void)command;
+    (void)argument;
+    return true;
+  }
+  /** @brief Accept a read
+      @param command The command read
+      @param words Unused
+      @return true */
+  bool request(uint16_t command, uint8_t words) {
+    (void)words;
+    _command = command;
+    return true;
+  }
+  /** @brief Answer a read with the next sample, data ready always set, or 2
+      for any other register
+      @param words Where to put the response
+      @param count The number of words
+      @return `SCD30_READ_READY` */
+  scd30_read_status_t poll(uint16_t *words, uint8_t count) {
+    if (count == 1) {
+      words[0] = (_command == 0x0202) ? 1 : 2;
+      return SCD30_READ_READY;
+    }
+    sample++;
+    pack(400.0f + sample, words);
+    pack(sample * 0.25f, words + 2);
+    pack(sample * 0.125f, words + 4);
+    return SCD30_READ_READY;
+  }
+
+  uint32_t sample = 0; ///< Number of the last sample sent
+
+private:
+  uint16_t _command = 0; ///< Command of the read in progress
+
+  /** @brief Split a float into the two words the sensor sends it as
+      @param value The float
+      @param words Where to put the words */
+  static void pack(float value, uint16_t *words) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    words[0] = bits >> 16;
+    words[1] = bits & 0xFFFF;
+  }
+};
+
+static CountingTransport transport;
+static Adafruit_SCD30 scd30;
+static std::atomic<bool> writing;
+
+/** What a reader thread saw */
+typedef struct {
+  uint32_t snapshots; ///< Consistent snapshots taken
+  uint32_t busy;      ///< Snapshots refused while the writer was busy
+  uint32_t torn;      ///< Snapshots mixing two samples
+  uint32_t backwards; ///< Snapshots older than the one before
+} reader_result_t;
+
+/**
+ * @brief Take snapshots until the writer is done
+ *
+ * @param result Where to count what was seen
+ */
+static void reader(reader_result_t *result) {
+  uint32_t last = 0;
+  while (writing.load()) {
+    scd30_snapshot_t snapshot;
+    if (!scd30.getSnapshot(&snapshot)) {
+      result->busy++;
+      continue;
+    }
+    uint32_t frame = (uint32_t)(snapshot.CO2 - 400.0f);
+    if ((snapshot.temperature != frame * 0.25f) ||
+        (snapshot.relative_humidity != frame * 0.125f)) {
+      result->torn++;
+    }
+    if (snapshot.sequence < last) {
+      result->backwards++;
+    }
+    last = snapshot.sequence;
+    result->snapshots++;
+  }
+}
+
+static void test_no_torn_snapshots(void) {
+  TEST_ASSERT(scd30.begin(&transport));
+
+  scd30_snapshot_t snapshot;
+  TEST_ASSERT(!scd30.getSnapshot(&snapshot));
+
+  reader_result_t results[READERS];
+  std::thread readers[READERS];
+  memset(results, 0, sizeof(results));
+  writing.store(true);
+  for (int i = 0; i < READERS; i++) {
+    readers[i] = std::thread(reader, &results[i]);
+  }
+
+  // each read follows a data ready check, so none is taken for a duplicate
+  uint32_t reads = 0;
+  for (uint32_t i = 0; i < WRITES; i++) {
+    if (scd30.dataReady() && scd30.read()) {
+      reads++;
+    }
+  }
+  writing.store(false);
+  for (int i = 0; i < READERS; i++) {
+    readers[i].join();
+  }
+
+  TEST_EQUAL(WRITES, reads);
+  uint32_t snapshots = 0;
+  for (int i = 0; i < READERS; i++) {
+    printf("reader %d: %lu snapshots, %lu refused while busy\n", i,
+           (unsigned long)results[i].snapshots,
+           (unsigned long)results[i].busy);
+    TEST_EQUAL(0, results[i].torn);
+    TEST_EQUAL(0, results[i].backwards);
+    snapshots += results[i].snapshots;
+  }
+  TEST_ASSERT(snapshots > 0);
+
+  TEST_ASSERT(scd30.getSnapshot(&snapshot));
+  TEST_EQUAL(WRITES, snapshot.sequence);
+  TEST_CLOSE(400.0 + transport.sample, snapshot.CO2, 0);
+}
+
+int main(void) {
+  RUN_TEST(test_no_torn_snapshots);
+  return test_report();
+}
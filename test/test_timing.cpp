@@ -0,0 +1,157 @@
+/*!
+ *  @file test_timing.cpp
+ *
+ * 	Host tests of the measurement time tracking, against a simulated sensor
+ * 	whose clock runs fast or slow
+ *
+ *
+ *	 BSD (see license.txt)
+ */
+
+#include "sim_scd30.h"
+#include "test.h"
+#include <Adafruit_SCD30.h>
+
+static SimSCD30 sensor;
+static Adafruit_SCD30 scd30;
+
+/**
+ * @brief Start a sensor measuring every `interval` seconds with a clock off
+ * by `drift_ppm`
+ *
+ * @param interval The measurement interval in seconds
+ * @param drift_ppm How slow the sensor's clock is
+ * @return true: success false: the driver could not start the sensor
+ */
+static bool setup_sensor(uint16_t interval, int32_t drift_ppm) {
+  sim_reset();
+  sensor = SimSCD30();
+  sensor.drift_ppm = drift_ppm;
+  sim_attach(&sensor, SCD30_I2CADDR_DEFAULT);
+  return scd30.begin() && scd30.setMeasurementInterval(interval);
+}
+
+/**
+ * @brief Check data ready every `check_ms` and read each new sample
+ *
+ * @param samples The number of samples to read
+ * @param check_ms Time between checks
+ * @return uint32_t The number of samples read
+ */
+static uint32_t read_samples(uint32_t samples, uint32_t check_ms) {
+  uint32_t read = 0;
+  for (uint32_t checks = 0; (read < samples) && (checks < 1000000); checks++) {
+    if (scd30.dataReady() && scd30.read()) {
+      read++;
+    }
+    delay(check_ms);
+  }
+  return read;
+}
+
+static void test_drift_measured(void) {
+  TEST_ASSERT(setup_sensor(2, 3000));
+  TEST_EQUAL(60, read_samples(60, 50));
+
+  scd30_timing_t timing;
+  scd30.getTiming(&timing);
+  TEST_EQUAL(60, timing.frame);
+  TEST_EQUAL(0, timing.missed);
+  TEST_EQUAL(0, timing.duplicates);
+  TEST_CLOSE(3000, timing.drift_ppm, 100);
+  TEST_CLOSE(2006000, timing.period_us, 200);
+  TEST_ASSERT(timing.uncertainty <= 50);
+}
+
+static void test_fast_clock_long_interval(void) {
+  // 30 minute periods keep every product of a period well past 32 bits
+  TEST_ASSERT(setup_sensor(1800, -2000));
+  TEST_EQUAL(12, read_samples(12, 1000));
+
+  scd30_timing_t timing;
+  scd30.getTiming(&timing);
+  TEST_EQUAL(12, timing.frame);
+  TEST_EQUAL(0, timing.missed);
+  TEST_CLOSE(-2000, timing.drift_ppm, 50);
+  TEST_CLOSE(1796400000.0, timing.period_us, 100000);
+}
+
+static void test_missed_samples_counted(void) {
+  TEST_ASSERT(setup_sensor(2, 0));
+  TEST_EQUAL(10, read_samples(10, 50));
+
+  // one measurement goes by unread
+  delay(5000);
+  TEST_ASSERT(scd30.dataReady());
+  TEST_ASSERT(scd30.read());
+
+  scd30_timing_t timing;
+  scd30.getTiming(&timing);
+  TEST_EQUAL(12, timing.frame);
+  TEST_EQUAL(1, timing.missed);
+}
+
+static uint32_t observed; ///< Observer calls
+
+/**
+ * @brief Count observer calls
+ *
+ * @param sample Unused
+ * @param reasons Unused
+ * @param context Unused
+ */
+static void count_observed(const scd30_snapshot_t *sample, uint8_t reasons,
+                           void *context) {
+  (void)sample;
+  (void)reasons;
+  (void)context;
+  observed++;
+}
+
+static void test_duplicate_not_passed_on(void) {
+  TEST_ASSERT(setup_sensor(2, 0));
+  Adafruit_SCD30_History<8> history;
+  scd30_observer_t observer;
+  scd30_deadband_t deadband = {0, 0, 0, 1};
+  scd30.setHistory(&history);
+  TEST_ASSERT(scd30.addObserver(&observer, count_observed, NULL, &deadband));
+  observed = 0;
+  scd30_snapshot_t snapshot;
+  scd30.getSnapshot(&snapshot);
+  uint32_t sequence = snapshot.sequence;
+
+  TEST_EQUAL(1, read_samples(1, 50));
+  // read again before the next measurement, after a check that found
+  // nothing new: the same one comes back
+  TEST_ASSERT(!scd30.dataReady());
+  TEST_ASSERT(scd30.read());
+
+  scd30_timing_t timing;
+  scd30.getTiming(&timing);
+  TEST_EQUAL(1, timing.duplicates);
+  TEST_EQUAL(1, history.size());
+  TEST_EQUAL(1, observed);
+  TEST_ASSERT(scd30.getSnapshot(&snapshot));
+  TEST_EQUAL(sequence + 1, snapshot.sequence);
+
+  TEST_EQUAL(1, read_samples(1, 50));
+  TEST_EQUAL(2, history.size());
+  TEST_EQUAL(2, observed);
+
+  // a blind read can't be told apart from a new measurement, so it is
+  // recorded like any other
+  TEST_ASSERT(scd30.read());
+  TEST_EQUAL(3, history.size());
+  TEST_ASSERT(scd30.getSnapshot(&snapshot));
+  TEST_EQUAL(sequence + 3, snapshot.sequence);
+  scd30.setHistory(NULL);
+  scd30.removeObserver(&observer);
+}
+
+int main(void) {
+  RUN_TEST(test_drift_measured);
+  RUN_TEST(test_fast_clock_long_interval);
+  RUN_TEST(test_missed_samples_counted);
+  RUN_TEST(test_duplicate_not_passed_on);
+  return test_report();
+}